@@ -0,0 +1,165 @@
+#include "autopilot.h"
+#include "rng.h"
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// Cada acción del árbol mantiene una dirección durante ACTION_TICKS ticks
+const int ACTION_TICKS = 6;
+const int MAX_DEPTH = 8;
+const int ROLLOUT_TICKS = 90;
+const double EXPLORATION = 1.2;
+
+double nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Recompensa en [0, 1]: puntos ganados y cercanía al punto más próximo
+// (para no quedarse quieto cuando no hay nada al alcance); perder una
+// vida es lo peor
+double reward(const GameState &before, const GameState &after, const MazeDistances &maze) {
+    if(after.lives < before.lives || after.gameOver) return 0.0;
+    double gained = after.score - before.score;
+
+    int pacman = PacmanCore::cellOf(after.pacmanPos);
+    int nearest = MazeDistances::UNREACHABLE;
+    for(int w = 0; w < Bitboard::WORDS; w++) {
+        uint64_t bits = after.dots.words[w] | after.powers.words[w];
+        while(bits) {
+            int c = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            int d = maze.distance(pacman, c);
+            if(d < nearest) nearest = d;
+        }
+    }
+    double closeness = 1.0 / (1.0 + nearest);
+    return 0.4 + 0.5 * gained / (gained + 200.0) + 0.1 * closeness;
+}
+
+}
+
+Autopilot::Autopilot(int threads) : pool(threads), rollouts(0), rate(0.0) {
+    // Unos cuantos árboles por hilo para que el robo de trabajo reparta
+    int count = pool.size() * 2;
+    trees.resize(count);
+    for(int i = 0; i < count; i++) {
+        trees[i].sim.reset(new PacmanCore);
+        trees[i].rng = streamSeed(0xA17, i);
+        trees[i].rollouts = 0;
+    }
+}
+
+int Autopilot::newNode(Tree &tree) {
+    tree.nodes.push_back({{-1, -1, -1, -1}, 0, 0.0});
+    return static_cast<int>(tree.nodes.size()) - 1;
+}
+
+int Autopilot::decide(const GameState &state, double budgetMs) {
+    double start = nowMs();
+    double deadline = start + budgetMs;
+
+    for(Tree &tree : trees) {
+        Tree *t = &tree;
+        pool.submit([this, t, &state, deadline] { search(*t, state, deadline); });
+    }
+    pool.waitAll();
+
+    // La acción más visitada sumando todos los árboles
+    long long visits[4] = {0, 0, 0, 0};
+    rollouts = 0;
+    for(const Tree &tree : trees) {
+        rollouts += tree.rollouts;
+        for(int a = 0; a < 4; a++) {
+            int child = tree.nodes[0].children[a];
+            if(child >= 0) visits[a] += tree.nodes[child].visits;
+        }
+    }
+    double elapsed = nowMs() - start;
+    rate = elapsed > 0 ? rollouts * 1000.0 / elapsed : 0.0;
+
+    int best = state.nextDir;
+    for(int a = 0; a < 4; a++) {
+        if(visits[a] > (best >= 0 ? visits[best] : -1)) best = a;
+    }
+    return best;
+}
+
+void Autopilot::search(Tree &tree, const GameState &root, double deadline) {
+    tree.nodes.clear();
+    tree.rollouts = 0;
+    newNode(tree);
+
+    PacmanCore &sim = *tree.sim;
+    int path[MAX_DEPTH + 1];
+
+    // Se mira el reloj cada pocas iteraciones
+    while(tree.rollouts % 16 != 0 || nowMs() < deadline) {
+        sim.state() = root;
+        int node = 0;
+        int depth = 0;
+        path[0] = 0;
+
+        // Selección y expansión (UCT)
+        while(depth < MAX_DEPTH && !sim.state().gameOver) {
+            Node &n = tree.nodes[node];
+            int action = -1;
+            for(int a = 0; a < 4 && action < 0; a++) {
+                if(n.children[a] < 0) action = a;
+            }
+
+            bool expand = action >= 0;
+            if(!expand) {
+                double best = -1.0;
+                double logN = std::log(static_cast<double>(n.visits) + 1.0);
+                for(int a = 0; a < 4; a++) {
+                    const Node &c = tree.nodes[n.children[a]];
+                    double uct = c.value / c.visits +
+                                 EXPLORATION * std::sqrt(logN / c.visits);
+                    if(uct > best) {
+                        best = uct;
+                        action = a;
+                    }
+                }
+            }
+
+            for(int t = 0; t < ACTION_TICKS && !sim.state().gameOver; t++) {
+                sim.step(action);
+            }
+
+            int child;
+            if(expand) {
+                child = newNode(tree);
+                tree.nodes[node].children[action] = child;
+            } else {
+                child = tree.nodes[node].children[action];
+            }
+            node = child;
+            path[++depth] = node;
+            if(expand) break;
+        }
+
+        // Simulación y propagación
+        bool alive = sim.state().lives == root.lives && !sim.state().gameOver;
+        double value = alive ? rollout(tree, root) : 0.0;
+        for(int i = 0; i <= depth; i++) {
+            tree.nodes[path[i]].visits++;
+            tree.nodes[path[i]].value += value;
+        }
+        tree.rollouts++;
+    }
+}
+
+double Autopilot::rollout(Tree &tree, const GameState &start) {
+    // Política aleatoria: sigue recto y de vez en cuando cambia de dirección
+    PacmanCore &sim = *tree.sim;
+    int dir = sim.state().pacmanDir;
+    for(int t = 0; t < ROLLOUT_TICKS && !sim.state().gameOver; t++) {
+        tree.rng = xorshift32(tree.rng);
+        if((tree.rng & 7) == 0) dir = (tree.rng >> 3) & 3;
+        sim.step(dir);
+        if(sim.state().lives < start.lives) break;
+    }
+    return reward(start, sim.state(), sim.distances());
+}
@@ -0,0 +1,52 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "pacmancore.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Piloto automático con Monte Carlo Tree Search. Cada decisión reparte
+// varios árboles independientes entre los hilos del pool (paralelismo de
+// raíz); cada árbol hace iteraciones hasta agotar el presupuesto de tiempo
+// y al final se suman las visitas de las acciones de la raíz.
+// Las simulaciones copian el GameState (un struct plano) sobre un
+// PacmanCore propio de cada árbol, sin tocar objetos de Qt.
+class Autopilot {
+public:
+    // threads = 0 usa todos los núcleos
+    explicit Autopilot(int threads = 0);
+
+    // Dirección elegida para el estado dado, pensando budgetMs milisegundos
+    int decide(const GameState &state, double budgetMs);
+
+    int threadCount() const { return pool.size(); }
+    long long lastRollouts() const { return rollouts; }
+    double rolloutsPerSecond() const { return rate; }
+
+private:
+    struct Node {
+        int children[4];
+        int visits;
+        double value;
+    };
+
+    struct Tree {
+        std::unique_ptr<PacmanCore> sim;
+        std::vector<Node> nodes;
+        uint32_t rng;
+        long long rollouts;
+    };
+
+    ThreadPool pool;
+    std::vector<Tree> trees;
+    long long rollouts;
+    double rate;
+
+    void search(Tree &tree, const GameState &root, double deadline);
+    double rollout(Tree &tree, const GameState &start);
+    int newNode(Tree &tree);
+};
+
+#endif // AUTOPILOT_H
@@ -0,0 +1,410 @@
+#include "batchcore.h"
+#include "ghostai.h"
+#include "rng.h"
+#include <cstdlib>
+
+namespace {
+
+// Solo dificultad arcade: velocidad y susto fijos, ghostWander 0
+const int32_t SPEED = ARCADE_DIFFICULTY.pacmanSpeed;
+const int32_t FRIGHTENED_TICKS = ARCADE_DIFFICULTY.frightenedTicks;
+const int32_t DIR_DX[4] = {1, 0, -1, 0};
+const int32_t DIR_DY[4] = {0, 1, 0, -1};
+const int32_t WORLD_WIDTH = GRID_WIDTH * SUBCELL;
+
+// Túnel (wrap around), igual que PacmanCore::getNextPos
+inline int32_t wrapX(int32_t x) {
+    x = x < 0 ? WORLD_WIDTH - HALF_CELL : x;
+    x = x >= WORLD_WIDTH ? HALF_CELL : x;
+    return x;
+}
+
+// Igual que PacmanCore::cellOf: x ya pasó por wrapX y el borde de arriba y
+// el de abajo son muro, así que no hace falta recortar
+inline int cellIndex(int32_t x, int32_t y) {
+    return (y >> SUBCELL_SHIFT) * GRID_WIDTH + (x >> SUBCELL_SHIFT);
+}
+
+// inGhostHouse() con la celda en coordenadas y sin saltos, para que el
+// bucle que la usa se pueda vectorizar
+inline bool inHouse(int32_t x, int32_t y) {
+    int cx = x >> SUBCELL_SHIFT;
+    int cy = y >> SUBCELL_SHIFT;
+    return ((cy == GHOST_HOUSE_Y) & (cx >= GHOST_HOUSE_X - 1) & (cx <= GHOST_HOUSE_X + 1)) |
+           ((cy == GHOST_HOUSE_Y - 1) & (cx == GHOST_HOUSE_X));
+}
+
+}
+
+PacmanBatch::PacmanBatch(int count, uint64_t seed) : n(count) {
+    // El mapa inicial sale del núcleo para no duplicar el laberinto
+    PacmanCore reference;
+    const GameState &s = reference.state();
+    initial = s;
+    maze = reference.distances();
+    for(int w = 0; w < MASK_WORDS; w++) {
+        initialDots[w] = s.dots.words[w] | s.powers.words[w];
+    }
+    for(int c = 0; c < CELL_COUNT; c++) {
+        walls[c] = s.walls.test(c);
+        powers[c] = s.powers.test(c);
+    }
+
+    pacmanX.resize(n); pacmanY.resize(n);
+    pacmanDir.resize(n); nextDir.resize(n); mouthAngle.resize(n);
+    ghostX.resize(n * NUM_GHOSTS); ghostY.resize(n * NUM_GHOSTS);
+    ghostDir.resize(n * NUM_GHOSTS);
+    ghostScared.resize(n * NUM_GHOSTS);
+    ghostRng.resize(n * NUM_GHOSTS);
+    dots.resize(n * MASK_WORDS);
+    score.resize(n); lives.resize(n); frightenedTimer.resize(n); ticks.resize(n);
+    ghostMode.resize(n); level.resize(n); levelTicks.resize(n); seeds.resize(n);
+    gameOver.resize(n);
+    active.resize(n);
+    powerEaten.resize(n);
+    modeChanged.resize(n);
+    modeUntil.resize(n);
+    close.resize(n);
+    ghostFlags.resize(n);
+    pacmanCell.resize(n);
+    blinkyCell.resize(n);
+    pacmanFromX.resize(n); pacmanFromY.resize(n);
+    ghostFromX.resize(n * NUM_GHOSTS); ghostFromY.resize(n * NUM_GHOSTS);
+
+    resetAll(seed);
+}
+
+void PacmanBatch::reset(int game, uint64_t seed) {
+    nextDir[game] = DIR_RIGHT;
+    mouthAngle[game] = 0;
+    score[game] = 0;
+    lives[game] = 3;
+    ticks[game] = 0;
+    level[game] = 1;
+    seeds[game] = seed;
+    gameOver[game] = 0;
+
+    // Mismos flujos que PacmanCore::reset con la misma semilla
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        ghostRng[g * n + game] = streamSeed(seed, g);
+    }
+
+    resetActors(game);
+}
+
+void PacmanBatch::resetActors(int game) {
+    pacmanX[game] = cellCentre(9, 15).x;
+    pacmanY[game] = cellCentre(9, 15).y;
+    pacmanDir[game] = DIR_RIGHT;
+    frightenedTimer[game] = 0;
+    ghostMode[game] = MODE_SCATTER;
+    levelTicks[game] = 0;
+    modeUntil[game] = 0;
+
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        int k = g * n + game;
+        Vec2 spawn = cellCentre(GHOST_SPAWNS[g].x, GHOST_SPAWNS[g].y);
+        ghostX[k] = spawn.x;
+        ghostY[k] = spawn.y;
+        ghostDir[k] = GHOST_SPAWNS[g].dir;
+        ghostScared[k] = 0;
+    }
+
+    for(int w = 0; w < MASK_WORDS; w++) {
+        dots[game * MASK_WORDS + w] = initialDots[w];
+    }
+}
+
+void PacmanBatch::resetAll(uint64_t seed) {
+    for(int i = 0; i < n; i++) {
+        reset(i, seed + i);
+    }
+}
+
+void PacmanBatch::step_all(const int8_t *inputs) {
+    for(int i = 0; i < n; i++) {
+        active[i] = !gameOver[i];
+    }
+    if(inputs) {
+        // Una partida terminada ya no toma la tecla, como PacmanCore::step
+        for(int i = 0; i < n; i++) {
+            bool take = active[i] && inputs[i] >= DIR_RIGHT && inputs[i] <= DIR_UP;
+            nextDir[i] = take ? inputs[i] : nextDir[i];
+        }
+    }
+
+    movePacmen();
+    moveGhosts();
+    checkCollisions();
+    updateFrightened();
+    checkLevels();
+}
+
+void PacmanBatch::movePacmen() {
+    // Copias locales: una escritura de bytes puede solapar con cualquier
+    // cosa y obligaría a releer n y los vectores en cada vuelta
+    const int games = n;
+    const uint8_t *live = active.data();
+    int32_t *px = pacmanX.data();
+    int32_t *py = pacmanY.data();
+    int32_t *pd = pacmanDir.data();
+    int32_t *mouth = mouthAngle.data();
+    uint64_t *mask = dots.data();
+    uint8_t *eaten = powerEaten.data();
+    for(int i = 0; i < games; i++) {
+        int32_t x = px[i];
+        int32_t y = py[i];
+        int d = pd[i];
+        pacmanFromX[i] = x;
+        pacmanFromY[i] = y;
+        int nd = nextDir[i];
+
+        // Intentar cambiar dirección
+        bool turn = nd != d &&
+                    !walls[cellIndex(wrapX(x + DIR_DX[nd] * SPEED), y + DIR_DY[nd] * SPEED)];
+        d = turn ? nd : d;
+
+        // Mover en la dirección actual
+        int32_t nx = wrapX(x + DIR_DX[d] * SPEED);
+        int32_t ny = y + DIR_DY[d] * SPEED;
+        bool move = live[i] && !walls[cellIndex(nx, ny)];
+        x = move ? nx : x;
+        y = move ? ny : y;
+        px[i] = x;
+        py[i] = y;
+        pd[i] = live[i] ? d : pd[i];
+        int32_t m = mouth[i] + 5;
+        mouth[i] = move ? (m == 60 ? 0 : m) : mouth[i];
+
+        // Comer puntos
+        int c = cellIndex(x, y);
+        uint64_t &word = mask[i * MASK_WORDS + (c >> 6)];
+        uint64_t bit = (word >> (c & 63)) & live[i];
+        word &= ~(bit << (c & 63));
+        int power = powers[c] & static_cast<int>(bit);
+        int dot = static_cast<int>(bit) & ~power;
+        score[i] += dot * 10 + power * 50;
+        frightenedTimer[i] = power ? FRIGHTENED_TICKS : frightenedTimer[i];
+        eaten[i] = static_cast<uint8_t>(power);
+    }
+
+    // Power pellet: todos los fantasmas de esa partida se asustan y dan
+    // media vuelta
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        int32_t *gd = &ghostDir[g * games];
+        uint8_t *scared = &ghostScared[g * games];
+        for(int i = 0; i < games; i++) {
+            bool turn = eaten[i] && !scared[i];
+            gd[i] = turn ? (gd[i] + 2) % 4 : gd[i];
+            scared[i] = eaten[i] ? 1 : scared[i];
+        }
+    }
+}
+
+void PacmanBatch::moveGhosts() {
+    // Datos de cada partida que usan todos sus fantasmas, tomados antes de
+    // mover a ninguno. El modo solo se vuelve a mirar al llegar al tick
+    // en que cambia.
+    for(int i = 0; i < n; i++) {
+        modeChanged[i] = 0;
+        if(active[i] && levelTicks[i] >= modeUntil[i]) {
+            int mode = ghostModeAt(levelTicks[i]);
+            long long left = ticksToModeChange(levelTicks[i]);
+            modeUntil[i] = left < 0 ? INT32_MAX : levelTicks[i] + static_cast<int32_t>(left);
+            modeChanged[i] = mode != ghostMode[i];
+            ghostMode[i] = mode;
+        }
+        pacmanCell[i] = cellIndex(pacmanX[i], pacmanY[i]);
+        blinkyCell[i] = cellIndex(ghostX[BLINKY * n + i], ghostY[BLINKY * n + i]);
+    }
+
+    // Tres pasadas por fantasma: las dos sin saltos recorren todas las
+    // partidas y la del medio solo las que tienen algo que decidir (el
+    // fantasma en el centro de una celda, uno de cada siete ticks más o
+    // menos, o un cambio de modo). Copias locales como en movePacmen().
+    const int games = n;
+    const uint8_t *live = active.data();
+    const uint8_t *reverse = modeChanged.data();
+    const int32_t *levelTick = levelTicks.data();
+    uint8_t *flags = ghostFlags.data();
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        const int release = GHOST_SPAWNS[g].releaseTick;
+        int32_t *gx = &ghostX[g * games];
+        int32_t *gy = &ghostY[g * games];
+        int32_t *gd = &ghostDir[g * games];
+        int32_t *fromX = &ghostFromX[g * games];
+        int32_t *fromY = &ghostFromY[g * games];
+
+        // 1. Quién se mueve (no los que esperan en la casa) y quién decide
+        // (solo en el centro de la celda, a menos de medio paso)
+        for(int i = 0; i < games; i++) {
+            int32_t x = gx[i];
+            int32_t y = gy[i];
+            bool waiting = (levelTick[i] < release) & inHouse(x, y);
+            bool free = live[i] & !waiting;
+            int32_t fx = (x & (SUBCELL - 1)) - HALF_CELL;
+            int32_t fy = (y & (SUBCELL - 1)) - HALF_CELL;
+            bool centre = (2 * (fx < 0 ? -fx : fx) < SPEED) & (2 * (fy < 0 ? -fy : fy) < SPEED);
+            flags[i] = free * (GHOST_MOVES | (centre | reverse[i]) * GHOST_DECIDES);
+        }
+
+        // 2. Media vuelta por cambio de modo, ajuste al centro y decisión
+        for(int i = 0; i < games; i++) {
+            if(!(flags[i] & GHOST_DECIDES)) continue;
+            int k = g * games + i;
+            int32_t x = gx[i];
+            int32_t y = gy[i];
+            int d = reverse[i] ? (gd[i] + 2) % 4 : gd[i];
+            gd[i] = d;
+            int32_t cx = (x & ~(SUBCELL - 1)) + HALF_CELL;
+            int32_t cy = (y & ~(SUBCELL - 1)) + HALF_CELL;
+            int32_t fx = x - cx, fy = y - cy;
+            if(2 * std::abs(fx) >= SPEED || 2 * std::abs(fy) >= SPEED) continue;
+            gx[i] = cx;
+            gy[i] = cy;
+
+            // En un pasillo o un callejón la salida es obligada (el
+            // asustado gasta igual su número aleatorio): sin objetivo
+            int cell = cellIndex(cx, cy);
+            int options = maze.legalMoves(cell) & ~(1 << ((d + 2) % 4));
+            bool forced = (options & (options - 1)) == 0;
+            if(forced) {
+                ghostRng[k] = ghostScared[k] ? xorshift32(ghostRng[k]) : ghostRng[k];
+                d = options ? __builtin_ctz(options) : (d + 2) % 4;
+            } else if(ghostScared[k]) {
+                uint32_t r = xorshift32(ghostRng[k]);
+                ghostRng[k] = r;
+                d = randomGhostDirection(maze, cell, d, r);
+            } else {
+                int target = ghostTargetCell(g, ghostMode[i], cell, pacmanCell[i],
+                                             pacmanDir[i], blinkyCell[i], maze);
+                d = chooseGhostDirection(maze, cell, d, target);
+            }
+            gd[i] = d;
+        }
+
+        // 3. Un paso en la dirección elegida si no hay muro
+        for(int i = 0; i < games; i++) {
+            int32_t x = gx[i];
+            int32_t y = gy[i];
+            int d = gd[i];
+            fromX[i] = x;
+            fromY[i] = y;
+            int32_t nx = wrapX(x + DIR_DX[d] * SPEED);
+            int32_t ny = y + DIR_DY[d] * SPEED;
+            bool move = (flags[i] & GHOST_MOVES) & !walls[cellIndex(nx, ny)];
+            gx[i] = move ? nx : x;
+            gy[i] = move ? ny : y;
+        }
+    }
+}
+
+void PacmanBatch::checkCollisions() {
+    // Los fantasmas se revisan en orden, como en PacmanCore, porque una
+    // muerte reubica a Pac-Man antes de comparar con el siguiente. El
+    // contacto es a lo largo del tick, como en PacmanCore::checkCollisions.
+    // Primero un descarte sin saltos que el compilador vectoriza (lejos al
+    // final es lejos todo el tick); el recorrido solo se mira en las pocas
+    // partidas que quedan.
+    const int32_t far = HALF_CELL + 2 * SUBCELL;
+    const int games = n;
+    const uint8_t *live = active.data();
+    const int32_t *px = pacmanX.data();
+    const int32_t *py = pacmanY.data();
+    uint8_t *near = close.data();
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        const int32_t *gx = &ghostX[g * games];
+        const int32_t *gy = &ghostY[g * games];
+        for(int i = 0; i < games; i++) {
+            int32_t dx = px[i] - gx[i];
+            int32_t dy = py[i] - gy[i];
+            near[i] = live[i] & (dx < far) & (dx > -far) & (dy < far) & (dy > -far);
+        }
+        for(int i = 0; i < games; i++) {
+            if(!near[i]) continue;
+            int k = g * games + i;
+            bool hit = PacmanCore::sweptContact({pacmanFromX[i], pacmanFromY[i]},
+                                                {pacmanX[i], pacmanY[i]},
+                                                {ghostFromX[k], ghostFromY[k]},
+                                                {ghostX[k], ghostY[k]});
+            if(!hit) continue;
+
+            if(ghostScared[k]) {
+                // Fantasma comido: vuelve a la casa
+                score[i] += 200;
+                ghostX[k] = cellCentre(GHOST_HOUSE_X, GHOST_HOUSE_Y).x;
+                ghostY[k] = cellCentre(GHOST_HOUSE_X, GHOST_HOUSE_Y).y;
+                ghostDir[k] = DIR_UP;
+                ghostScared[k] = 0;
+            } else if(--lives[i] <= 0) {
+                gameOver[i] = 1;
+            } else {
+                // Para los fantasmas que faltan, quieto en la salida
+                pacmanX[i] = pacmanFromX[i] = cellCentre(9, 15).x;
+                pacmanY[i] = pacmanFromY[i] = cellCentre(9, 15).y;
+            }
+        }
+    }
+}
+
+void PacmanBatch::updateFrightened() {
+    for(int i = 0; i < n; i++) {
+        int t = frightenedTimer[i];
+        frightenedTimer[i] = active[i] && t > 0 ? t - 1 : t;
+        ticks[i] += active[i];
+        levelTicks[i] += active[i];
+    }
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        for(int i = 0; i < n; i++) {
+            int k = g * n + i;
+            ghostScared[k] = frightenedTimer[i] == 0 ? 0 : ghostScared[k];
+        }
+    }
+}
+
+void PacmanBatch::checkLevels() {
+    // Nivel completado: mapa lleno de nuevo y actores en su sitio
+    for(int i = 0; i < n; i++) {
+        uint64_t any = 0;
+        for(int w = 0; w < MASK_WORDS; w++) any |= dots[i * MASK_WORDS + w];
+        if(any == 0 && !gameOver[i]) {
+            level[i]++;
+            resetActors(i);
+        }
+    }
+}
+
+void PacmanBatch::exportState(int game, GameState &out) const {
+    out = initial;
+    for(int w = 0; w < MASK_WORDS; w++) {
+        uint64_t present = dots[game * MASK_WORDS + w];
+        out.dots.words[w] = present & initial.dots.words[w];
+        out.powers.words[w] = present & initial.powers.words[w];
+    }
+
+    out.pacmanPos = {pacmanX[game], pacmanY[game]};
+    out.pacmanDir = pacmanDir[game];
+    out.nextDir = nextDir[game];
+    out.mouthAngle = mouthAngle[game];
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        int k = g * n + game;
+        out.ghosts[g] = {{ghostX[k], ghostY[k]}, ghostDir[k], ghostScared[k] != 0, ghostRng[k]};
+    }
+    out.score = score[game];
+    out.lives = lives[game];
+    out.gameOver = gameOver[game] != 0;
+    out.frightenedTimer = frightenedTimer[game];
+    out.ghostMode = ghostMode[game];
+    out.level = level[game];
+    out.seed = seeds[game];
+    out.levelTick = levelTicks[game];
+    out.tick = ticks[game];
+}
+
+int PacmanBatch::dotsRemaining(int game) const {
+    int count = 0;
+    for(int w = 0; w < MASK_WORDS; w++) {
+        count += __builtin_popcountll(dots[game * MASK_WORDS + w]);
+    }
+    return count;
+}
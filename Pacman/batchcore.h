@@ -0,0 +1,88 @@
+#ifndef BATCHCORE_H
+#define BATCHCORE_H
+
+#include "pacmancore.h"
+#include "mazedistances.h"
+#include <cstdint>
+#include <vector>
+
+// N partidas independientes en forma struct-of-arrays. Cada campo es un
+// arreglo contiguo indexado por partida (los de fantasmas por
+// [fantasma * N + partida]) para que step_all() recorra todas las partidas
+// con bucles simples que el compilador puede vectorizar.
+// Las reglas son las de PacmanCore::step; las posiciones son enteras, en
+// unidades de SUBCELL como en el núcleo, y los generadores de los
+// fantasmas son los mismos de PacmanCore. Las decisiones de los fantasmas
+// en los cruces usan las mismas funciones de ghostai.h que el núcleo, en
+// una pasada aparte que solo visita las partidas con algo que decidir.
+// batch_bench comprueba que las dos den el mismo estado.
+// Solo hay dificultad arcade (ARCADE_DIFFICULTY): no hay setDifficulty()
+// y sus parámetros son constantes del bucle, no campos por partida.
+class PacmanBatch {
+public:
+    // Palabras de 64 bits para una máscara con una celda por bit
+    static const int MASK_WORDS = Bitboard::WORDS;
+
+    explicit PacmanBatch(int count, uint64_t seed = 1);
+
+    int size() const { return n; }
+
+    void reset(int game, uint64_t seed);
+    void resetAll(uint64_t seed);
+
+    // Avanza un tick todas las partidas. inputs tiene size() direcciones
+    // (DIR_NONE conserva la anterior); puede ser nullptr.
+    void step_all(const int8_t *inputs);
+
+    // Copia el estado de una partida al formato de PacmanCore
+    void exportState(int game, GameState &out) const;
+
+    int dotsRemaining(int game) const;
+
+    // Estado (struct-of-arrays)
+    std::vector<int32_t> pacmanX, pacmanY;
+    std::vector<int32_t> pacmanDir, nextDir, mouthAngle;
+    std::vector<int32_t> ghostX, ghostY;
+    std::vector<int32_t> ghostDir;
+    std::vector<uint8_t> ghostScared;
+    std::vector<uint32_t> ghostRng;
+    std::vector<uint64_t> dots; // puntos y power pellets, [partida * MASK_WORDS + palabra]
+    std::vector<int32_t> score, lives, frightenedTimer, ticks, ghostMode;
+    std::vector<int32_t> level, levelTicks;
+    std::vector<uint64_t> seeds;
+    std::vector<uint8_t> gameOver;
+
+private:
+    enum GhostFlag : uint8_t { GHOST_MOVES = 1, GHOST_DECIDES = 2 };
+
+    int n;
+
+    // Auxiliares de un step_all()
+    std::vector<uint8_t> active;
+    std::vector<uint8_t> powerEaten;
+    std::vector<uint8_t> modeChanged;
+    std::vector<int32_t> modeUntil; // levelTicks del próximo cambio de modo
+    std::vector<uint8_t> close; // Pac-Man cerca del fantasma que se revisa
+    std::vector<uint8_t> ghostFlags; // GhostFlag del fantasma que se mueve
+    std::vector<int32_t> pacmanCell, blinkyCell;
+    // Dónde empezó el recorrido de cada actor en este tick (los fantasmas,
+    // ya ajustados al centro), para el contacto a lo largo del tick
+    std::vector<int32_t> pacmanFromX, pacmanFromY;
+    std::vector<int32_t> ghostFromX, ghostFromY;
+
+    // Tablas del mapa compartidas por todas las partidas
+    GameState initial;
+    MazeDistances maze;
+    uint8_t walls[CELL_COUNT];
+    uint8_t powers[CELL_COUNT];
+    uint64_t initialDots[MASK_WORDS];
+
+    void resetActors(int game);
+    void movePacmen();
+    void moveGhosts();
+    void checkCollisions();
+    void updateFrightened();
+    void checkLevels();
+};
+
+#endif // BATCHCORE_H
@@ -0,0 +1,94 @@
+// Rendimiento de PacmanBatch: ticks de partida por segundo con step_all()
+// según la cantidad de partidas del lote, contra PacmanCore::step() de a
+// una. También comprueba que el lote y el núcleo terminen en el mismo
+// estado con las mismas entradas. El objetivo son 10M ticks/s en un núcleo.
+//   batch_bench [partidas] [ticks]
+#include "batchcore.h"
+#include "replay.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Ticks de partida por segundo; las que terminan vuelven a empezar fuera
+// del tiempo medido para que todo el lote siga jugando
+double batchRate(int games, int ticks) {
+    PacmanBatch batch(games, 1);
+    std::vector<int8_t> inputs(games, DIR_LEFT);
+    std::vector<uint32_t> rng(games);
+    for(int i = 0; i < games; i++) rng[i] = streamSeed(i, 9);
+
+    double busy = 0.0;
+    for(int t = 0; t < ticks; t++) {
+        for(int i = 0; i < games; i++) inputs[i] = static_cast<int8_t>(randomTurn(rng[i], inputs[i]));
+        double start = nowSeconds();
+        batch.step_all(inputs.data());
+        busy += nowSeconds() - start;
+        for(int i = 0; i < games; i++) {
+            if(batch.gameOver[i]) batch.reset(i, batch.seeds[i] + games);
+        }
+    }
+    return static_cast<double>(games) * ticks / busy;
+}
+
+double coreRate(int ticks) {
+    PacmanCore core;
+    core.reset(1);
+    uint32_t rng = 5;
+    int8_t dir = DIR_LEFT;
+    double start = nowSeconds();
+    for(int t = 0; t < ticks; t++) {
+        if(core.state().gameOver) core.reset(core.state().seed + 1);
+        dir = static_cast<int8_t>(randomTurn(rng, dir));
+        core.step(dir);
+    }
+    return ticks / (nowSeconds() - start);
+}
+
+// Mismas entradas en el lote y en un núcleo por partida
+int countMismatches(int games, int ticks) {
+    PacmanBatch batch(games, 100);
+    std::vector<PacmanCore> cores(games);
+    std::vector<int8_t> inputs(games, DIR_LEFT);
+    std::vector<uint32_t> rng(games);
+    for(int i = 0; i < games; i++) {
+        cores[i].reset(100 + i);
+        rng[i] = streamSeed(i, 3);
+    }
+    for(int t = 0; t < ticks; t++) {
+        for(int i = 0; i < games; i++) {
+            inputs[i] = static_cast<int8_t>(randomTurn(rng[i], inputs[i]));
+            cores[i].step(inputs[i]);
+        }
+        batch.step_all(inputs.data());
+    }
+    int mismatches = 0;
+    GameState s;
+    for(int i = 0; i < games; i++) {
+        batch.exportState(i, s);
+        mismatches += stateHash(s) != stateHash(cores[i].state());
+    }
+    return mismatches;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int games = argc > 1 ? std::atoi(argv[1]) : 4096;
+    int ticks = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    std::printf("PacmanCore::step  %12.0f ticks/s\n", coreRate(games > 0 ? 200000 : 0));
+    for(int n : {64, 1024, games}) {
+        std::printf("step_all %6d    %12.0f ticks/s\n", n, batchRate(n, ticks));
+    }
+    int mismatches = countMismatches(256, 3000);
+    std::printf("lote contra núcleo: %d de 256 partidas distintas\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+// Mapa en bloques y cámara: memoria por celda y costo de un frame con la
+// cámara siguiendo a un Pac-Man que recorre el laberinto, para laberintos
+// cada vez más grandes (el costo por frame tiene que quedar igual). Cada
+// frame copia las celdas de los bloques visibles a un framebuffer de
+// celdas, como haría la vista con sus pixmaps, y cuenta los bloques que
+// entran por primera vez (los que la vista tendría que pintar). Al final
+// juega una ProceduralGame (lo que corre pacman --maze) con un bot y mide
+// el tick.
+//   chunk_bench [frames] [semilla]
+#include "chunkedmaze.h"
+#include "camera.h"
+#include "mazegen.h"
+#include "proceduralgame.h"
+#include "rng.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const int VIEW_COLUMNS = 40;
+const int VIEW_ROWS = 30;
+const double SPEED = 0.15; // celdas por frame, como pacmanSpeed
+
+double nowUs() {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Pac-Man de prueba: avanza por el pasillo y en cada cruce elige al azar
+// (sin volver atrás si puede evitarlo)
+struct Walker {
+    int cell, dir;
+    double progress;
+    uint32_t rng;
+};
+
+void walk(const ProceduralMaze &maze, Walker &walker, double &x, double &y) {
+    walker.progress += SPEED;
+    while(walker.progress >= 1.0) {
+        walker.progress -= 1.0;
+        int next = maze.neighbour(walker.cell, walker.dir);
+        if(next >= 0) walker.cell = next;
+        int moves = maze.legalMoves(walker.cell) & ~(1 << ((walker.dir + 2) % 4));
+        if(!moves) moves = maze.legalMoves(walker.cell);
+        int options[4], count = 0;
+        for(int d = 0; d < 4; d++) if(moves & (1 << d)) options[count++] = d;
+        walker.rng = xorshift32(walker.rng);
+        walker.dir = options[walker.rng % count];
+    }
+    x = walker.cell % maze.width() + 0.5;
+    y = walker.cell / maze.width() + 0.5;
+}
+
+// Copia la ventana de la cámara desde los bloques; devuelve los bloques tocados
+int blitView(const ChunkedMaze &tiles, const Camera &camera, std::vector<uint8_t> &frame) {
+    const int left = static_cast<int>(camera.left()), top = static_cast<int>(camera.top());
+    const int columns = static_cast<int>(camera.viewWidth()) + 1;
+    const int rows = static_cast<int>(camera.viewHeight()) + 1;
+    ChunkedMaze::ChunkRange range = tiles.chunksIn(left, top, columns, rows);
+    for(int chunkY = range.y0; chunkY < range.y1; chunkY++) {
+        for(int chunkX = range.x0; chunkX < range.x1; chunkX++) {
+            const uint8_t *cells = tiles.chunk(chunkX, chunkY);
+            int x0 = std::max(left, chunkX * ChunkedMaze::CHUNK);
+            int x1 = std::min({left + columns, (chunkX + 1) * ChunkedMaze::CHUNK, tiles.width()});
+            int y0 = std::max(top, chunkY * ChunkedMaze::CHUNK);
+            int y1 = std::min({top + rows, (chunkY + 1) * ChunkedMaze::CHUNK, tiles.height()});
+            for(int y = y0; y < y1; y++) {
+                const uint8_t *src = cells + (y - chunkY * ChunkedMaze::CHUNK) * ChunkedMaze::CHUNK;
+                std::copy(src + (x0 - chunkX * ChunkedMaze::CHUNK),
+                          src + (x1 - chunkX * ChunkedMaze::CHUNK),
+                          &frame[(y - top) * columns + (x0 - left)]);
+            }
+        }
+    }
+    return range.count();
+}
+
+// Partida entera en un laberinto grande: costo del tick, y los actores
+// nunca dentro de un muro ni una celda cambiada (punto comido o puerta)
+// distinta del laberinto
+bool playGame(int side, int ticks, uint64_t seed, ThreadPool &pool) {
+    ProceduralGame game(side, seed, pool);
+    const ProceduralMaze &maze = game.maze();
+    auto open = [&](Vec2 pos) {
+        return !maze.isWall(pos.x >> SUBCELL_SHIFT, pos.y >> SUBCELL_SHIFT);
+    };
+
+    bool ok = true;
+    uint32_t rng = streamSeed(seed, 2);
+    int dir = DIR_LEFT;
+    long long eaten = 0;
+    int games = 1;
+    std::vector<double> times(ticks);
+    for(int t = 0; t < ticks; t++) {
+        dir = randomTurn(rng, dir);
+        if(game.state().gameOver) {
+            game.reset();
+            games++;
+        }
+        double a = nowUs();
+        game.step(dir);
+        times[t] = nowUs() - a;
+
+        const GameState &s = game.state();
+        ok = ok && open(s.pacmanPos);
+        for(int i = 0; i < NUM_GHOSTS; i++) ok = ok && open(s.ghosts[i].pos);
+        eaten += game.changedCells().size();
+        for(int cell : game.changedCells()) {
+            uint8_t content = game.tiles().at(cell % maze.width(), cell / maze.width());
+            ok = ok && content == (maze.isWall(cell) ? CELL_WALL : CELL_EMPTY);
+        }
+    }
+
+    std::sort(times.begin(), times.end());
+    std::printf("partida %dx%d: tick p50 %.2f us, p99 %.2f us; %d partidas, %lld puntos comidos\n",
+                maze.width(), maze.height(), times[ticks / 2], times[ticks * 99 / 100],
+                games, eaten);
+    return ok;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 20000;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    ThreadPool pool;
+    const int sides[] = {64, 512, 2048, 4095};
+    bool ok = true;
+    std::printf("%6s %9s %10s %8s %9s %9s %9s %8s %10s\n", "lado", "celdas", "bytes/celda",
+                "carga ms", "frame p50", "p99 us", "max us", "bloques", "nuevos/s");
+    for(int side : sides) {
+        ProceduralMaze maze(side, side, seed, pool);
+        double t0 = nowUs();
+        ChunkedMaze tiles(maze);
+        double t1 = nowUs();
+
+        Camera camera;
+        camera.setWorld(tiles.width(), tiles.height());
+        camera.setViewport(std::min(tiles.width(), VIEW_COLUMNS), std::min(tiles.height(), VIEW_ROWS));
+        Walker walker = {maze.pacmanStart(), DIR_LEFT, 0.0, streamSeed(seed, 1)};
+        double x = walker.cell % maze.width() + 0.5, y = walker.cell / maze.width() + 0.5;
+        camera.centre(x, y);
+
+        std::vector<uint8_t> frame((VIEW_COLUMNS + 1) * (VIEW_ROWS + 1));
+        std::vector<double> times(frames);
+        std::vector<int> seen(tiles.chunksX() * tiles.chunksY(), -1);
+        long long touched = 0, entered = 0;
+        for(int f = 0; f < frames; f++) {
+            walk(maze, walker, x, y);
+            double a = nowUs();
+            camera.follow(x, y);
+            touched += blitView(tiles, camera, frame);
+            times[f] = nowUs() - a;
+
+            // Bloques que no estaban a la vista en el frame anterior
+            ChunkedMaze::ChunkRange range = tiles.chunksIn(camera.left(), camera.top(),
+                                                           camera.viewWidth(), camera.viewHeight());
+            for(int cy = range.y0; cy < range.y1; cy++) {
+                for(int cx = range.x0; cx < range.x1; cx++) {
+                    int &last = seen[cy * tiles.chunksX() + cx];
+                    entered += last != f - 1;
+                    last = f;
+                }
+            }
+
+            // Pac-Man siempre a la vista, y lo copiado igual al laberinto
+            ok = ok && x >= camera.left() && x <= camera.left() + camera.viewWidth() &&
+                 y >= camera.top() && y <= camera.top() + camera.viewHeight();
+            if(f % 997 == 0) {
+                int left = static_cast<int>(camera.left()), top = static_cast<int>(camera.top());
+                int columns = static_cast<int>(camera.viewWidth()) + 1;
+                for(int j = 0; j < VIEW_ROWS && top + j < tiles.height(); j++) {
+                    for(int i = 0; i < columns && left + i < tiles.width(); i++) {
+                        bool wall = frame[j * columns + i] == CELL_WALL;
+                        ok = ok && wall == maze.isWall(left + i, top + j);
+                    }
+                }
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+        std::printf("%6d %9d %10.3f %8.1f %9.2f %9.2f %9.2f %8.1f %10.1f\n", tiles.width(),
+                    maze.cellCount(), static_cast<double>(tiles.memoryBytes()) / maze.cellCount(),
+                    (t1 - t0) / 1000, times[frames / 2], times[frames * 99 / 100], times.back(),
+                    static_cast<double>(touched) / frames,
+                    static_cast<double>(entered) / frames * 60);
+    }
+    ok = playGame(2047, frames, seed, pool) && ok;
+    std::printf("%s\n", ok ? "ok" : "ERROR");
+    return ok ? 0 : 1;
+}
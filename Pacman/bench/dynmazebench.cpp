@@ -0,0 +1,155 @@
+// Laberintos con puertas: se abren y cierran muros al azar en un laberinto
+// procedural grande y el campo de distancias hacia la puerta de la casa
+// se repara en cada cambio. Se compara el costo de reparar contra el de
+// volver a calcularlo entero, y cada tanto se comprueba que los dos den
+// exactamente lo mismo. Al final lo mismo dentro de una partida
+// (pacman --maze), con las puertas que se mueven alrededor de Pac-Man.
+//   dynmaze_bench [lado] [semilla] [cambios]
+#include "distancefield.h"
+#include "mazegen.h"
+#include "proceduralgame.h"
+#include "rng.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+double nowUs() {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Un hueco entre dos celdas de pasillo (x + y impar), dentro del borde y
+// lejos de la casa: ahí un muro es una puerta que corta o abre un paso
+int randomDoor(const ProceduralMaze &maze, uint32_t &rng) {
+    for(;;) {
+        rng = xorshift32(rng);
+        int x = 1 + static_cast<int>(rng % (maze.width() - 2));
+        int y = 1 + static_cast<int>((rng >> 16) % (maze.height() - 2));
+        if((x + y) % 2 == 0) continue;
+        if(std::abs(x - (maze.houseX() + maze.houseWidth() / 2)) < maze.houseWidth() + 3 &&
+           std::abs(y - (maze.houseY() + maze.houseHeight() / 2)) < maze.houseHeight() + 3) {
+            continue;
+        }
+        return y * maze.width() + x;
+    }
+}
+
+struct Timing {
+    double us = 0;
+    long long touched = 0;
+    long long maxTouched = 0;
+    int count = 0;
+
+    void add(double t, long long cells) {
+        us += t;
+        touched += cells;
+        maxTouched = std::max(maxTouched, cells);
+        count++;
+    }
+};
+
+void printTiming(const char *label, const Timing &t) {
+    if(t.count == 0) return;
+    std::printf("  %-7s %6d cambios  %9.2f us  %10.0f celdas tocadas de media, %lld como mucho\n",
+                label, t.count, t.us / t.count, static_cast<double>(t.touched) / t.count,
+                t.maxTouched);
+}
+
+}
+
+// ProceduralGame con un bot al azar: su campo hacia la casa, reparado en
+// cada puerta, contra uno recalculado; devuelve las comprobaciones distintas
+int playGame(int side, uint64_t seed, int ticks, ThreadPool &pool) {
+    ProceduralGame game(side, seed, pool);
+    const int door = game.maze().doorCell();
+    const int checkEvery = std::max(1, ticks / 20);
+    uint32_t rng = streamSeed(seed, 2);
+    int dir = DIR_LEFT;
+    int mismatches = 0;
+    for(int t = 0; t < ticks; t++) {
+        dir = randomTurn(rng, dir);
+        if(game.state().gameOver) game.reset();
+        game.step(dir);
+        if(t % checkEvery == 0 || t + 1 == ticks) {
+            DistanceField reference(game.maze(), {door});
+            if(reference.data() != game.homeField().data()) mismatches++;
+        }
+    }
+    std::printf("partida: %lld puertas en %d ticks; %d comprobaciones distintas\n",
+                game.doorToggles(), ticks, mismatches);
+    return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 2048;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    int changes = argc > 3 ? std::atoi(argv[3]) : 2000;
+
+    ThreadPool pool;
+    ProceduralMaze maze(side, side, seed, pool);
+    const int door = maze.doorCell();
+    std::printf("laberinto %dx%d, campo hacia la puerta de la casa\n", maze.width(), maze.height());
+
+    double t0 = nowUs();
+    DistanceField field(maze, {door});
+    double buildUs = nowUs() - t0;
+
+    // Unos 40 recálculos completos repartidos entre los cambios
+    const int checkEvery = std::max(1, changes / 40);
+    Timing opened, closed, full;
+    full.add(buildUs, maze.cellCount());
+    int mismatches = 0;
+    uint32_t rng = streamSeed(seed, 1);
+    for(int i = 0; i < changes; i++) {
+        int cell = randomDoor(maze, rng);
+        bool wall = !maze.isWall(cell);
+        maze.setWall(cell, wall);
+
+        double a = nowUs();
+        field.wallChanged(cell);
+        double b = nowUs();
+        (wall ? closed : opened).add(b - a, field.lastTouched());
+
+        if(i % checkEvery == 0 || i + 1 == changes) {
+            double c = nowUs();
+            DistanceField reference(maze, {door});
+            full.add(nowUs() - c, maze.cellCount());
+            if(reference.data() != field.data()) mismatches++;
+        }
+    }
+
+    printTiming("abrir", opened);
+    printTiming("cerrar", closed);
+    std::printf("  %-7s %6d veces    %9.2f us\n", "entero", full.count, full.us / full.count);
+    double incremental = (opened.us + closed.us) / std::max(1, opened.count + closed.count);
+    std::printf("reparar es %.0fx más rápido que recalcular; %d comprobaciones distintas\n",
+                (full.us / full.count) / incremental, mismatches);
+
+    // Un fantasma comido vuelve a casa desde cualquier lado siguiendo el
+    // campo ya reparado
+    int start;
+    do {
+        rng = xorshift32(rng);
+        start = static_cast<int>(rng % maze.cellCount());
+    } while(maze.isWall(start));
+    int ghost = start;
+    int steps = 0;
+    while(field.distance(ghost) > 0 && steps <= maze.cellCount()) {
+        ghost = maze.neighbour(ghost, field.downhill(ghost));
+        steps++;
+    }
+    bool cut = field.distance(start) == DistanceField::UNREACHABLE;
+    bool home = cut || (ghost == door && steps == field.distance(start));
+    std::printf("de (%d, %d) a la casa: %d pasos (%s)\n", start % maze.width(), start / maze.width(),
+                steps, cut ? "sin camino" : home ? "ok" : "NO LLEGA");
+
+    bool ok = mismatches == 0 && home;
+    ok = playGame(side, seed, 20000, pool) == 0 && ok;
+    std::printf("%s\n", ok ? "ok" : "ERROR");
+    return ok ? 0 : 1;
+}
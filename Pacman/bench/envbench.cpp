@@ -0,0 +1,127 @@
+// Entorno para entrenamiento por memoria compartida y socket Unix: un
+// proceso hijo atiende y este hace de entrenador. Para varios tamaños de
+// lote mide la ida y vuelta de un step (y cuánto de eso es simular, con
+// el mismo lote en este proceso; partidas-step/s cuenta solo la espera)
+// y comprueba que las observaciones coincidan con una copia local de las
+// partidas, incluido el mapa.
+//   env_bench [segundos por tamaño]
+#include "envserver.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const char *SOCKET_PATH = "/tmp/pacman-env-bench.sock";
+const char *SHM_NAME = "/pacman-env-bench";
+
+double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// La observación tiene que ser la partida local, celda por celda
+bool matches(const EnvObservation &o, const PacmanBatch &batch, int env) {
+    GameState s;
+    batch.exportState(env, s);
+    bool same = o.pacmanX == s.pacmanPos.x && o.pacmanY == s.pacmanPos.y && o.pacmanDir == s.pacmanDir &&
+                o.score == s.score && o.lives == s.lives && o.frightenedTimer == s.frightenedTimer &&
+                o.level == s.level && o.done == s.gameOver && o.tick == s.tick;
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        same = same && o.ghostX[g] == s.ghosts[g].pos.x && o.ghostY[g] == s.ghosts[g].pos.y &&
+               o.ghostDir[g] == s.ghosts[g].dir && o.ghostScared[g] == s.ghosts[g].scared;
+    }
+    for(int c = 0; c < CELL_COUNT; c++) {
+        same = same && o.map[c] == s.cellAt(c % GRID_WIDTH, c / GRID_WIDTH);
+    }
+    return same;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    const int sizes[] = {1, 16, 256};
+    bool ok = true;
+
+    std::printf("%8s %10s %12s %12s %12s %14s\n", "partidas", "steps", "ida y vuelta us",
+                "simular us", "costo us", "partidas-step/s");
+    for(int envs : sizes) {
+        EnvServer server(envs, 1);
+        if(!server.open(SOCKET_PATH, SHM_NAME)) {
+            std::printf("no se pudo abrir el servidor\n");
+            return 1;
+        }
+        pid_t child = ::fork();
+        if(child == 0) {
+            server.serve();
+            ::_exit(0);
+        }
+
+        EnvClient client;
+        if(!client.connect(SOCKET_PATH, SHM_NAME)) {
+            std::printf("no se pudo conectar\n");
+            ::kill(child, SIGKILL);
+            return 1;
+        }
+        PacmanBatch local(envs, 1);
+
+        // Entrenador de prueba: cambia de dirección al azar y reinicia en
+        // un solo mensaje las partidas terminadas
+        std::vector<int8_t> actions(envs, DIR_LEFT);
+        std::vector<EnvReset> resets;
+        uint32_t rng = 99;
+        long long steps = 0, checked = 0;
+        uint64_t nextSeed = 1000;
+        double start = nowSeconds(), waited = 0;
+        while(nowSeconds() - start < seconds) {
+            for(int i = 0; i < envs; i++) {
+                actions[i] = static_cast<int8_t>(randomTurn(rng, actions[i]));
+            }
+            double t = nowSeconds();
+            ok = ok && client.step(actions.data());
+            waited += nowSeconds() - t;
+            local.step_all(actions.data());
+            steps++;
+
+            resets.clear();
+            for(int i = 0; i < envs; i++) {
+                if(client.observation(i).done) resets.push_back({static_cast<uint32_t>(i), 0, nextSeed++});
+            }
+            if(!resets.empty()) {
+                ok = ok && client.reset(resets.data(), static_cast<int>(resets.size()));
+                for(const EnvReset &r : resets) local.reset(static_cast<int>(r.env), r.seed);
+            }
+            if(steps % 101 == 0 || !resets.empty()) {
+                for(int i = 0; i < envs; i++) ok = ok && matches(client.observation(i), local, i);
+                checked++;
+            }
+        }
+        ok = ok && client.steps() == static_cast<uint64_t>(steps);
+        ok = ok && client.shutdown();
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+        // Lo mismo sin salir del proceso: lo que cuesta simular el lote
+        PacmanBatch alone(envs, 1);
+        double a = nowSeconds();
+        for(long long k = 0; k < steps; k++) {
+            for(int i = 0; i < envs; i++) {
+                if(alone.gameOver[i]) alone.reset(i, nextSeed++);
+            }
+            alone.step_all(actions.data());
+        }
+        double simulate = nowSeconds() - a;
+
+        double roundTrip = waited / steps * 1e6, sim = simulate / steps * 1e6;
+        std::printf("%8d %10lld %12.2f %12.2f %12.2f %14.0f\n", envs, steps, roundTrip, sim,
+                    roundTrip - sim, steps * static_cast<double>(envs) / waited);
+        ok = ok && checked > 0;
+    }
+    std::printf("%s\n", ok ? "ok" : "ERROR");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Costo de una decisión de fantasma: la IA aleatoria original, la misma
+// persecución resuelta con un BFS en cada decisión y la versión con las
+// tablas de MazeDistances.
+#include "pacmancore.h"
+#include "ghostai.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+struct Query {
+    Vec2 pos;
+    int cell;
+    int dir;
+    int target;
+};
+
+volatile int sink;
+
+template <typename F>
+double nsPerCall(const std::vector<Query> &queries, int rounds, F decide) {
+    auto start = std::chrono::steady_clock::now();
+    int acc = 0;
+    for(int r = 0; r < rounds; r++) {
+        for(const Query &q : queries) acc += decide(q);
+    }
+    sink = acc;
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start).count();
+    return ns / (double(rounds) * queries.size());
+}
+
+// Distancia por BFS sobre el mapa, sin tablas
+int bfsDistance(const MazeDistances &maze, int from, int to) {
+    static int seen[GRID_WIDTH * GRID_HEIGHT];
+    static int queue[GRID_WIDTH * GRID_HEIGHT];
+    static int stamp = 0;
+    stamp++;
+    int head = 0, tail = 0;
+    queue[tail++] = from;
+    seen[from] = stamp;
+    int depth = 0;
+    while(head < tail) {
+        int levelEnd = tail;
+        while(head < levelEnd) {
+            int c = queue[head++];
+            if(c == to) return depth;
+            for(int d = 0; d < 4; d++) {
+                int n = maze.neighbour(c, d);
+                if(n >= 0 && seen[n] != stamp) {
+                    seen[n] = stamp;
+                    queue[tail++] = n;
+                }
+            }
+        }
+        depth++;
+    }
+    return MazeDistances::UNREACHABLE;
+}
+
+}
+
+int main() {
+    PacmanCore core;
+    const MazeDistances &maze = core.distances();
+
+    std::vector<int> cells;
+    for(int c = 0; c < GRID_WIDTH * GRID_HEIGHT; c++) {
+        if(maze.walkable(c)) cells.push_back(c);
+    }
+
+    srand(12345);
+    std::vector<Query> queries(4096);
+    for(Query &q : queries) {
+        q.cell = cells[rand() % cells.size()];
+        q.pos = cellCentre(q.cell % GRID_WIDTH, q.cell / GRID_WIDTH);
+        q.dir = rand() % 4;
+        q.target = cells[rand() % cells.size()];
+    }
+
+    const int rounds = 2000;
+
+    double random = nsPerCall(queries, rounds, [&](const Query &q) {
+        int dir = q.dir;
+        if(rand() % 20 == 0) dir = rand() % 4;
+        if(!core.canMove(q.pos, dir)) dir = rand() % 4;
+        return dir;
+    });
+
+    double search = nsPerCall(queries, rounds / 20, [&](const Query &q) {
+        int reverse = (q.dir + 2) % 4;
+        int best = reverse, bestDist = MazeDistances::UNREACHABLE + 1;
+        for(int d = 0; d < 4; d++) {
+            int n = maze.neighbour(q.cell, d);
+            if(d == reverse || n < 0) continue;
+            int dd = bfsDistance(maze, n, q.target);
+            if(dd < bestDist) {
+                bestDist = dd;
+                best = d;
+            }
+        }
+        return best;
+    });
+
+    double table = nsPerCall(queries, rounds, [&](const Query &q) {
+        int target = ghostTargetCell(PINKY, MODE_CHASE, q.cell, q.target,
+                                     q.dir, q.cell, maze);
+        return chooseGhostDirection(maze, q.cell, q.dir, target);
+    });
+
+    printf("celdas transitables: %d, tabla: %d bytes\n",
+           maze.walkableCount(), maze.walkableCount() * maze.walkableCount());
+    printf("aleatoria (original):   %8.1f ns/decision\n", random);
+    printf("persecucion con BFS:    %8.1f ns/decision\n", search);
+    printf("persecucion con tablas: %8.1f ns/decision\n", table);
+    return 0;
+}
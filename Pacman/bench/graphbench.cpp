@@ -0,0 +1,94 @@
+// Grafo de pasillos y partidas sin ventana: step() tick a tick contra
+// advance(), que salta los tramos sin eventos. El jugador de prueba decide
+// cada tantos ticks; entre decisiones una versión llama a step() y la otra
+// a advance(). Termina con error si alguna partida no acaba idéntica.
+// La huella de los estados finales no depende del compilador ni de las
+// opciones de compilación (todo el movimiento es entero): sirve para
+// comparar dos builds.
+//   graph_bench [partidas] [ticks_entre_decisiones]
+#include "pacmancore.h"
+#include "replay.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// Jugador de prueba: si Pac-Man se paró o de vez en cuando, una dirección
+// legal al azar desde su celda
+int botInput(const PacmanCore &core, uint32_t &rng, Vec2 &last) {
+    const GameState &s = core.state();
+    bool stopped = s.pacmanPos.x == last.x && s.pacmanPos.y == last.y;
+    last = s.pacmanPos;
+    rng = xorshift32(rng);
+    if(!stopped && rng % 4 != 0) return DIR_NONE;
+    int moves = core.distances().legalMoves(PacmanCore::cellOf(s.pacmanPos));
+    for(int k = 0; k < 4; k++) {
+        int d = static_cast<int>((rng >> 8) + k) % 4;
+        if((moves >> d) & 1) return d;
+    }
+    return DIR_NONE;
+}
+
+struct Outcome {
+    uint64_t hash;
+    long long ticks;
+};
+
+Outcome play(PacmanCore &core, uint64_t seed, int interval, bool useAdvance) {
+    core.reset(seed);
+    uint32_t rng = static_cast<uint32_t>(seed) | 1;
+    Vec2 last = core.state().pacmanPos;
+    while(!core.state().gameOver && core.state().tick < 20000) {
+        core.step(botInput(core, rng, last));
+        if(useAdvance) {
+            core.advance(interval - 1);
+        } else {
+            for(int t = 1; t < interval && !core.state().gameOver; t++) core.step();
+        }
+    }
+    return {stateHash(core.state()), core.state().tick};
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int games = argc > 1 ? std::atoi(argv[1]) : 200;
+    int interval = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    PacmanCore probe;
+    const MazeGraph &graph = probe.mazeGraph();
+    int corridors = 0;
+    for(int c = 0; c < CELL_COUNT; c++) corridors += graph.edgeOf(c) >= 0;
+    std::printf("grafo: %d nodos, %d aristas (por sentido), %d de %d celdas son pasillo\n",
+                graph.nodeCount(), graph.edgeCount(), corridors,
+                probe.distances().walkableCount());
+
+    PacmanCore cores[2];
+    double seconds[2] = {0.0, 0.0};
+    long long ticks[2] = {0, 0};
+    int mismatches = 0;
+    uint64_t fingerprint = 0;
+    for(int g = 0; g < games; g++) {
+        Outcome outcome[2];
+        for(int v = 0; v < 2; v++) {
+            auto start = std::chrono::steady_clock::now();
+            outcome[v] = play(cores[v], g + 1, interval, v == 1);
+            seconds[v] += std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start).count();
+            ticks[v] += outcome[v].ticks;
+        }
+        if(outcome[0].hash != outcome[1].hash || outcome[0].ticks != outcome[1].ticks) mismatches++;
+        fingerprint = (fingerprint ^ outcome[0].hash) * 1099511628211ull;
+    }
+
+    const char *names[2] = {"step", "advance"};
+    for(int v = 0; v < 2; v++) {
+        std::printf("%-8s %8.1f partidas/s  %6.1f ns/tick\n", names[v], games / seconds[v],
+                    seconds[v] * 1e9 / ticks[v]);
+    }
+    std::printf("aceleración %.2fx, %d partidas distintas\n", seconds[0] / seconds[1], mismatches);
+    std::printf("huella %016llx\n", static_cast<unsigned long long>(fingerprint));
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+// Laberintos procedurales y HPA*: tiempo de generación con un hilo y con
+// todos (el resultado tiene que ser el mismo), comprobación de las reglas
+// (sin callejones, conectado, con túneles y casa), construcción del grafo
+// jerárquico y consultas contra un BFS sobre toda la grilla.
+//   mazegen_bench [lado] [semilla] [tamaño_de_cuadrado]
+#include "mazegen.h"
+#include "hpapathfinder.h"
+#include "rng.h"
+#include "threadpool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+double nowMs() {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// BFS sobre toda la grilla (con túnel) hasta llegar a to; to = -1 recorre
+// todo. Devuelve la distancia, o las celdas alcanzadas si to = -1.
+int gridBfs(const ProceduralMaze &maze, int from, int to, std::vector<int32_t> &dist,
+            std::vector<int32_t> &queue) {
+    dist.assign(maze.cellCount(), -1);
+    queue.resize(maze.cellCount());
+    int head = 0, tail = 0;
+    dist[from] = 0;
+    queue[tail++] = from;
+    while(head < tail) {
+        int cell = queue[head++];
+        if(cell == to) return dist[cell];
+        for(int d = 0; d < 4; d++) {
+            int next = maze.neighbour(cell, d);
+            if(next < 0 || dist[next] >= 0) continue;
+            dist[next] = dist[cell] + 1;
+            queue[tail++] = next;
+        }
+    }
+    return to < 0 ? tail : -1;
+}
+
+int randomOpenCell(const ProceduralMaze &maze, uint32_t &rng) {
+    for(;;) {
+        rng = xorshift32(rng);
+        int cell = static_cast<int>(rng % maze.cellCount());
+        if(!maze.isWall(cell)) return cell;
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int side = argc > 1 ? std::atoi(argv[1]) : 2048;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    int clusterSize = argc > 3 ? std::atoi(argv[3]) : 32;
+
+    ThreadPool serial(1);
+    ThreadPool parallel;
+
+    double t0 = nowMs();
+    ProceduralMaze single(side, side, seed, serial);
+    double t1 = nowMs();
+    ProceduralMaze maze(side, side, seed, parallel);
+    double t2 = nowMs();
+    bool same = single.hash() == maze.hash();
+    std::printf("laberinto %dx%d: %.1f ms con 1 hilo, %.1f ms con %d (%s)\n",
+                maze.width(), maze.height(), t1 - t0, t2 - t1, parallel.size(),
+                same ? "idénticos" : "DISTINTOS");
+
+    // Reglas: sin callejones, todo alcanzable desde la salida de Pac-Man
+    int open = 0, deadEnds = 0;
+    for(int c = 0; c < maze.cellCount(); c++) {
+        if(maze.isWall(c)) continue;
+        open++;
+        deadEnds += __builtin_popcount(maze.legalMoves(c)) < 2;
+    }
+    std::vector<int32_t> dist, queue;
+    int reached = gridBfs(maze, maze.pacmanStart(), -1, dist, queue);
+    std::printf("%d celdas libres, %d callejones, %d alcanzables, %zu túneles\n",
+                open, deadEnds, reached, maze.tunnelRows().size());
+
+    double t3 = nowMs();
+    HpaPathfinder hpa(maze, clusterSize, parallel);
+    double t4 = nowMs();
+    std::printf("HPA* con cuadrados de %d: %d cuadrados, %d nodos, %lld aristas, %.1f ms\n",
+                clusterSize, hpa.clusterCount(), hpa.nodeCount(), hpa.edgeCount(), t4 - t3);
+
+    // Consultas: pares lejanos al azar y pares cercanos (un fantasma
+    // persiguiendo a Pac-Man a pocas decenas de celdas). En los más
+    // grandes cada BFS de referencia tarda décimas de segundo.
+    const int queries = maze.cellCount() > (1 << 22) ? 20 : 200;
+    const int radii[] = {0, 48};
+    uint32_t rng = streamSeed(seed, 0);
+    std::vector<int> cells;
+    bool ok = same && deadEnds == 0 && reached == open;
+    for(int radius : radii) {
+        double hpaMs = 0, stepMs = 0, bfsMs = 0, ratio = 0;
+        long long expanded = 0;
+        int found = 0;
+        for(int q = 0; q < queries; q++) {
+            int from = randomOpenCell(maze, rng);
+            int to = randomOpenCell(maze, rng);
+            while(radius > 0) {
+                // Alrededor de from, a no más de radius en cada eje
+                rng = xorshift32(rng);
+                int x = from % maze.width() + static_cast<int>(rng % (2 * radius + 1)) - radius;
+                int y = from / maze.width() + static_cast<int>((rng >> 16) % (2 * radius + 1)) - radius;
+                if(x < 0 || x >= maze.width() || y < 0 || y >= maze.height()) continue;
+                to = y * maze.width() + x;
+                if(!maze.isWall(to)) break;
+            }
+
+            double a = nowMs();
+            int approx = hpa.distance(from, to);
+            double b = nowMs();
+            expanded += hpa.lastExpanded();
+            int dir = hpa.firstStep(from, to);
+            double c = nowMs();
+            int exact = gridBfs(maze, from, to, dist, queue);
+            double d = nowMs();
+            hpaMs += b - a;
+            stepMs += c - b;
+            bfsMs += d - c;
+
+            // El camino refinado tiene que ser continuo y del largo dicho
+            bool valid = hpa.path(from, to, cells) && static_cast<int>(cells.size()) == approx + 1;
+            for(size_t k = 1; valid && k < cells.size(); k++) {
+                bool adjacent = false;
+                for(int dd = 0; dd < 4; dd++) adjacent |= maze.neighbour(cells[k - 1], dd) == cells[k];
+                valid = adjacent;
+            }
+            if(from != to) valid = valid && dir != DIR_NONE && maze.neighbour(from, dir) == cells[1];
+            ok = ok && valid && approx >= exact;
+            if(exact > 0) {
+                ratio += static_cast<double>(approx) / exact;
+                found++;
+            }
+        }
+        std::printf("%s: HPA* %8.1f us (%6.0f nodos)  primer paso %8.1f us  BFS %8.1f us  "
+                    "largo HPA*/óptimo %.3f\n",
+                    radius ? "cercanos" : "al azar ", hpaMs * 1000 / queries,
+                    static_cast<double>(expanded) / queries, stepMs * 1000 / queries,
+                    bfsMs * 1000 / queries, found ? ratio / found : 1.0);
+    }
+    std::printf("%s\n", ok ? "ok" : "ERROR");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+// Rollouts por segundo del piloto automático con 1, 2, ... hasta todos los
+// núcleos, para ver cómo escala el MCTS paralelo.
+#include "autopilot.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+    double budgetMs = argc > 1 ? std::atof(argv[1]) : 50.0;
+    int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    if(maxThreads <= 0) maxThreads = 1;
+
+    PacmanCore game;
+    game.reset(7);
+    for(int i = 0; i < 40; i++) game.step(DIR_NONE);
+
+    // 1, 2, 4... por debajo del máximo y después el máximo
+    std::vector<int> counts;
+    for(int threads = 1; threads < maxThreads; threads *= 2) counts.push_back(threads);
+    counts.push_back(maxThreads);
+
+    double base = 0.0;
+    std::printf("hilos  rollouts/s  aceleracion\n");
+    for(int threads : counts) {
+        Autopilot pilot(threads);
+        double total = 0.0;
+        const int decisions = 10;
+        for(int i = 0; i < decisions; i++) {
+            pilot.decide(game.state(), budgetMs);
+            total += pilot.rolloutsPerSecond();
+        }
+        double rate = total / decisions;
+        if(threads == 1) base = rate;
+        std::printf("%5d  %10.0f  %10.2fx\n", threads, rate, rate / base);
+    }
+    return 0;
+}
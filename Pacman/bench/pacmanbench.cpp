@@ -0,0 +1,274 @@
+// Benchmarks del juego con salida JSON, para comparar versiones:
+//  - micro: canMove, getNextPos, eatDot, checkCollisions, un step del
+//    núcleo y un tick completo de Game (simulación, publicación y GUI)
+//  - macro: partidas enteras sin ventana y pintado offscreen de Game
+//    (paintEvent completo y solo la región sucia) sobre un QImage
+//   pacman_bench [--out archivo.json] [--quick]
+#include "game.h"
+#include "rng.h"
+#include <QApplication>
+#include <QImage>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifndef PACMAN_VERSION
+#define PACMAN_VERSION "dev"
+#endif
+
+namespace {
+
+struct Result {
+    std::string name;
+    std::string per;    // qué es una operación: call, tick, game, frame
+    long long iterations;
+    double nsPerOp;
+};
+
+volatile long long sink;
+double minSeconds = 0.5;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Repite lotes de batch operaciones hasta llenar minSeconds
+Result timeLoop(const char *name, const char *per, long long batch,
+                const std::function<void()> &runBatch) {
+    runBatch(); // calentamiento
+    long long iterations = 0;
+    double start = nowNs();
+    double elapsed = 0.0;
+    while(elapsed < minSeconds * 1e9) {
+        runBatch();
+        iterations += batch;
+        elapsed = nowNs() - start;
+    }
+    return {name, per, iterations, elapsed / iterations};
+}
+
+}
+
+class PacmanBench {
+public:
+    static void eatDot(PacmanCore &core, int cell) { core.eatDot(cell); }
+    static void checkCollisions(PacmanCore &core) { core.checkCollisions(); }
+
+    // Un tick de simulación y el frame de GUI que lo recoge, sin hilo ni
+    // reloj (la ventana nunca se muestra, así que el hilo no arranca)
+    static void gameTick(Game &game) {
+        if(game.core.state().gameOver) game.resetSimulation();
+        game.simulateTick();
+        game.publishFrame();
+        game.renderFrame();
+    }
+
+    // Por la misma cola que el teclado
+    static void setInput(Game &game, int dir) {
+        game.commands.push({Game::CMD_DIRECTION, static_cast<int8_t>(dir), 0});
+        game.applyCommands(0);
+    }
+
+    // Región que pintaría el siguiente paintEvent tras un tick
+    static QRegion dirtyRegion(Game &game, const QRegion &changedCells) {
+        QRegion current = game.renderer.actorRegion();
+        QRegion dirty = game.lastActorRegion + current + game.renderer.hudRect() + changedCells;
+        game.lastActorRegion = current;
+        return dirty;
+    }
+
+    static QRegion stepGame(Game &game) {
+        if(game.core.state().gameOver) game.resetSimulation();
+        game.simulateTick();
+        game.publishFrame();
+        game.frames.acquire();
+        game.renderer.setFrame(&game.frames.front(), game.renderer.alpha());
+        return game.renderer.syncDotLayer();
+    }
+};
+
+namespace {
+
+// Estados de partidas en marcha para que las medidas no vean siempre el
+// mismo tick
+std::vector<GameState> sampleStates(int count) {
+    PacmanCore core;
+    core.reset(42);
+    uint32_t rng = 17;
+    int dir = DIR_LEFT;
+    std::vector<GameState> states;
+    while(static_cast<int>(states.size()) < count) {
+        dir = randomTurn(rng, dir);
+        core.step(dir);
+        if(core.state().tick % 7 == 0) states.push_back(core.state());
+        if(core.state().gameOver) core.reset(core.state().seed + 1);
+    }
+    return states;
+}
+
+void coreBenchmarks(std::vector<Result> &results) {
+    std::vector<GameState> states = sampleStates(1024);
+    PacmanCore core;
+    core.reset(42);
+
+    results.push_back(timeLoop("can_move", "call", 4096, [&]() {
+        long long acc = 0;
+        for(int i = 0; i < 4096; i++) {
+            const GameState &s = states[i & 1023];
+            acc += core.canMove(s.ghosts[i & 3].pos, i & 3);
+        }
+        sink = acc;
+    }));
+
+    results.push_back(timeLoop("get_next_pos", "call", 4096, [&]() {
+        double acc = 0.0;
+        for(int i = 0; i < 4096; i++) {
+            const GameState &s = states[i & 1023];
+            acc += core.getNextPos(s.pacmanPos, i & 3).x;
+        }
+        sink = static_cast<long long>(acc);
+    }));
+
+    // Cada lote recorre todas las celdas de un mapa lleno, así se comen
+    // puntos y power pellets además de consultar celdas vacías
+    GameState full = core.state();
+    results.push_back(timeLoop("eat_dot", "call", CELL_COUNT, [&]() {
+        core.state() = full;
+        for(int c = 0; c < CELL_COUNT; c++) PacmanBench::eatDot(core, c);
+        sink = core.state().score;
+    }));
+
+    // Solo se restauran las posiciones, que es lo que lee la comprobación
+    results.push_back(timeLoop("check_collisions", "call", 1024, [&]() {
+        long long acc = 0;
+        for(int i = 0; i < 1024; i++) {
+            GameState &s = core.state();
+            s.pacmanPos = states[i].pacmanPos;
+            for(int g = 0; g < NUM_GHOSTS; g++) s.ghosts[g] = states[i].ghosts[g];
+            s.lives = 3;
+            PacmanBench::checkCollisions(core);
+            acc += core.state().lives;
+        }
+        sink = acc;
+    }));
+
+    core.reset(42);
+    uint32_t rng = 5;
+    int dir = DIR_LEFT;
+    results.push_back(timeLoop("core_step", "tick", 1000, [&]() {
+        for(int i = 0; i < 1000; i++) {
+            if(core.state().gameOver) core.reset(core.state().seed + 1);
+            dir = randomTurn(rng, dir);
+            core.step(dir);
+        }
+        sink = core.state().tick;
+    }));
+
+    // Partidas completas sin ventana; se informa por partida y por tick
+    long long totalTicks = 0;
+    long long games = 0;
+    uint64_t seed = 1;
+    Result game = timeLoop("headless_game", "game", 1, [&]() {
+        core.reset(seed++);
+        while(!core.state().gameOver && core.state().tick < 20000) {
+            dir = randomTurn(rng, dir);
+            core.step(dir);
+        }
+        totalTicks += core.state().tick;
+        games++;
+    });
+    results.push_back(game);
+    double ticksPerGame = double(totalTicks) / games;
+    results.push_back({"headless_game_tick", "tick", static_cast<long long>(game.iterations * ticksPerGame),
+                       game.nsPerOp / ticksPerGame});
+}
+
+void guiBenchmarks(std::vector<Result> &results) {
+    Game game;
+    game.setSeed(42);
+    uint32_t rng = 9;
+    int dir = DIR_LEFT;
+
+    results.push_back(timeLoop("game_loop_tick", "tick", 100, [&]() {
+        for(int i = 0; i < 100; i++) {
+            dir = randomTurn(rng, dir);
+            PacmanBench::setInput(game, dir);
+            PacmanBench::gameTick(game);
+        }
+    }));
+
+    // Pintado offscreen: solo se cronometra render(), el tick va aparte
+    QImage image(game.size(), QImage::Format_ARGB32_Premultiplied);
+    const int frames = 200;
+    auto paintBench = [&](const char *name, bool dirtyOnly) {
+        game.setSeed(42);
+        long long count = 0;
+        double paintNs = 0.0;
+        double start = nowNs();
+        while(nowNs() - start < minSeconds * 1e9) {
+            for(int i = 0; i < frames; i++) {
+                dir = randomTurn(rng, dir);
+                PacmanBench::setInput(game, dir);
+                QRegion changed = PacmanBench::stepGame(game);
+                QRegion dirty = PacmanBench::dirtyRegion(game, changed);
+
+                double t0 = nowNs();
+                if(dirtyOnly) game.render(&image, QPoint(), dirty);
+                else game.render(&image);
+                paintNs += nowNs() - t0;
+            }
+            count += frames;
+        }
+        results.push_back({name, "frame", count, paintNs / count});
+    };
+    paintBench("paint_full", false);
+    paintBench("paint_dirty", true);
+}
+
+void writeJson(FILE *out, const std::vector<Result> &results) {
+    std::fprintf(out, "{\n  \"version\": \"%s\",\n", PACMAN_VERSION);
+#ifdef __VERSION__
+    std::fprintf(out, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    std::fprintf(out, "  \"results\": [\n");
+    for(size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"per\": \"%s\", \"iterations\": %lld, "
+                          "\"ns_per_op\": %.3f, \"ops_per_second\": %.1f}%s\n",
+                     r.name.c_str(), r.per.c_str(), r.iterations, r.nsPerOp,
+                     1e9 / r.nsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const char *outPath = nullptr;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) outPath = argv[++i];
+        else if(std::strcmp(argv[i], "--quick") == 0) minSeconds = 0.05;
+    }
+
+    // Sin pantalla: el pintado va a un QImage
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    unsetenv("SESSION_MANAGER");
+    QApplication app(argc, argv);
+
+    std::vector<Result> results;
+    coreBenchmarks(results);
+    guiBenchmarks(results);
+
+    FILE *out = outPath ? std::fopen(outPath, "w") : stdout;
+    if(!out) {
+        std::fprintf(stderr, "no se pudo escribir %s\n", outPath);
+        return 2;
+    }
+    writeJson(out, results);
+    if(outPath) std::fclose(out);
+    return 0;
+}
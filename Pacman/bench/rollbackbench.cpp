@@ -0,0 +1,93 @@
+// Costo de guardar y restaurar una instantánea del GameState y partida a
+// dos jugadores con rollback por un enlace en memoria con latencia,
+// variación y pérdida. Termina con error si los dos lados se desincronizan.
+//   rollback_bench [latencia] [variación] [pérdida%] [retraso]
+#include "rollback.h"
+#include "ghostai.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+volatile long long sink;
+
+// Fuera de línea para que el compilador no se salte la copia entera
+__attribute__((noinline)) void copyState(GameState &dst, const GameState &src) {
+    dst = src;
+}
+
+double snapshotNs(const GameState &state, bool restore) {
+    static GameState slots[64];
+    for(GameState &slot : slots) slot = state;
+    GameState live = state;
+    const int rounds = 2000000;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < rounds; i++) {
+        if(restore) copyState(live, slots[i & 63]);
+        else copyState(slots[i & 63], live);
+        live.tick += i;
+    }
+    sink = live.tick + slots[7].tick;
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start).count();
+    return ns / rounds;
+}
+
+void printStats(const char *name, const RollbackStats &st) {
+    std::printf("%-8s frames %lld  esperas %lld  rollbacks %lld  resimulados %lld  "
+                "max %d  retraso %d  llegada tarde media %.2f max %d  "
+                "hashes %lld  desincronizados %lld\n",
+                name, st.frames, st.stalls, st.rollbacks, st.resimulated, st.maxRollback,
+                st.inputDelay, st.lateTicks, st.maxLateTicks, st.syncChecks, st.desyncs);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int latency = argc > 1 ? std::atoi(argv[1]) : 3;
+    int jitter = argc > 2 ? std::atoi(argv[2]) : 2;
+    int loss = argc > 3 ? std::atoi(argv[3]) : 10;
+    int delay = argc > 4 ? std::atoi(argv[4]) : 2;
+
+    PacmanCore game;
+    game.reset(3);
+    std::printf("GameState: %zu bytes, guardar %.1f ns, restaurar %.1f ns\n",
+                sizeof(GameState), snapshotNs(game.state(), false), snapshotNs(game.state(), true));
+
+    LoopbackLink linkA, linkB;
+    LoopbackLink::connect(linkA, linkB);
+    linkA.setConditions(latency, jitter, loss, 1);
+    linkB.setConditions(latency, jitter, loss, 2);
+
+    const uint64_t seed = 11;
+    RollbackSession pacman(RollbackSession::PLAYER_PACMAN, BLINKY, seed, delay, &linkA);
+    RollbackSession ghost(RollbackSession::PLAYER_GHOST, BLINKY, seed, delay, &linkB);
+
+    uint32_t rngA = 5, rngB = 9;
+    int dirA = DIR_LEFT, dirB = DIR_LEFT;
+    const int frames = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for(int f = 0; f < frames; f++) {
+        linkA.advanceFrame();
+        linkB.advanceFrame();
+        dirA = randomTurn(rngA, dirA, 12);
+        dirB = randomTurn(rngB, dirB, 12);
+        pacman.advanceFrame(dirA);
+        ghost.advanceFrame(dirB);
+    }
+    double us = std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start).count();
+
+    std::printf("latencia %d variación %d pérdida %d%%: %.2f us por frame y lado, tick %lld, score %d\n",
+                latency, jitter, loss, us / (2.0 * frames),
+                static_cast<long long>(pacman.state().tick), pacman.state().score);
+    printStats("pacman", pacman.stats());
+    printStats("fantasma", ghost.stats());
+
+    bool ok = pacman.stats().desyncs == 0 && ghost.stats().desyncs == 0 &&
+              pacman.stats().syncChecks > 0 && ghost.stats().syncChecks > 0;
+    std::printf("%s\n", ok ? "sincronizados" : "DESINCRONIZADOS");
+    return ok ? 0 : 1;
+}
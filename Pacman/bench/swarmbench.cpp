@@ -0,0 +1,91 @@
+// Modo enjambre: costo por tick y por fase con distintas cantidades de
+// fantasmas en el mismo laberinto grande. La comprobación de Pac-Man con
+// el hash por celda se compara con recorrer todos los fantasmas con sqrt,
+// que es lo que hace PacmanCore::checkCollisions con sus cuatro.
+//   swarm_bench [copias_x] [copias_y] [ticks]
+#include "swarm.h"
+#include "rng.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+volatile long long sink;
+
+double nowNs() {
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Comprobación de fuerza bruta: todos los fantasmas, distancia con sqrt
+int bruteForceContacts(const Swarm &swarm) {
+    int contacts = 0;
+    for(int i = 0; i < swarm.size(); i++) {
+        double dx = swarm.pacmanX - swarm.ghostX[i];
+        double dy = swarm.pacmanY - swarm.ghostY[i];
+        contacts += std::sqrt(dx*dx + dy*dy) < Swarm::CONTACT_RADIUS;
+    }
+    return contacts;
+}
+
+void run(int tilesX, int tilesY, int ghosts, int ticks) {
+    Swarm swarm(tilesX, tilesY, ghosts, 7);
+    uint32_t rng = 3;
+    int dir = DIR_LEFT;
+    double movePac = 0, moveGhosts = 0, hash = 0, pacman = 0, pairs = 0, brute = 0;
+    long long mismatches = 0;
+
+    for(int t = 0; t < ticks; t++) {
+        dir = randomTurn(rng, dir);
+        swarm.nextDir = dir;
+        double t0 = nowNs();
+        swarm.movePacman();
+        double t1 = nowNs();
+        swarm.moveGhosts();
+        double t2 = nowNs();
+        swarm.buildHash();
+        double t3 = nowNs();
+        int hashed = swarm.checkPacman();
+        double t4 = nowNs();
+        int contacts = swarm.checkGhosts();
+        double t5 = nowNs();
+        int all = bruteForceContacts(swarm);
+        double t6 = nowNs();
+
+        movePac += t1 - t0;
+        moveGhosts += t2 - t1;
+        hash += t3 - t2;
+        pacman += t4 - t3;
+        pairs += t5 - t4;
+        brute += t6 - t5;
+        // Las dos comprobaciones ven los mismos contactos (el hash se hizo
+        // antes de los rebotes, que no mueven a nadie)
+        mismatches += hashed != all;
+        sink = contacts;
+    }
+
+    double total = (movePac + moveGhosts + hash + pacman + pairs) / ticks;
+    std::printf("%7d fantasmas: %9.1f us/tick (mover %7.1f  hash %7.1f  pacman %6.0f ns  "
+                "entre fantasmas %7.1f us)  fuerza bruta con sqrt %8.0f ns  %s\n",
+                ghosts, total / 1000.0, moveGhosts / ticks / 1000.0, hash / ticks / 1000.0,
+                pacman / ticks, pairs / ticks / 1000.0, brute / ticks,
+                mismatches ? "DISTINTOS" : "iguales");
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int tilesX = argc > 1 ? std::atoi(argv[1]) : 16;
+    int tilesY = argc > 2 ? std::atoi(argv[2]) : 16;
+    int ticks = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    Swarm probe(tilesX, tilesY, 0);
+    std::printf("laberinto %dx%d celdas (%dx%d copias)\n",
+                probe.width(), probe.height(), tilesX, tilesY);
+
+    const int counts[] = {1000, 10000, 30000, 100000};
+    for(int ghosts : counts) run(tilesX, tilesY, ghosts, ticks);
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Contacto a lo largo del tick contra la comprobación solo al final. Con
+// pares de actores que van uno hacia el otro por el mismo pasillo, a
+// varias velocidades por tick (lo que pasa al simular con ticks más
+// largos): cuántos contactos pierde mirar solo al final y cuántos pierde
+// sweptContact() contra una referencia que muestrea 256 puntos del tick.
+// Después juega partidas a esas velocidades y comprueba que ningún tick
+// sin choque tenga un contacto claro en su recorrido.
+//   sweep_bench [pares] [partidas]
+#include "pacmancore.h"
+#include "ghostai.h"
+#include "rng.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const int SAMPLES = 256;
+const int DIR_DX[4] = {1, 0, -1, 0};
+const int DIR_DY[4] = {0, 1, 0, -1};
+
+// Menor distancia al cuadrado entre los dos recorridos, muestreada
+long long sampledMin(Vec2 a0, Vec2 a1, Vec2 b0, Vec2 b1) {
+    long long best = -1;
+    for(int k = 0; k <= SAMPLES; k++) {
+        long long dx = (a0.x + static_cast<long long>(a1.x - a0.x) * k / SAMPLES) -
+                       (b0.x + static_cast<long long>(b1.x - b0.x) * k / SAMPLES);
+        long long dy = (a0.y + static_cast<long long>(a1.y - a0.y) * k / SAMPLES) -
+                       (b0.y + static_cast<long long>(b1.y - b0.y) * k / SAMPLES);
+        long long d = dx*dx + dy*dy;
+        if(best < 0 || d < best) best = d;
+    }
+    return best;
+}
+
+bool endTouching(Vec2 a, Vec2 b) {
+    long long dx = a.x - b.x, dy = a.y - b.y;
+    return dx*dx + dy*dy < static_cast<long long>(HALF_CELL) * HALF_CELL;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int pairs = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int games = argc > 2 ? std::atoi(argv[2]) : 200;
+    const int speeds[] = {PACMAN_SPEED, 2 * PACMAN_SPEED, 3 * PACMAN_SPEED, SUBCELL - 1};
+    const long long r2 = static_cast<long long>(HALF_CELL) * HALF_CELL;
+    bool ok = true;
+
+    std::printf("%-9s %10s %12s %14s %12s\n", "velocidad", "contactos", "solo al final",
+                "barrido pierde", "barrido de más");
+    uint32_t rng = 12345;
+    for(int speed : speeds) {
+        long long contacts = 0, endMissed = 0, sweptMissed = 0, sweptExtra = 0;
+        for(int p = 0; p < pairs; p++) {
+            // Pac-Man en un pasillo horizontal y el fantasma de frente, con
+            // un desvío lateral chico y una separación de hasta dos pasos
+            rng = xorshift32(rng);
+            int gap = static_cast<int>(rng % (4 * speed + SUBCELL)) - speed;
+            int side = static_cast<int>((rng >> 12) % (SUBCELL / 2)) - SUBCELL / 4;
+            int dir = (rng >> 28) & 1 ? DIR_RIGHT : DIR_DOWN;
+            Vec2 a0 = {10 * SUBCELL, 10 * SUBCELL};
+            Vec2 a1 = {a0.x + DIR_DX[dir] * speed, a0.y + DIR_DY[dir] * speed};
+            Vec2 b0 = {a0.x + DIR_DX[dir] * gap + DIR_DY[dir] * side,
+                       a0.y + DIR_DY[dir] * gap + DIR_DX[dir] * side};
+            Vec2 b1 = {b0.x - DIR_DX[dir] * speed, b0.y - DIR_DY[dir] * speed};
+
+            bool reference = sampledMin(a0, a1, b0, b1) < r2;
+            bool swept = PacmanCore::sweptContact(a0, a1, b0, b1);
+            contacts += reference;
+            endMissed += reference && !endTouching(a1, b1);
+            sweptMissed += reference && !swept;
+            sweptExtra += swept && !reference;
+        }
+        ok = ok && sweptMissed == 0;
+        std::printf("%5.3f     %10lld %12lld %14lld %12lld\n", static_cast<double>(speed) / SUBCELL, contacts,
+                    endMissed, sweptMissed, sweptExtra);
+    }
+
+    // Partidas: en un tick sin choque (mismas vidas, ningún fantasma de
+    // vuelta en la casa) nadie pudo pasar a menos de media celda menos un
+    // paso de otro en su recorrido
+    std::printf("\n%-9s %10s %12s %14s %12s\n", "velocidad", "ticks", "partidas/s", "choques",
+                "sin detectar");
+    for(int speed : speeds) {
+        PacmanCore core;
+        long long ticks = 0, hits = 0, missed = 0;
+        double slack = HALF_CELL - speed / 2.0;
+        auto start = std::chrono::steady_clock::now();
+        for(int g = 0; g < games; g++) {
+            core.reset(g + 1);
+            core.state().pacmanSpeed = speed;
+            uint32_t input = static_cast<uint32_t>(g) * 7 + 1;
+            int dir = DIR_LEFT;
+            while(!core.state().gameOver && core.state().tick < 20000) {
+                GameState before = core.state();
+                dir = randomTurn(input, dir);
+                core.step(dir);
+                const GameState &after = core.state();
+                ticks++;
+                bool event = after.lives != before.lives;
+                for(int i = 0; i < NUM_GHOSTS; i++) {
+                    const Vec2 &p = after.ghosts[i].pos;
+                    bool jumped = std::abs(p.x - before.ghosts[i].pos.x) > SUBCELL ||
+                                  std::abs(p.y - before.ghosts[i].pos.y) > SUBCELL;
+                    bool home = PacmanCore::cellOf(p) == GHOST_HOUSE_Y * GRID_WIDTH + GHOST_HOUSE_X;
+                    event = event || (jumped && home);
+                }
+                if(event) {
+                    hits++;
+                    continue;
+                }
+                if(after.level != before.level) continue;
+                for(int i = 0; i < NUM_GHOSTS; i++) {
+                    Vec2 b0 = before.ghosts[i].pos, b1 = after.ghosts[i].pos;
+                    Vec2 a0 = before.pacmanPos, a1 = after.pacmanPos;
+                    if(std::abs(b1.x - b0.x) > SUBCELL || std::abs(a1.x - a0.x) > SUBCELL) continue;
+                    missed += sampledMin(a0, a1, b0, b1) < static_cast<long long>(slack * slack);
+                }
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ok = ok && missed == 0;
+        std::printf("%5.3f     %10lld %12.1f %14lld %12lld\n", static_cast<double>(speed) / SUBCELL, ticks,
+                    games / seconds, hits, missed);
+    }
+    std::printf("%s\n", ok ? "ok" : "ERROR");
+    return ok ? 0 : 1;
+}
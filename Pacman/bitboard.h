@@ -0,0 +1,34 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "pacmandefs.h"
+#include <cstdint>
+
+// Un bit por celda del laberinto (celda = y * GRID_WIDTH + x)
+struct Bitboard {
+    static const int WORDS = (CELL_COUNT + 63) / 64;
+
+    uint64_t words[WORDS];
+
+    void clearAll() {
+        for(int w = 0; w < WORDS; w++) words[w] = 0;
+    }
+
+    bool test(int cell) const { return (words[cell >> 6] >> (cell & 63)) & 1; }
+    void set(int cell) { words[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void reset(int cell) { words[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+
+    int count() const {
+        int n = 0;
+        for(int w = 0; w < WORDS; w++) n += __builtin_popcountll(words[w]);
+        return n;
+    }
+
+    bool empty() const {
+        uint64_t any = 0;
+        for(int w = 0; w < WORDS; w++) any |= words[w];
+        return any == 0;
+    }
+};
+
+#endif // BITBOARD_H
@@ -0,0 +1,69 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+// Cámara de la vista, en celdas: una ventana de viewWidth x viewHeight
+// sobre un mapa de worldWidth x worldHeight que sigue a Pac-Man. El
+// objetivo puede moverse libremente por una zona central (la mitad de la
+// ventana) sin que la cámara se mueva, y la cámara nunca se sale del mapa;
+// si el mapa es más chico que la ventana queda quieta en el origen. Si el
+// objetivo aparece a más de media ventana fuera de ella (túnel, muerte) la
+// cámara se recentra de golpe.
+class Camera {
+public:
+    Camera() : worldW(0), worldH(0), viewW(0), viewH(0), x(0), y(0) {}
+
+    void setWorld(double width, double height) { worldW = width; worldH = height; clamp(); }
+    void setViewport(double width, double height) { viewW = width; viewH = height; clamp(); }
+
+    double left() const { return x; }
+    double top() const { return y; }
+    double viewWidth() const { return viewW; }
+    double viewHeight() const { return viewH; }
+
+    // Pone al objetivo en el centro
+    void centre(double targetX, double targetY) {
+        x = targetX - viewW / 2;
+        y = targetY - viewH / 2;
+        clamp();
+    }
+
+    // Pone la esquina superior izquierda en (left, top), sin salirse del mapa
+    void moveTo(double left, double top) {
+        x = left;
+        y = top;
+        clamp();
+    }
+
+    // Mueve lo justo para que el objetivo (en celdas) vuelva a la zona central
+    void follow(double targetX, double targetY) {
+        if(targetX < x - viewW / 2 || targetX > x + viewW * 1.5 ||
+           targetY < y - viewH / 2 || targetY > y + viewH * 1.5) {
+            centre(targetX, targetY);
+            return;
+        }
+        x = followAxis(x, targetX, viewW);
+        y = followAxis(y, targetY, viewH);
+        clamp();
+    }
+
+private:
+    double worldW, worldH;
+    double viewW, viewH;
+    double x, y;
+
+    static double followAxis(double origin, double target, double view) {
+        double low = origin + view / 4, high = origin + view * 3 / 4;
+        if(target < low) return target - view / 4;
+        if(target > high) return target - view * 3 / 4;
+        return origin;
+    }
+
+    void clamp() {
+        x = x > worldW - viewW ? worldW - viewW : x;
+        y = y > worldH - viewH ? worldH - viewH : y;
+        x = x < 0 ? 0 : x;
+        y = y < 0 ? 0 : y;
+    }
+};
+
+#endif // CAMERA_H
@@ -0,0 +1,60 @@
+#include "chunkedmaze.h"
+#include "mazegen.h"
+#include "pacmancore.h"
+#include <algorithm>
+#include <cmath>
+
+ChunkedMaze::ChunkedMaze() : w(0), h(0), cx(0), cy(0) {
+}
+
+ChunkedMaze::ChunkedMaze(int width, int height)
+    : w(width), h(height), cx((width + CHUNK - 1) >> CHUNK_SHIFT),
+    cy((height + CHUNK - 1) >> CHUNK_SHIFT),
+    cells(static_cast<size_t>(cx) * cy * CHUNK_CELLS, CELL_WALL) {
+}
+
+ChunkedMaze::ChunkedMaze(const ProceduralMaze &maze)
+    : ChunkedMaze(maze.width(), maze.height()) {
+    // Bloque a bloque, para escribir cada tramo de 1024 bytes seguido
+    const std::vector<uint8_t> &walls = maze.wallData();
+    for(int by = 0; by < cy; by++) {
+        for(int bx = 0; bx < cx; bx++) {
+            int x0 = bx * CHUNK, y0 = by * CHUNK;
+            int x1 = std::min(x0 + CHUNK, w), y1 = std::min(y0 + CHUNK, h);
+            for(int y = y0; y < y1; y++) {
+                uint8_t *row = &cells[offset(x0, y)];
+                const uint8_t *src = &walls[static_cast<size_t>(y) * w + x0];
+                for(int x = 0; x < x1 - x0; x++) row[x] = src[x] ? CELL_WALL : CELL_DOT;
+            }
+        }
+    }
+
+    for(int y = maze.houseY(); y < maze.houseY() + maze.houseHeight(); y++) {
+        for(int x = maze.houseX(); x < maze.houseX() + maze.houseWidth(); x++) set(x, y, CELL_EMPTY);
+    }
+    set(maze.doorCell() % w, maze.doorCell() / w, CELL_EMPTY);
+    set(maze.pacmanStart() % w, maze.pacmanStart() / w, CELL_EMPTY);
+    set(1, 1, CELL_POWER);
+    set(w - 2, 1, CELL_POWER);
+    set(1, h - 2, CELL_POWER);
+    set(w - 2, h - 2, CELL_POWER);
+}
+
+void ChunkedMaze::assign(const GameState &state) {
+    if(w != GRID_WIDTH || h != GRID_HEIGHT) *this = ChunkedMaze(GRID_WIDTH, GRID_HEIGHT);
+    for(int y = 0; y < h; y++) {
+        for(int x = 0; x < w; x++) set(x, y, static_cast<uint8_t>(state.cellAt(x, y)));
+    }
+}
+
+ChunkedMaze::ChunkRange ChunkedMaze::chunksIn(double x, double y, double width,
+                                               double height) const {
+    ChunkRange range;
+    range.x0 = std::max(0, static_cast<int>(std::floor(x)) >> CHUNK_SHIFT);
+    range.y0 = std::max(0, static_cast<int>(std::floor(y)) >> CHUNK_SHIFT);
+    range.x1 = std::min(cx, (static_cast<int>(std::ceil(x + width)) + CHUNK - 1) >> CHUNK_SHIFT);
+    range.y1 = std::min(cy, (static_cast<int>(std::ceil(y + height)) + CHUNK - 1) >> CHUNK_SHIFT);
+    range.x1 = std::max(range.x1, range.x0);
+    range.y1 = std::max(range.y1, range.y0);
+    return range;
+}
@@ -0,0 +1,70 @@
+#ifndef CHUNKEDMAZE_H
+#define CHUNKEDMAZE_H
+
+// Mapa de tamaño elegido en ejecución, guardado en bloques de CHUNK x CHUNK
+// celdas: las 1024 celdas de un bloque están seguidas en memoria, así que
+// dibujar o recorrer un rectángulo toca solo los bloques que lo cubren y
+// cada uno es un único tramo contiguo. Cada celda ocupa un byte (un valor
+// de Cell); el relleno hasta múltiplos de CHUNK queda como muro.
+// Un laberinto de 4095x4095 ocupa unos 16 MB.
+
+#include "pacmandefs.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ProceduralMaze;
+struct GameState;
+
+class ChunkedMaze {
+public:
+    static constexpr int CHUNK_SHIFT = 5;
+    static constexpr int CHUNK = 1 << CHUNK_SHIFT;
+    static constexpr int CHUNK_CELLS = CHUNK * CHUNK;
+
+    // Rango de bloques [x0, x1) x [y0, y1)
+    struct ChunkRange {
+        int x0, y0, x1, y1;
+        int count() const { return (x1 - x0) * (y1 - y0); }
+    };
+
+    ChunkedMaze();
+    // Todo muro
+    ChunkedMaze(int width, int height);
+    // Pasillos con puntos, una pastilla en cada esquina y vacíos la casa
+    // y la salida de Pac-Man
+    explicit ChunkedMaze(const ProceduralMaze &maze);
+
+    // Copia el mapa del tablero normal (muros, puntos y pastillas)
+    void assign(const GameState &state);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int chunksX() const { return cx; }
+    int chunksY() const { return cy; }
+    size_t memoryBytes() const { return cells.size(); }
+
+    uint8_t at(int x, int y) const { return cells[offset(x, y)]; }
+    void set(int x, int y, uint8_t cell) { cells[offset(x, y)] = cell; }
+
+    // Las CHUNK_CELLS celdas del bloque, fila a fila
+    const uint8_t *chunk(int chunkX, int chunkY) const {
+        return &cells[static_cast<size_t>(chunkY * cx + chunkX) * CHUNK_CELLS];
+    }
+
+    // Bloques que tocan el rectángulo de celdas [x, x + width) x
+    // [y, y + height), recortado al mapa
+    ChunkRange chunksIn(double x, double y, double width, double height) const;
+
+private:
+    int w, h;
+    int cx, cy;
+    std::vector<uint8_t> cells;
+
+    size_t offset(int x, int y) const {
+        size_t block = static_cast<size_t>((y >> CHUNK_SHIFT) * cx + (x >> CHUNK_SHIFT));
+        return block * CHUNK_CELLS + ((y & (CHUNK - 1)) << CHUNK_SHIFT) + (x & (CHUNK - 1));
+    }
+};
+
+#endif // CHUNKEDMAZE_H
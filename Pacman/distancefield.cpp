@@ -0,0 +1,159 @@
+#include "distancefield.h"
+#include <algorithm>
+
+DistanceField::DistanceField(const ProceduralMaze &maze, const std::vector<int> &sources)
+    : maze(maze), sourceCells(sources), touched(0) {
+    isSource.assign(maze.cellCount(), 0);
+    for(int cell : sources) isSource[cell] = 1;
+    marks.assign(maze.cellCount(), UNMARKED);
+    build();
+}
+
+void DistanceField::build() {
+    dist.assign(maze.cellCount(), UNREACHABLE);
+    queue.clear();
+    for(int cell : sourceCells) {
+        if(maze.isWall(cell) || dist[cell] == 0) continue;
+        dist[cell] = 0;
+        queue.push_back(cell);
+    }
+    spread(0);
+    touched = maze.cellCount();
+}
+
+void DistanceField::spread(size_t head) {
+    // BFS desde queue[head..]: baja las vecinas que quedan más cerca. Con
+    // una sola distancia de partida la cola sale ya en orden.
+    while(head < queue.size()) {
+        int cell = queue[head++];
+        int32_t next = dist[cell] + 1;
+        for(int d = 0; d < 4; d++) {
+            int n = maze.neighbour(cell, d);
+            if(n >= 0 && (dist[n] == UNREACHABLE || dist[n] > next)) {
+                dist[n] = next;
+                queue.push_back(n);
+            }
+        }
+    }
+}
+
+void DistanceField::wallChanged(int cell) {
+    if(maze.isWall(cell)) raise(cell);
+    else lower(cell);
+}
+
+void DistanceField::lower(int cell) {
+    // Solo puede acortar caminos: la mejor de las vecinas más uno y desde
+    // ahí hacia afuera
+    int32_t best = isSource[cell] ? 0 : UNREACHABLE;
+    for(int d = 0; d < 4; d++) {
+        int n = maze.neighbour(cell, d);
+        if(n < 0 || dist[n] == UNREACHABLE) continue;
+        if(best == UNREACHABLE || dist[n] + 1 < best) best = dist[n] + 1;
+    }
+    dist[cell] = best;
+    queue.clear();
+    touched = 1;
+    if(best == UNREACHABLE) return;
+    queue.push_back(cell);
+    spread(0);
+    touched = static_cast<long long>(queue.size());
+}
+
+void DistanceField::raise(int cell) {
+    const int32_t old = dist[cell];
+    dist[cell] = UNREACHABLE;
+    touched = 1;
+    if(old == UNREACHABLE) return;
+
+    // 1. Quiénes se quedan sin camino, por capas desde la celda: una
+    // candidata de la capa k se pierde si ninguna vecina de la capa k - 1
+    // la sostiene. Las de la capa k - 1 ya se decidieron todas porque la
+    // cola va en orden de capa.
+    affected.clear();
+    for(int d = 0; d < 4; d++) {
+        int n = maze.neighbour(cell, d);
+        if(n >= 0 && dist[n] == old + 1 && marks[n] == UNMARKED) {
+            marks[n] = CANDIDATE;
+            affected.push_back(n);
+        }
+    }
+    size_t lostCount = 0;
+    for(size_t head = 0; head < affected.size(); head++) {
+        int c = affected[head];
+        int32_t layer = dist[c];
+        bool supported = false;
+        for(int d = 0; d < 4 && !supported; d++) {
+            int m = maze.neighbour(c, d);
+            supported = m >= 0 && dist[m] == layer - 1 && marks[m] != LOST;
+        }
+        if(supported) continue;
+        marks[c] = LOST;
+        lostCount++;
+        for(int d = 0; d < 4; d++) {
+            int n = maze.neighbour(c, d);
+            if(n >= 0 && dist[n] == layer + 1 && marks[n] == UNMARKED) {
+                marks[n] = CANDIDATE;
+                affected.push_back(n);
+            }
+        }
+    }
+
+    // 2. Cada perdida toma la mejor de sus vecinas que siguen bien
+    if(lostCount > 0) {
+        for(int c : affected) {
+            if(marks[c] == LOST) dist[c] = UNREACHABLE;
+        }
+        seeds.clear();
+        for(int c : affected) {
+            if(marks[c] != LOST) continue;
+            int32_t best = UNREACHABLE;
+            for(int d = 0; d < 4; d++) {
+                int m = maze.neighbour(c, d);
+                if(m < 0 || marks[m] == LOST || dist[m] == UNREACHABLE) continue;
+                if(best == UNREACHABLE || dist[m] + 1 < best) best = dist[m] + 1;
+            }
+            if(best != UNREACHABLE) seeds.push_back({best, c});
+        }
+        std::sort(seeds.begin(), seeds.end());
+
+        // 3. BFS dentro de la zona perdida con semillas a distintas
+        // distancias: se saca siempre la menor entre la próxima semilla y
+        // el frente de la cola, que así sigue en orden
+        queue.clear();
+        size_t head = 0, next = 0;
+        while(next < seeds.size() || head < queue.size()) {
+            int c;
+            if(head == queue.size() || (next < seeds.size() && seeds[next].first <= dist[queue[head]])) {
+                c = seeds[next].second;
+                int32_t d = seeds[next++].first;
+                if(dist[c] != UNREACHABLE && dist[c] <= d) continue;
+                dist[c] = d;
+            } else {
+                c = queue[head++];
+            }
+            int32_t reach = dist[c] + 1;
+            for(int d = 0; d < 4; d++) {
+                int n = maze.neighbour(c, d);
+                if(n < 0 || marks[n] != LOST) continue;
+                if(dist[n] == UNREACHABLE || dist[n] > reach) {
+                    dist[n] = reach;
+                    queue.push_back(n);
+                }
+            }
+        }
+    }
+
+    for(int c : affected) marks[c] = UNMARKED;
+    touched = 1 + static_cast<long long>(affected.size());
+}
+
+int DistanceField::downhill(int cell) const {
+    int32_t here = dist[cell];
+    if(here <= 0) return DIR_NONE;
+    for(int d = 0; d < 4; d++) {
+        int n = maze.neighbour(cell, d);
+        if(n >= 0 && dist[n] == here - 1) return d;
+    }
+    return DIR_NONE;
+}
@@ -0,0 +1,69 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+// Campo de distancias sobre un ProceduralMaze: los pasos desde cada celda
+// hasta la fuente más cercana (la puerta de la casa para los fantasmas
+// comidos, la salida de Pac-Man...), con el túnel. Un fantasma lo sigue
+// cuesta abajo sin buscar nada: cada decisión son cuatro lecturas.
+//
+// Cuando una celda se abre o se cierra en plena partida el campo se
+// repara sin recorrer todo el laberinto:
+//  - al abrirse, la celda toma la mejor distancia de sus vecinos y un BFS
+//    desde ella baja solo las celdas que ahora quedan más cerca;
+//  - al cerrarse, primero se buscan por capas las celdas que se quedan
+//    sin camino (las que solo tenían padres en el árbol del BFS pasando
+//    por ella), después cada una toma la mejor distancia de sus vecinos
+//    que no la perdieron y un BFS desde esas semillas, en orden, vuelve a
+//    numerar solo esa zona. Las que no alcanza quedan inalcanzables.
+// El costo es el de la zona afectada, no el del laberinto.
+
+#include "mazegen.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class DistanceField {
+public:
+    static constexpr int32_t UNREACHABLE = -1;
+
+    // Las fuentes que sean muro no cuentan hasta que se abran
+    DistanceField(const ProceduralMaze &maze, const std::vector<int> &sources);
+
+    // Todo desde cero con un BFS desde las fuentes
+    void build();
+
+    // Después de maze.setWall(cell, ...): repara lo que cambió
+    void wallChanged(int cell);
+
+    int32_t distance(int cell) const { return dist[cell]; }
+    const std::vector<int32_t> &data() const { return dist; }
+
+    // Dirección hacia la fuente más cercana, o DIR_NONE (en una fuente o
+    // sin camino)
+    int downhill(int cell) const;
+
+    // Celdas que miró la última reparación (o todas tras build())
+    long long lastTouched() const { return touched; }
+
+private:
+    enum Mark : uint8_t { UNMARKED = 0, CANDIDATE = 1, LOST = 2 };
+
+    const ProceduralMaze &maze;
+    std::vector<int> sourceCells;
+    std::vector<uint8_t> isSource;
+    std::vector<int32_t> dist;
+    long long touched;
+
+    // Auxiliares de las reparaciones, reutilizados entre llamadas
+    std::vector<uint8_t> marks;
+    std::vector<int32_t> queue;
+    std::vector<int32_t> affected;
+    std::vector<std::pair<int32_t, int32_t>> seeds; // (distancia, celda)
+
+    void lower(int cell);
+    void raise(int cell);
+    void spread(size_t head);
+};
+
+#endif // DISTANCEFIELD_H
@@ -0,0 +1,27 @@
+// Servidor del entorno para entrenamiento, sin ventana:
+//   pacman_env [partidas] [socket] [memoria compartida] [semilla]
+#include "envserver.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char *argv[]) {
+    int envs = argc > 1 ? std::atoi(argv[1]) : 64;
+    const char *socketPath = argc > 2 ? argv[2] : "/tmp/pacman-env.sock";
+    const char *shmName = argc > 3 ? argv[3] : "/pacman-env";
+    uint64_t seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1;
+    if(envs < 1) {
+        std::fprintf(stderr, "cantidad de partidas inválida\n");
+        return 1;
+    }
+
+    EnvServer server(envs, seed);
+    if(!server.open(socketPath, shmName)) {
+        std::fprintf(stderr, "no se pudo abrir %s o %s\n", socketPath, shmName);
+        return 1;
+    }
+    std::printf("%d partidas en %s (%zu bytes por partida), órdenes en %s\n", envs, shmName,
+                sizeof(EnvObservation), socketPath);
+    std::fflush(stdout);
+    server.serve();
+    return 0;
+}
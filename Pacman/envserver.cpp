@@ -0,0 +1,271 @@
+#include "envserver.h"
+#include "pacmancore.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+static_assert(sizeof(EnvObservation) % 64 == 0, "observaciones alineadas a línea de caché");
+
+bool unixAddress(const char *path, sockaddr_un &address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(std::strlen(path) >= sizeof(address.sun_path)) return false;
+    std::strcpy(address.sun_path, path);
+    return true;
+}
+
+}
+
+EnvServer::EnvServer(int envCount, uint64_t seed)
+    : batch(envCount, seed), listenFd(-1), mapping(nullptr), mappedBytes(0), header(nullptr),
+    observations(nullptr) {
+    GameState initial;
+    PacmanCore::loadLevelMap(initial);
+    for(int c = 0; c < CELL_COUNT; c++) {
+        bareMap[c] = initial.walls.test(c) ? CELL_WALL : CELL_EMPTY;
+    }
+    for(int w = 0; w < PacmanBatch::MASK_WORDS; w++) powerMask[w] = initial.powers.words[w];
+    shownDots.resize(static_cast<size_t>(envCount) * PacmanBatch::MASK_WORDS);
+    buffer.resize(sizeof(EnvRequest) + static_cast<size_t>(envCount) * sizeof(EnvReset));
+}
+
+EnvServer::~EnvServer() {
+    close();
+}
+
+void EnvServer::close() {
+    if(listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(socketName.c_str());
+        listenFd = -1;
+    }
+    if(mapping) {
+        ::munmap(mapping, mappedBytes);
+        ::shm_unlink(shmName.c_str());
+        mapping = nullptr;
+        header = nullptr;
+        observations = nullptr;
+    }
+}
+
+bool EnvServer::open(const char *socketPath, const char *name) {
+    close();
+    socketName = socketPath;
+    shmName = name;
+
+    mappedBytes = sizeof(EnvHeader) + static_cast<size_t>(batch.size()) * sizeof(EnvObservation);
+    ::shm_unlink(name);
+    int shm = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(shm < 0) return false;
+    bool sized = ::ftruncate(shm, static_cast<off_t>(mappedBytes)) == 0;
+    void *p = sized ? ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0)
+                    : MAP_FAILED;
+    ::close(shm);
+    if(p == MAP_FAILED) {
+        ::shm_unlink(name);
+        return false;
+    }
+    mapping = p;
+    header = static_cast<EnvHeader *>(p);
+    observations = reinterpret_cast<EnvObservation *>(static_cast<uint8_t *>(p) + sizeof(EnvHeader));
+
+    *header = EnvHeader();
+    header->magic = ENV_MAGIC;
+    header->version = ENV_VERSION;
+    header->envCount = static_cast<uint32_t>(batch.size());
+    header->envBytes = sizeof(EnvObservation);
+    header->gridWidth = GRID_WIDTH;
+    header->gridHeight = GRID_HEIGHT;
+    header->numGhosts = NUM_GHOSTS;
+    header->subcell = SUBCELL;
+    for(int i = 0; i < batch.size(); i++) {
+        observations[i] = EnvObservation();
+        publish(i, true);
+    }
+
+    sockaddr_un address;
+    if(!unixAddress(socketPath, address)) return false;
+    ::unlink(socketPath);
+    listenFd = ::socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if(listenFd < 0) return false;
+    return ::bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0 &&
+           ::listen(listenFd, 4) == 0;
+}
+
+void EnvServer::serve() {
+    while(listenFd >= 0) {
+        int client = ::accept(listenFd, nullptr, nullptr);
+        if(client < 0) continue;
+        bool more = serveClient(client);
+        ::close(client);
+        if(!more) break;
+    }
+}
+
+bool EnvServer::serveClient(int fd) {
+    for(;;) {
+        ssize_t n = ::recv(fd, buffer.data(), buffer.size(), 0);
+        if(n <= 0) return true; // el entrenador se fue: esperar al siguiente
+        EnvReply reply = handle(buffer.data(), static_cast<size_t>(n));
+        bool shutdown = reply.status == 0 &&
+                        reinterpret_cast<const EnvRequest *>(buffer.data())->command == ENV_SHUTDOWN;
+        if(::send(fd, &reply, sizeof(reply), MSG_NOSIGNAL) != sizeof(reply)) return true;
+        if(shutdown) return false;
+    }
+}
+
+EnvReply EnvServer::handle(const uint8_t *message, size_t size) {
+    EnvReply reply = {-1, 0, header ? header->steps : 0};
+    if(!header || size < sizeof(EnvRequest)) return reply;
+    EnvRequest request;
+    std::memcpy(&request, message, sizeof(request));
+    const uint8_t *payload = message + sizeof(request);
+    size_t bytes = size - sizeof(request);
+    const int n = batch.size();
+
+    if(request.command == ENV_STEP) {
+        if(request.count != static_cast<uint32_t>(n) || bytes != static_cast<size_t>(n)) return reply;
+        const int8_t *actions = reinterpret_cast<const int8_t *>(payload);
+        for(int i = 0; i < n; i++) {
+            if(actions[i] < DIR_NONE || actions[i] > DIR_UP) return reply;
+        }
+        batch.step_all(actions);
+        for(int i = 0; i < n; i++) publish(i, false);
+        header->steps++;
+    } else if(request.command == ENV_RESET) {
+        if(bytes != request.count * sizeof(EnvReset)) return reply;
+        for(uint32_t k = 0; k < request.count; k++) {
+            EnvReset r;
+            std::memcpy(&r, payload + k * sizeof(EnvReset), sizeof(r));
+            if(r.env >= static_cast<uint32_t>(n)) return reply;
+        }
+        for(uint32_t k = 0; k < request.count; k++) {
+            EnvReset r;
+            std::memcpy(&r, payload + k * sizeof(EnvReset), sizeof(r));
+            batch.reset(static_cast<int>(r.env), r.seed);
+            observations[r.env].score = 0;
+            publish(static_cast<int>(r.env), true);
+        }
+    } else if(request.command != ENV_SHUTDOWN || request.count != 0 || bytes != 0) {
+        return reply;
+    }
+    reply.status = 0;
+    reply.steps = header->steps;
+    return reply;
+}
+
+void EnvServer::publish(int env, bool wholeMap) {
+    EnvObservation &o = observations[env];
+    const int n = batch.size();
+    o.pacmanX = batch.pacmanX[env];
+    o.pacmanY = batch.pacmanY[env];
+    o.pacmanDir = batch.pacmanDir[env];
+    for(int g = 0; g < NUM_GHOSTS; g++) {
+        int k = g * n + env;
+        o.ghostX[g] = batch.ghostX[k];
+        o.ghostY[g] = batch.ghostY[k];
+        o.ghostDir[g] = batch.ghostDir[k];
+        o.ghostScared[g] = batch.ghostScared[k];
+    }
+    o.reward = batch.score[env] - o.score;
+    o.score = batch.score[env];
+    o.lives = batch.lives[env];
+    o.frightenedTimer = batch.frightenedTimer[env];
+    o.level = batch.level[env];
+    o.done = batch.gameOver[env];
+    o.tick = batch.ticks[env];
+
+    // Del mapa solo cambian los puntos: se reescriben las celdas cuyo bit
+    // cambió desde la última vez (casi siempre ninguna o una)
+    const uint64_t *now = &batch.dots[static_cast<size_t>(env) * PacmanBatch::MASK_WORDS];
+    uint64_t *shown = &shownDots[static_cast<size_t>(env) * PacmanBatch::MASK_WORDS];
+    if(wholeMap) {
+        std::memcpy(o.map, bareMap, sizeof(bareMap));
+        for(int w = 0; w < PacmanBatch::MASK_WORDS; w++) shown[w] = 0;
+    }
+    for(int w = 0; w < PacmanBatch::MASK_WORDS; w++) {
+        uint64_t changed = now[w] ^ shown[w];
+        while(changed) {
+            int bit = __builtin_ctzll(changed);
+            changed &= changed - 1;
+            int cell = w * 64 + bit;
+            uint64_t mask = uint64_t(1) << bit;
+            o.map[cell] = !(now[w] & mask) ? CELL_EMPTY : (powerMask[w] & mask) ? CELL_POWER : CELL_DOT;
+        }
+        shown[w] = now[w];
+    }
+}
+
+EnvClient::EnvClient()
+    : fd(-1), mapping(nullptr), mappedBytes(0), header(nullptr), observations(nullptr) {}
+
+EnvClient::~EnvClient() {
+    if(fd >= 0) ::close(fd);
+    if(mapping) ::munmap(mapping, mappedBytes);
+}
+
+bool EnvClient::connect(const char *socketPath, const char *shmName) {
+    int shm = ::shm_open(shmName, O_RDONLY, 0);
+    if(shm < 0) return false;
+    struct stat info;
+    void *p = MAP_FAILED;
+    if(::fstat(shm, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(EnvHeader)) {
+        mappedBytes = static_cast<size_t>(info.st_size);
+        p = ::mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, shm, 0);
+    }
+    ::close(shm);
+    if(p == MAP_FAILED) return false;
+    mapping = p;
+    header = static_cast<const EnvHeader *>(p);
+    observations = reinterpret_cast<const EnvObservation *>(static_cast<const uint8_t *>(p) +
+                                                            sizeof(EnvHeader));
+    if(header->magic != ENV_MAGIC || header->version != ENV_VERSION ||
+       header->envBytes != sizeof(EnvObservation) ||
+       mappedBytes < sizeof(EnvHeader) + header->envCount * sizeof(EnvObservation)) {
+        return false;
+    }
+
+    sockaddr_un address;
+    if(!unixAddress(socketPath, address)) return false;
+    fd = ::socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    return fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+}
+
+bool EnvClient::request(uint32_t command, const void *payload, uint32_t count, size_t bytes) {
+    if(fd < 0) return false;
+    // Cabecera y elementos van en un solo mensaje sin copiarlos a un buffer
+    EnvRequest head = {command, count};
+    iovec parts[2] = {{&head, sizeof(head)}, {const_cast<void *>(payload), bytes}};
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = parts;
+    message.msg_iovlen = bytes ? 2 : 1;
+    if(::sendmsg(fd, &message, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(head) + bytes)) return false;
+    EnvReply reply;
+    return ::recv(fd, &reply, sizeof(reply), 0) == sizeof(reply) && reply.status == 0;
+}
+
+bool EnvClient::step(const int8_t *actions) {
+    return request(ENV_STEP, actions, static_cast<uint32_t>(size()), static_cast<size_t>(size()));
+}
+
+bool EnvClient::reset(const EnvReset *resets, int count) {
+    return request(ENV_RESET, resets, static_cast<uint32_t>(count), count * sizeof(EnvReset));
+}
+
+bool EnvClient::resetAll(uint64_t seed) {
+    allResets.resize(size());
+    for(int i = 0; i < size(); i++) allResets[i] = {static_cast<uint32_t>(i), 0, seed + i};
+    return reset(allResets.data(), size());
+}
+
+bool EnvClient::shutdown() {
+    return request(ENV_SHUTDOWN, nullptr, 0, 0);
+}
@@ -0,0 +1,154 @@
+#ifndef ENVSERVER_H
+#define ENVSERVER_H
+
+// Entorno sin ventana para entrenar agentes desde otro proceso del mismo
+// equipo. El servidor corre N partidas (PacmanBatch) y deja el estado de
+// cada una en memoria compartida; el entrenador la mapea y lee las
+// observaciones en su lugar, sin copias ni serialización. Por el socket
+// Unix solo van las órdenes (reset y step de varias partidas a la vez) y
+// una respuesta corta. El protocolo es síncrono: el servidor escribe las
+// observaciones antes de responder y no las toca hasta la orden siguiente,
+// así que lo que se lee entre respuesta y orden nunca está a medias.
+//
+// Segmento (todo en el orden de bytes de la máquina):
+//   EnvHeader, alineado a 64 bytes
+//   envCount x EnvObservation, de envBytes bytes cada una
+// Con numpy basta un dtype con los mismos campos y desplazamientos.
+
+#include "batchcore.h"
+#include "pacmandefs.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint32_t ENV_MAGIC = 0x564d4550; // "PEMV"
+const uint32_t ENV_VERSION = 1;
+
+struct alignas(64) EnvHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t envCount;
+    uint32_t envBytes; // sizeof(EnvObservation)
+    uint32_t gridWidth;
+    uint32_t gridHeight;
+    uint32_t numGhosts;
+    uint32_t subcell; // unidades de posición por celda
+    uint64_t steps;   // órdenes step atendidas
+};
+
+// Estado de una partida. Posiciones en unidades de SUBCELL como en el
+// núcleo; map tiene un valor de Cell por celda, fila a fila.
+struct alignas(64) EnvObservation {
+    int32_t pacmanX, pacmanY;
+    int32_t pacmanDir;
+    int32_t ghostX[NUM_GHOSTS], ghostY[NUM_GHOSTS];
+    int32_t ghostDir[NUM_GHOSTS];
+    int32_t score;
+    int32_t lives;
+    int32_t frightenedTimer;
+    int32_t level;
+    int32_t reward; // puntos ganados en el último step
+    uint8_t ghostScared[NUM_GHOSTS];
+    uint8_t done;   // partida terminada: los step no la mueven hasta un reset
+    uint8_t pad[3];
+    int64_t tick;
+    uint8_t map[CELL_COUNT];
+};
+
+// Órdenes. Cada mensaje es un EnvRequest seguido de count elementos:
+//   ENV_STEP: count == envCount direcciones int8_t (DIR_NONE conserva la anterior)
+//   ENV_RESET: count EnvReset, una por partida a reiniciar
+//   ENV_SHUTDOWN: nada; el servidor responde y termina
+enum EnvCommand { ENV_RESET = 1, ENV_STEP = 2, ENV_SHUTDOWN = 3 };
+
+struct EnvRequest {
+    uint32_t command;
+    uint32_t count;
+};
+
+struct EnvReset {
+    uint32_t env;
+    uint32_t pad;
+    uint64_t seed;
+};
+
+// status 0 si la orden se cumplió, -1 si el mensaje no era válido (y
+// entonces no se tocó ninguna partida)
+struct EnvReply {
+    int32_t status;
+    uint32_t pad;
+    uint64_t steps;
+};
+
+class EnvServer {
+public:
+    explicit EnvServer(int envCount, uint64_t seed = 1);
+    ~EnvServer();
+
+    // Crea el segmento (nombre de shm_open, con '/' inicial) y el socket
+    // (SOCK_SEQPACKET, un mensaje por orden). Los dos se reemplazan si ya
+    // existían y se borran al destruir el servidor.
+    bool open(const char *socketPath, const char *shmName);
+
+    // Atiende entrenadores de a uno hasta recibir ENV_SHUTDOWN
+    void serve();
+
+    // Cumple una orden ya recibida; la usa serve() y sirve para probar el
+    // protocolo sin socket
+    EnvReply handle(const uint8_t *message, size_t size);
+
+    int size() const { return batch.size(); }
+    const EnvObservation &observation(int env) const { return observations[env]; }
+
+private:
+    PacmanBatch batch;
+    std::string socketName, shmName;
+    int listenFd;
+    void *mapping;
+    size_t mappedBytes;
+    EnvHeader *header;
+    EnvObservation *observations;
+    std::vector<uint8_t> buffer;
+
+    // Mapa sin puntos (muros y vacío), pastillas del mapa inicial y los
+    // puntos que ya muestra cada observación, para copiar solo los cambios
+    uint8_t bareMap[CELL_COUNT];
+    uint64_t powerMask[PacmanBatch::MASK_WORDS];
+    std::vector<uint64_t> shownDots;
+
+    void close();
+    bool serveClient(int fd);
+    void publish(int env, bool wholeMap);
+};
+
+// Lado del entrenador, para clientes en C++ y para el benchmark
+class EnvClient {
+public:
+    EnvClient();
+    ~EnvClient();
+
+    bool connect(const char *socketPath, const char *shmName);
+
+    int size() const { return header ? static_cast<int>(header->envCount) : 0; }
+    const EnvObservation &observation(int env) const { return observations[env]; }
+    uint64_t steps() const { return header->steps; }
+
+    // actions tiene size() direcciones
+    bool step(const int8_t *actions);
+    bool reset(const EnvReset *resets, int count);
+    bool resetAll(uint64_t seed);
+    bool shutdown();
+
+private:
+    int fd;
+    void *mapping;
+    size_t mappedBytes;
+    const EnvHeader *header;
+    const EnvObservation *observations;
+    std::vector<EnvReset> allResets;
+
+    bool request(uint32_t command, const void *payload, uint32_t count, size_t bytes);
+};
+
+#endif // ENVSERVER_H
@@ -0,0 +1,43 @@
+#ifndef FIXEDCLOCK_H
+#define FIXEDCLOCK_H
+
+// Reloj de paso fijo: acumula el tiempo real medido y dice cuántos ticks
+// de simulación tocan, de modo que la velocidad del juego no depende de
+// la frecuencia ni del jitter del timer de dibujo.
+class FixedClock {
+public:
+    explicit FixedClock(int ticksPerSecond = 20, int maxSubsteps = 5)
+        : tickSeconds(1.0 / ticksPerSecond), accumulator(0.0),
+        maxSteps(maxSubsteps) {}
+
+    void setTickRate(int ticksPerSecond) { tickSeconds = 1.0 / ticksPerSecond; }
+    double tickLength() const { return tickSeconds; }
+
+    void reset() { accumulator = 0.0; }
+
+    // Suma elapsedSeconds y devuelve cuántos ticks hay que simular.
+    // Si la máquina se atrasa más de maxSubsteps ticks se descarta el
+    // resto para no entrar en una espiral de recuperación.
+    int advance(double elapsedSeconds) {
+        accumulator += elapsedSeconds;
+        int steps = 0;
+        while(accumulator >= tickSeconds && steps < maxSteps) {
+            accumulator -= tickSeconds;
+            steps++;
+        }
+        if(steps == maxSteps && accumulator >= tickSeconds) {
+            accumulator = 0.0;
+        }
+        return steps;
+    }
+
+    // Fracción del tick siguiente ya transcurrida (0..1), para interpolar
+    double alpha() const { return accumulator / tickSeconds; }
+
+private:
+    double tickSeconds;
+    double accumulator;
+    int maxSteps;
+};
+
+#endif // FIXEDCLOCK_H
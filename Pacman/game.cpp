@@ -1,264 +1,460 @@
 #include "game.h"
+#include "ghostai.h"
 #include <QApplication>
-#include <cmath>
+#include <QCloseEvent>
+#include <QShowEvent>
+#include <chrono>
 #include <ctime>
-#include <cstdlib>
 
-Game::Game(QWidget *parent) : QWidget(parent) {
-    setFixedSize(GRID_WIDTH * CELL_SIZE, GRID_HEIGHT * CELL_SIZE + 50);
+namespace {
+
+qint64 monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+Game::Game(QWidget *parent)
+    : QWidget(parent), simRunning(false), lateUs(0.0), inputPhase(0), lastInputNs(0),
+    lastAppliedNs(0), seenPublishedNs(0), clock(TICK_RATE), fixedSeed(0), recordingSaved(true),
+    autopilotOn(false), timeline(nullptr), seenInputNs(0), pendingInputNs(0),
+    showPaintStats(false), lastPaintNs(0), avgPaintNs(0.0) {
+    // La ventana muestra a lo sumo MAX_VIEW_COLUMNS x MAX_VIEW_ROWS celdas
+    renderer.setup(palette().color(QPalette::Window), devicePixelRatioF());
+    setFixedSize(renderer.width(), renderer.height());
     setWindowTitle("Pac-Man");
 
+    // Cada paintEvent repinta su región completa a partir de las capas
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
     timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &Game::gameLoop);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &Game::renderFrame);
 
-    srand(time(nullptr));
     initGame();
-    timer->start(50); // 20 FPS
+    setRenderRate(RENDER_RATE);
 }
 
-void Game::initGame() {
-    score = 0;
-    lives = 3;
-    gameOver = false;
-    frightenedTimer = 0;
-    mouthAngle = 0;
-
-    // Inicializar Pac-Man
-    pacmanPos = QPointF(9.5, 15.5);
-    pacmanDir = 0;
-    nextDir = 0;
-    pacmanSpeed = 0.15f;
-
-    // Inicializar fantasmas
-    ghosts.clear();
-    ghosts.append({QPointF(8.5, 9.5), 0, Qt::red, false});
-    ghosts.append({QPointF(9.5, 9.5), 0, Qt::cyan, false});
-    ghosts.append({QPointF(10.5, 9.5), 0, QColor(255, 184, 255), false});
-    ghosts.append({QPointF(11.5, 9.5), 0, QColor(255, 184, 82), false});
-
-    initMap();
-}
-
-void Game::initMap() {
-    // Mapa simplificado (1=muro, 2=punto, 3=power pellet)
-    int tempMap[GRID_HEIGHT][GRID_WIDTH] = {
-        {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
-        {1,2,2,2,2,2,2,2,2,1,2,2,2,2,2,2,2,2,1},
-        {1,3,1,1,2,1,1,1,2,1,2,1,1,1,2,1,1,3,1},
-        {1,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,1},
-        {1,2,1,1,2,1,2,1,1,1,1,1,2,1,2,1,1,2,1},
-        {1,2,2,2,2,1,2,2,2,1,2,2,2,1,2,2,2,2,1},
-        {1,1,1,1,2,1,1,1,0,1,0,1,1,1,2,1,1,1,1},
-        {1,1,1,1,2,1,0,0,0,0,0,0,0,1,2,1,1,1,1},
-        {1,1,1,1,2,1,0,1,1,0,1,1,0,1,2,1,1,1,1},
-        {0,0,0,0,2,0,0,1,0,0,0,1,0,0,2,0,0,0,0},
-        {1,1,1,1,2,1,0,1,1,1,1,1,0,1,2,1,1,1,1},
-        {1,1,1,1,2,1,0,0,0,0,0,0,0,1,2,1,1,1,1},
-        {1,1,1,1,2,1,0,1,1,1,1,1,0,1,2,1,1,1,1},
-        {1,2,2,2,2,2,2,2,2,1,2,2,2,2,2,2,2,2,1},
-        {1,2,1,1,2,1,1,1,2,1,2,1,1,1,2,1,1,2,1},
-        {1,3,2,1,2,2,2,2,2,2,2,2,2,2,2,1,2,3,1},
-        {1,1,2,1,2,1,2,1,1,1,1,1,2,1,2,1,2,1,1},
-        {1,2,2,2,2,1,2,2,2,1,2,2,2,1,2,2,2,2,1},
-        {1,2,1,1,1,1,1,1,2,1,2,1,1,1,1,1,1,2,1},
-        {1,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,1},
-        {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}
-    };
-
-    for(int i = 0; i < GRID_HEIGHT; i++) {
-        for(int j = 0; j < GRID_WIDTH; j++) {
-            map[i][j] = tempMap[i][j];
-        }
-    }
+Game::~Game() {
+    stopSimulation();
 }
 
-void Game::gameLoop() {
-    if(gameOver) return;
+void Game::setTickRate(int ticksPerSecond) {
+    bool running = stopSimulation();
+    clock.setTickRate(ticksPerSecond);
+    clock.reset();
+    if(running) startSimulation();
+}
 
-    movePacman();
-    moveGhosts();
-    checkCollisions();
+void Game::setRenderRate(int framesPerSecond) {
+    timer->start(1000 / framesPerSecond);
+}
 
-    if(frightenedTimer > 0) {
-        frightenedTimer--;
-        if(frightenedTimer == 0) {
-            for(auto &ghost : ghosts) {
-                ghost.scared = false;
-            }
-        }
+void Game::setSeed(uint64_t seed) {
+    fixedSeed = seed;
+    initGame();
+}
+
+void Game::startRecording(const QString &path) {
+    recordPath = path;
+    initGame();
+}
+
+void Game::startCapture(const QString &path) {
+    capturePath = path;
+    initGame();
+}
+
+bool Game::openReplay(const QString &path) {
+    if(!review.open(path.toStdString()) || review.frameCount() == 0) return false;
+
+    // Se deja de simular: el estado sale de la repetición
+    stopSimulation();
+    timer->stop();
+    capture.close();
+    capturePath.clear();
+
+    setFixedSize(width(), renderer.height() + 30);
+    timeline = new QSlider(Qt::Horizontal, this);
+    timeline->setGeometry(10, renderer.height(), width() - 20, 24);
+    timeline->setRange(0, static_cast<int>(review.frameCount()) - 1);
+    timeline->setFocusPolicy(Qt::NoFocus);
+    connect(timeline, &QSlider::valueChanged, this, &Game::showReplayFrame);
+    timeline->show();
+
+    renderer.buildMapLayers();
+    showReplayFrame(0);
+    return true;
+}
+
+void Game::startNetplay(std::unique_ptr<NetLink> link, int localPlayer, int inputDelay) {
+    bool running = stopSimulation();
+    netLink = std::move(link);
+    beginSession(netLink.get(), localPlayer, inputDelay);
+    if(running) startSimulation();
+}
+
+void Game::startLoopback(int latencyFrames, int inputDelay) {
+    bool running = stopSimulation();
+    LoopbackLink::connect(loopback[0], loopback[1]);
+    loopback[0].setConditions(latencyFrames, 0, 0, 1);
+    loopback[1].setConditions(latencyFrames, 0, 0, 2);
+    beginSession(&loopback[0], RollbackSession::PLAYER_PACMAN, inputDelay);
+    peer.reset(new RollbackSession(RollbackSession::PLAYER_GHOST, BLINKY,
+                                   session->state().seed, inputDelay, &loopback[1]));
+    if(running) startSimulation();
+}
+
+void Game::beginSession(NetLink *link, int localPlayer, int inputDelay) {
+    // La semilla tiene que ser la misma en los dos lados: sin --seed, 1
+    uint64_t seed = fixedSeed ? fixedSeed : 1;
+    session.reset(new RollbackSession(localPlayer, BLINKY, seed, inputDelay, link));
+
+    // Las grabaciones son de un solo jugador
+    recordPath.clear();
+    recordingSaved = true;
+
+    core.state() = session->state();
+    nextDir = localPlayer == RollbackSession::PLAYER_PACMAN ? core.state().nextDir : DIR_NONE;
+    clock.reset();
+    savePreviousPositions();
+    publishFrame();
+    renderFrame();
+}
+
+void Game::advanceNetFrame() {
+    if(peer) {
+        loopback[0].advanceFrame();
+        loopback[1].advanceFrame();
+        peer->advanceFrame(peerGhostInput());
     }
+    session->advanceFrame(nextDir);
+    core.state() = session->state();
+}
+
+int Game::peerGhostInput() const {
+    // El rival de prueba persigue a Pac-Man por el camino más corto
+    const GameState &s = peer->state();
+    const MazeDistances &maze = peer->simulation().distances();
+    const GhostState &ghost = s.ghosts[s.humanGhost];
+    int cell = PacmanCore::cellOf(ghost.pos);
+    int pacmanCell = PacmanCore::cellOf(s.pacmanPos);
+    if(!maze.walkable(cell) || !maze.walkable(pacmanCell)) return DIR_NONE;
+    return chooseGhostDirection(maze, cell, ghost.dir, pacmanCell);
+}
 
+void Game::showReplayFrame(int frame) {
+    GameState state;
+    if(!review.stateAt(frame, state)) return;
+    reviewFrame = Frame();
+    reviewFrame.state = state;
+    reviewFrame.prevPacmanPos = state.pacmanPos;
+    for(int i = 0; i < NUM_GHOSTS; i++) reviewFrame.prevGhostPos[i] = state.ghosts[i].pos;
+    renderer.setFrame(&reviewFrame, 1.0);
+    renderer.syncDotLayer();
+    renderer.followPacman();
+    renderer.dropHiddenChunks();
+    lastActorRegion = QRegion();
     update();
 }
 
-QPointF Game::getNextPos(QPointF pos, int dir) {
-    QPointF next = pos;
-    switch(dir) {
-    case 0: next.setX(next.x() + pacmanSpeed); break; // derecha
-    case 1: next.setY(next.y() + pacmanSpeed); break; // abajo
-    case 2: next.setX(next.x() - pacmanSpeed); break; // izquierda
-    case 3: next.setY(next.y() - pacmanSpeed); break; // arriba
-    }
+void Game::saveRecording() {
+    if(recordPath.isEmpty() || recordingSaved) return;
+    recording.finish(core.state());
+    recording.save(recordPath.toStdString());
+    recordingSaved = true;
+}
 
-    // Túnel (wrap around)
-    if(next.x() < 0) next.setX(GRID_WIDTH - 0.5f);
-    if(next.x() >= GRID_WIDTH) next.setX(0.5f);
+void Game::initGame() {
+    bool running = stopSimulation();
+    resetSimulation();
+    frames.acquire();
+    renderer.setFrame(&frames.front(), renderer.alpha());
+    renderer.buildMapLayers();
+    update();
+    if(running) startSimulation();
+}
 
-    return next;
+void Game::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    if(!timeline) startSimulation();
 }
 
-bool Game::canMove(QPointF pos, int dir) {
-    QPointF next = getNextPos(pos, dir);
-    int x = static_cast<int>(next.x());
-    int y = static_cast<int>(next.y());
+void Game::startSimulation() {
+    if(simThread.joinable()) return;
+    simRunning = true;
+    simThread = std::thread(&Game::simulationLoop, this);
+}
 
-    if(y < 0 || y >= GRID_HEIGHT || x < 0 || x >= GRID_WIDTH) return false;
-    return map[y][x] != 1;
+bool Game::stopSimulation() {
+    if(!simThread.joinable()) return false;
+    simRunning = false;
+    simThread.join();
+    return true;
 }
 
-void Game::movePacman() {
-    // Intentar cambiar dirección
-    if(nextDir != pacmanDir && canMove(pacmanPos, nextDir)) {
-        pacmanDir = nextDir;
+void Game::simulationLoop() {
+    using namespace std::chrono;
+    clock.reset();
+    steady_clock::time_point last = steady_clock::now();
+    while(simRunning) {
+        // Dormir hasta el siguiente límite de tick
+        double wait = clock.tickLength() * (1.0 - clock.alpha());
+        std::this_thread::sleep_for(duration<double>(wait));
+
+        steady_clock::time_point now = steady_clock::now();
+        double elapsed = duration<double>(now - last).count();
+        last = now;
+
+        int steps = clock.advance(elapsed);
+        if(steps == 0) continue;
+
+        // Comienzo del primer tick que toca simular: las teclas se sitúan
+        // dentro de él
+        double period = clock.tickLength() * 1e9;
+        qint64 nowNs = duration_cast<nanoseconds>(now.time_since_epoch()).count();
+        applyCommands(nowNs - static_cast<qint64>((clock.alpha() + steps) * period));
+
+        // Lo que queda en el acumulador es cuánto tarde nos despertamos
+        double late = clock.alpha() * clock.tickLength() * 1e6;
+        lateUs = lateUs == 0.0 ? late : lateUs * 0.95 + late * 0.05;
+
+        for(int i = 0; i < steps; i++) simulateTick();
+        publishFrame();
     }
+}
 
-    // Mover en la dirección actual
-    if(canMove(pacmanPos, pacmanDir)) {
-        pacmanPos = getNextPos(pacmanPos, pacmanDir);
-        mouthAngle = (mouthAngle + 5) % 60;
+void Game::applyCommands(qint64 tickStartNs) {
+    Command cmd;
+    while(commands.pop(cmd)) {
+        switch(cmd.type) {
+        case CMD_DIRECTION:
+            if(cmd.dir != nextDir) {
+                // El giro se aplica en el momento del tick en que llegó
+                double phase = (cmd.timeNs - tickStartNs) / (clock.tickLength() * 1e9);
+                phase = phase < 0.0 ? 0.0 : (phase > 255.0 / 256 ? 255.0 / 256 : phase);
+                inputPhase = static_cast<uint8_t>(phase * 256);
+                lastInputNs = cmd.timeNs;
+                lastAppliedNs = -1; // se pone al simular el tick
+            }
+            nextDir = cmd.dir;
+            break;
+        case CMD_RESTART:
+            if(core.state().gameOver && !session) resetSimulation();
+            break;
+        case CMD_AUTOPILOT:
+            // El piloto solo sabe llevar a Pac-Man
+            if(session && session->localPlayer() != RollbackSession::PLAYER_PACMAN) break;
+            if(!autopilot) autopilot.reset(new Autopilot);
+            autopilotOn = !autopilotOn;
+            break;
+        }
     }
+}
 
-    // Comer puntos
-    int x = static_cast<int>(pacmanPos.x());
-    int y = static_cast<int>(pacmanPos.y());
-    if(x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT) {
-        eatDot(x, y);
+void Game::resetSimulation() {
+    uint64_t seed = fixedSeed ? fixedSeed : static_cast<uint64_t>(time(nullptr));
+    core.reset(seed);
+    nextDir = core.state().nextDir;
+    const GameState &start = core.state();
+    recording.begin(seed, nextDir, {start.pacmanSpeed, start.frightenedTicks, start.ghostWander});
+    recordingSaved = recordPath.isEmpty();
+    if(!capturePath.isEmpty()) {
+        capture.open(capturePath.toStdString());
+        capture.append(core.state());
     }
+    clock.reset();
+    savePreviousPositions();
+    publishFrame();
 }
 
-void Game::eatDot(int x, int y) {
-    if(map[y][x] == 2) {
-        map[y][x] = 0;
-        score += 10;
-    } else if(map[y][x] == 3) {
-        map[y][x] = 0;
-        score += 50;
-        frightenedTimer = 100;
-        for(auto &ghost : ghosts) {
-            ghost.scared = true;
-        }
+void Game::simulateTick() {
+    // En red se sigue enviando aunque acabe: una entrada tardía del otro
+    // puede deshacer el final
+    if(core.state().gameOver && !session) return;
+
+    savePreviousPositions();
+    uint8_t phase = inputPhase;
+    inputPhase = 0;
+    // El piloto elige igual que el teclado: escribiendo nextDir
+    if(autopilotOn) {
+        nextDir = autopilot->decide(core.state(), AUTOPILOT_BUDGET_MS);
+        phase = 0;
     }
-}
+    if(session) {
+        // En red el giro va al principio del tick: la fase no viaja
+        advanceNetFrame();
+    } else {
+        recording.record(core.state().tick, nextDir, phase);
+        core.step(nextDir, DIR_NONE, phase);
+    }
+    if(lastAppliedNs < 0) lastAppliedNs = monotonicNs();
+    capture.append(core.state());
 
-void Game::moveGhosts() {
-    for(auto &ghost : ghosts) {
-        // IA simple: movimiento aleatorio
-        if(rand() % 20 == 0) {
-            ghost.dir = rand() % 4;
-        }
+    if(core.state().gameOver) {
+        saveRecording();
+        capture.close();
+    }
+}
 
-        if(canMove(ghost.pos, ghost.dir)) {
-            ghost.pos = getNextPos(ghost.pos, ghost.dir);
-        } else {
-            ghost.dir = rand() % 4;
-        }
+void Game::publishFrame() {
+    Frame &f = frames.back();
+    f.state = core.state();
+    f.prevPacmanPos = prevPacmanPos;
+    for(int i = 0; i < NUM_GHOSTS; i++) f.prevGhostPos[i] = prevGhostPos[i];
+    f.tickSeconds = clock.tickLength();
+    f.tickNs = monotonicNs() - static_cast<qint64>(clock.alpha() * clock.tickLength() * 1e9);
+    f.inputNs = lastInputNs;
+    f.appliedNs = lastAppliedNs;
+    f.lateUs = lateUs;
+    f.autopilotOn = autopilotOn;
+    f.autopilotRate = autopilot ? autopilot->rolloutsPerSecond() : 0.0;
+    f.autopilotThreads = autopilot ? autopilot->threadCount() : 0;
+    f.netplay = session != nullptr;
+    f.net = session ? session->stats() : RollbackStats();
+    bool newInput = f.inputNs != 0 && f.inputNs != seenPublishedNs;
+    seenPublishedNs = f.inputNs;
+    frames.publish();
+
+    // Un giro nuevo se pinta ya, sin esperar al timer de dibujo
+    if(newInput && simThread.joinable()) {
+        QMetaObject::invokeMethod(this, &Game::renderFrame, Qt::QueuedConnection);
     }
 }
 
-void Game::checkCollisions() {
-    for(const auto &ghost : ghosts) {
-        float dx = pacmanPos.x() - ghost.pos.x();
-        float dy = pacmanPos.y() - ghost.pos.y();
-        float dist = sqrt(dx*dx + dy*dy);
-
-        if(dist < 0.5f) {
-            if(ghost.scared) {
-                score += 200;
-            } else {
-                lives--;
-                if(lives <= 0) {
-                    gameOver = true;
-                } else {
-                    pacmanPos = QPointF(9.5, 15.5);
-                }
-            }
-        }
+void Game::savePreviousPositions() {
+    const GameState &s = core.state();
+    prevPacmanPos = s.pacmanPos;
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        prevGhostPos[i] = s.ghosts[i].pos;
     }
 }
 
-void Game::paintEvent(QPaintEvent *) {
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    drawMap(painter);
-    drawPacman(painter);
-    drawGhosts(painter);
-    drawUI(painter);
-}
-
-void Game::drawMap(QPainter &painter) {
-    for(int y = 0; y < GRID_HEIGHT; y++) {
-        for(int x = 0; x < GRID_WIDTH; x++) {
-            if(map[y][x] == 1) {
-                painter.fillRect(x * CELL_SIZE, y * CELL_SIZE,
-                                 CELL_SIZE, CELL_SIZE, Qt::blue);
-            } else if(map[y][x] == 2) {
-                painter.setBrush(QColor(255, 255, 200));
-                painter.drawEllipse(x * CELL_SIZE + CELL_SIZE/2 - 2,
-                                    y * CELL_SIZE + CELL_SIZE/2 - 2, 4, 4);
-            } else if(map[y][x] == 3) {
-                painter.setBrush(Qt::white);
-                painter.drawEllipse(x * CELL_SIZE + CELL_SIZE/2 - 5,
-                                    y * CELL_SIZE + CELL_SIZE/2 - 5, 10, 10);
-            }
+void Game::renderFrame() {
+    // Lado de la GUI: recoge el último tick publicado (si hay uno nuevo)
+    // y pide repintar donde cambió
+    QRegion changed;
+    if(frames.acquire()) {
+        const Frame &f = frames.front();
+        renderer.setFrame(&f, renderer.alpha());
+        changed = renderer.syncDotLayer();
+        if(f.inputNs != seenInputNs && f.appliedNs > 0) {
+            seenInputNs = f.inputNs;
+            pendingInputNs = f.inputNs;
+            inputToTick.add(f.appliedNs - f.inputNs);
         }
     }
+
+    const Frame &view = renderer.frame();
+    double alpha = (monotonicNs() - view.tickNs) / (view.tickSeconds * 1e9);
+    renderer.setFrame(&view, alpha < 0.0 ? 0.0 : (alpha > 1.0 ? 1.0 : alpha));
+    renderer.followPacman();
+    scheduleRepaint(changed);
 }
 
-void Game::drawPacman(QPainter &painter) {
-    int x = static_cast<int>(pacmanPos.x() * CELL_SIZE);
-    int y = static_cast<int>(pacmanPos.y() * CELL_SIZE);
+void Game::scheduleRepaint(const QRegion &changedCells) {
+    // Al terminar la partida el texto cubre toda la ventana
+    if(renderer.frame().state.gameOver) {
+        update();
+        return;
+    }
 
-    painter.setBrush(Qt::yellow);
-    int startAngle = (pacmanDir * 90 + mouthAngle/2) * 16;
-    painter.drawPie(x - CELL_SIZE/2 + 2, y - CELL_SIZE/2 + 2,
-                    CELL_SIZE - 4, CELL_SIZE - 4,
-                    startAngle, (360 - mouthAngle) * 16);
-}
+    // Si la cámara se movió cambia toda la vista
+    if(renderer.viewOrigin() != paintedOrigin) {
+        paintedOrigin = renderer.viewOrigin();
+        renderer.dropHiddenChunks();
+        lastActorRegion = renderer.actorRegion();
+        update();
+        return;
+    }
 
-void Game::drawGhosts(QPainter &painter) {
-    for(const auto &ghost : ghosts) {
-        int x = static_cast<int>(ghost.pos.x() * CELL_SIZE);
-        int y = static_cast<int>(ghost.pos.y() * CELL_SIZE);
+    // Solo donde estaban y donde están los actores, el HUD y los puntos comidos
+    QRegion current = renderer.actorRegion();
+    update(lastActorRegion + current + renderer.hudRect() + changedCells);
+    lastActorRegion = current;
+}
 
-        painter.setBrush(ghost.scared ? Qt::blue : ghost.color);
-        painter.drawEllipse(x - CELL_SIZE/2 + 2, y - CELL_SIZE/2 + 2,
-                            CELL_SIZE - 4, CELL_SIZE - 4);
+void Game::paintEvent(QPaintEvent *event) {
+    QElapsedTimer paintTimer;
+    paintTimer.start();
 
-        // Ojos
-        painter.setBrush(Qt::white);
-        painter.drawEllipse(x - 5, y - 5, 6, 6);
-        painter.drawEllipse(x + 2, y - 5, 6, 6);
+    QPainter painter(this);
+    painter.setClipRegion(event->region());
+
+    renderer.drawMap(painter);
+    renderer.drawPacman(painter);
+    renderer.drawGhosts(painter);
+    renderer.drawUI(painter);
+
+    // Fin del pintado del primer frame con la tecla: lo más cerca de la
+    // pantalla que se puede medir desde aquí
+    if(pendingInputNs) {
+        inputToPresent.add(monotonicNs() - pendingInputNs);
+        pendingInputNs = 0;
     }
+
+    lastPaintNs = paintTimer.nsecsElapsed();
+    avgPaintNs = avgPaintNs == 0.0 ? lastPaintNs : avgPaintNs * 0.95 + lastPaintNs * 0.05;
+    if(showPaintStats) drawPaintStats(painter);
 }
 
-void Game::drawUI(QPainter &painter) {
+void Game::drawPaintStats(QPainter &painter) {
+    // El propio overlay no entra en el tiempo medido
     painter.setPen(Qt::white);
-    painter.drawText(10, GRID_HEIGHT * CELL_SIZE + 30,
-                     QString("Score: %1  Lives: %2").arg(score).arg(lives));
+    painter.setFont(QFont("Monospace", 8));
+    QRect hud = renderer.hudRect();
+    painter.drawText(hud.adjusted(0, 0, -10, -8), Qt::AlignRight | Qt::AlignBottom,
+                     QString("paint %1 us (avg %2 us)  tick late %3 us")
+                         .arg(lastPaintNs / 1000.0, 0, 'f', 1)
+                         .arg(avgPaintNs / 1000.0, 0, 'f', 1)
+                         .arg(renderer.frame().lateUs, 0, 'f', 0));
+
+    auto ms = [](int64_t ns) { return QString::number(ns / 1e6, 'f', 1); };
+    painter.drawText(hud.adjusted(0, 4, -10, 0), Qt::AlignRight | Qt::AlignTop,
+                     QString("key->tick p50 %1  key->present p50 %2 p95 %3 p99 %4 max %5 ms (%6)")
+                         .arg(ms(inputToTick.percentile(50)))
+                         .arg(ms(inputToPresent.percentile(50)))
+                         .arg(ms(inputToPresent.percentile(95)))
+                         .arg(ms(inputToPresent.percentile(99)))
+                         .arg(ms(inputToPresent.percentile(100)))
+                         .arg(inputToPresent.size()));
+}
 
-    if(gameOver) {
-        painter.setFont(QFont("Arial", 20, QFont::Bold));
-        painter.drawText(rect(), Qt::AlignCenter, "GAME OVER");
-    }
+void Game::closeEvent(QCloseEvent *event) {
+    // Con el hilo parado la grabación ya no cambia
+    stopSimulation();
+    saveRecording();
+    capture.close();
+    QWidget::closeEvent(event);
 }
 
 void Game::keyPressEvent(QKeyEvent *event) {
+    // En revisión las flechas avanzan o retroceden un frame
+    if(timeline) {
+        int step = event->modifiers() & Qt::ShiftModifier ? 100 : 1;
+        switch(event->key()) {
+        case Qt::Key_Left:  timeline->setValue(timeline->value() - step); break;
+        case Qt::Key_Right: timeline->setValue(timeline->value() + step); break;
+        case Qt::Key_Home:  timeline->setValue(0); break;
+        case Qt::Key_End:   timeline->setValue(timeline->maximum()); break;
+        case Qt::Key_F3:    showPaintStats = !showPaintStats; update(); break;
+        }
+        return;
+    }
+
+    // El resto va a la simulación por la cola; si está llena (el hilo
+    // lleva 64 teclas sin leer) se pierde la pulsación
+    Command cmd = {CMD_DIRECTION, DIR_NONE, monotonicNs()};
     switch(event->key()) {
-    case Qt::Key_Left:  nextDir = 2; break;
-    case Qt::Key_Right: nextDir = 0; break;
-    case Qt::Key_Up:    nextDir = 3; break;
-    case Qt::Key_Down:  nextDir = 1; break;
-    case Qt::Key_R:     if(gameOver) initGame(); break;
+    case Qt::Key_Left:  cmd.dir = DIR_LEFT; break;
+    case Qt::Key_Right: cmd.dir = DIR_RIGHT; break;
+    case Qt::Key_Up:    cmd.dir = DIR_UP; break;
+    case Qt::Key_Down:  cmd.dir = DIR_DOWN; break;
+    case Qt::Key_R:     cmd.type = CMD_RESTART; break;
+    case Qt::Key_A:     cmd.type = CMD_AUTOPILOT; break;
+    case Qt::Key_F3:    showPaintStats = !showPaintStats; update(); return;
+    default:            return;
     }
+    commands.push(cmd);
 }
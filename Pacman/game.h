@@ -4,70 +4,183 @@
 #include <QWidget>
 #include <QTimer>
 #include <QKeyEvent>
+#include <QPaintEvent>
 #include <QPainter>
-#include <QVector>
-#include <QPoint>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QRegion>
+#include "pacmancore.h"
+#include "fixedclock.h"
+#include "gamerenderer.h"
+#include "replay.h"
+#include "seekreplay.h"
+#include "autopilot.h"
+#include "rollback.h"
+#include "triplebuffer.h"
+#include "spscring.h"
+#include "latencystats.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <QString>
+#include <QSlider>
 
+// Vista Qt del juego: las reglas viven en PacmanCore y el dibujo en
+// GameRenderer; aquí se traduce el teclado a direcciones y se decide qué
+// repintar.
+// La simulación corre en su propio hilo a ritmo fijo y publica cada tick
+// en un triple buffer; el hilo de la GUI dibuja el último publicado sin
+// bloquearse y le pasa el teclado por una cola SPSC. Así un paintEvent
+// lento no retrasa la lógica.
+// Los métodos de configuración (semilla, grabación, red...) están
+// pensados para llamarse antes de show().
 class Game : public QWidget {
     Q_OBJECT
 
 public:
+    // Ritmo por defecto de la simulación (también el de los videos exportados)
+    static const int TICK_RATE = 20;
+
     explicit Game(QWidget *parent = nullptr);
+    ~Game() override;
+
+    // Ticks de simulación por segundo (las reglas avanzan por tick)
+    void setTickRate(int ticksPerSecond);
+    // Frecuencia de dibujo, independiente de la simulación
+    void setRenderRate(int framesPerSecond);
+
+    // Semilla de la partida (0 = tomada del reloj); se aplica al reiniciar
+    void setSeed(uint64_t seed);
+    // Graba cada partida en path (se escribe al terminar o al cerrar)
+    void startRecording(const QString &path);
+    // Guarda cada frame en una repetición con keyframes (navegable)
+    void startCapture(const QString &path);
+    // Abre una repetición navegable con una línea de tiempo en lugar de jugar
+    bool openReplay(const QString &path);
+
+    // Partida a dos jugadores con rollback por el enlace dado: localPlayer
+    // es RollbackSession::PLAYER_PACMAN o PLAYER_GHOST (lleva a Blinky).
+    // Los dos lados necesitan la misma semilla y el mismo retraso.
+    void startNetplay(std::unique_ptr<NetLink> link, int localPlayer, int inputDelay);
+    // Igual, contra un fantasma controlado por el propio programa a través
+    // de un enlace en memoria con latencia de latencyFrames ticks
+    void startLoopback(int latencyFrames, int inputDelay);
 
 protected:
+    void showEvent(QShowEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void closeEvent(QCloseEvent *event) override;
 
 private slots:
-    void gameLoop();
+    void renderFrame();
 
 private:
-    // Configuración del juego
-    static const int CELL_SIZE = 30;
-    static const int GRID_WIDTH = 19;
-    static const int GRID_HEIGHT = 21;
+    // bench/pacmanbench.cpp mide el tick y el pintado sin hilo ni bucle de eventos
+    friend class PacmanBench;
 
-    // Mapa (0=vacío, 1=muro, 2=punto, 3=power pellet)
-    int map[GRID_HEIGHT][GRID_WIDTH];
+    // Configuración de la vista
+    static const int RENDER_RATE = 60;
+    static constexpr double AUTOPILOT_BUDGET_MS = 10.0;
 
-    // Pac-Man
-    QPointF pacmanPos;
-    int pacmanDir; // 0=derecha, 1=abajo, 2=izquierda, 3=arriba
-    int nextDir;
-    float pacmanSpeed;
-    int mouthAngle;
-
-    // Fantasmas
-    struct Ghost {
-        QPointF pos;
-        int dir;
-        QColor color;
-        bool scared;
+    // Lo que la simulación publica en cada tick
+    typedef GameRenderer::Frame Frame;
+
+    // Órdenes del teclado para el hilo de simulación
+    enum CommandType { CMD_DIRECTION, CMD_RESTART, CMD_AUTOPILOT };
+    struct Command {
+        int8_t type;
+        int8_t dir;
+        qint64 timeNs; // hora de la pulsación (reloj monotónico)
     };
-    QVector<Ghost> ghosts;
 
-    // Estado del juego
-    int score;
-    int lives;
-    bool gameOver;
-    int frightenedTimer;
+    // Hilo de simulación; todo lo de esta sección y hasta la repetición
+    // navegable es suyo mientras corre
+    std::thread simThread;
+    std::atomic<bool> simRunning;
+    SpscRing<Command, 64> commands;
+    TripleBuffer<Frame> frames;
+    double lateUs;
+    uint8_t inputPhase;     // fase (1/256 de tick) del giro pendiente
+    qint64 lastInputNs;
+    qint64 lastAppliedNs;   // -1 mientras la última tecla espera su tick
+    qint64 seenPublishedNs;
+
+    // Simulación
+    PacmanCore core;
+    int nextDir;
+    FixedClock clock;
+    uint64_t fixedSeed;
+
+    // Grabación de entradas
+    Recording recording;
+    QString recordPath;
+    bool recordingSaved;
 
-    // Timer
+    // Piloto automático (tecla A); se crea la primera vez que se activa
+    std::unique_ptr<Autopilot> autopilot;
+    bool autopilotOn;
+
+    // Partida en red: la sesión simula y core solo guarda el último estado
+    // para dibujarlo. En --loopback el rival es otra sesión en el proceso.
+    std::unique_ptr<NetLink> netLink;
+    std::unique_ptr<RollbackSession> session;
+    LoopbackLink loopback[2];
+    std::unique_ptr<RollbackSession> peer;
+
+    // Repetición navegable: captura mientras se juega y revisión
+    SeekableReplayWriter capture;
+    QString capturePath;
+    SeekableReplay review;
+    QSlider *timeline;
+
+    // Posiciones del tick anterior, para interpolar al dibujar
+    Vec2 prevPacmanPos;
+    Vec2 prevGhostPos[NUM_GHOSTS];
+
+    // Lado de la GUI: dibuja el frame del triple buffer o uno de la
+    // repetición, con la fracción de tick para interpolar
+    GameRenderer renderer;
+    Frame reviewFrame;
+
+    // Latencia de las teclas: hasta el tick que las aplica y hasta que el
+    // frame que las muestra termina de pintarse
+    LatencyStats inputToTick;
+    LatencyStats inputToPresent;
+    qint64 seenInputNs;
+    qint64 pendingInputNs;
+
+    // Timer de dibujo
     QTimer *timer;
 
+    // Origen de la cámara en el último frame pintado
+    QPoint paintedOrigin;
+
+    // Zona ocupada por los actores en el último frame pintado
+    QRegion lastActorRegion;
+
+    // Overlay de depuración (F3) con el tiempo de pintado
+    bool showPaintStats;
+    qint64 lastPaintNs;
+    double avgPaintNs;
+
     // Métodos auxiliares
-    void initMap();
     void initGame();
-    void movePacman();
-    void moveGhosts();
-    bool canMove(QPointF pos, int dir);
-    void checkCollisions();
-    void eatDot(int x, int y);
-    QPointF getNextPos(QPointF pos, int dir);
-    void drawPacman(QPainter &painter);
-    void drawGhosts(QPainter &painter);
-    void drawMap(QPainter &painter);
-    void drawUI(QPainter &painter);
+    void startSimulation();
+    bool stopSimulation();
+    void simulationLoop();
+    void applyCommands(qint64 tickStartNs);
+    void resetSimulation();
+    void simulateTick();
+    void publishFrame();
+    void saveRecording();
+    void beginSession(NetLink *link, int localPlayer, int inputDelay);
+    void advanceNetFrame();
+    int peerGhostInput() const;
+    void showReplayFrame(int frame);
+    void savePreviousPositions();
+    void scheduleRepaint(const QRegion &changedCells);
+    void drawPaintStats(QPainter &painter);
 };
 
 #endif // GAME_H
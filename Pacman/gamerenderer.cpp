@@ -0,0 +1,268 @@
+#include "gamerenderer.h"
+#include <QFont>
+#include <QString>
+#include <algorithm>
+
+GameRenderer::GameRenderer() : view(nullptr), renderAlpha(1.0), dpr(1.0) {
+    // Hasta buildMapLayers() o loadMaze(), un tablero normal vacío
+    tiles = ChunkedMaze(GRID_WIDTH, GRID_HEIGHT);
+    fitCamera();
+}
+
+void GameRenderer::fitCamera() {
+    // Se muestran a lo sumo MAX_VIEW_COLUMNS x MAX_VIEW_ROWS celdas
+    camera.setWorld(tiles.width(), tiles.height());
+    camera.setViewport(std::min(tiles.width(), static_cast<int>(MAX_VIEW_COLUMNS)),
+                       std::min(tiles.height(), static_cast<int>(MAX_VIEW_ROWS)));
+}
+
+void GameRenderer::setup(const QColor &color, qreal devicePixelRatio) {
+    background = color;
+    dpr = devicePixelRatio;
+    chunkCache.clear();
+
+    QColor colors[NUM_GHOSTS];
+    for(int i = 0; i < NUM_GHOSTS; i++) colors[i] = ghostColor(i);
+    sprites.build(CELL_SIZE, dpr, colors, NUM_GHOSTS);
+}
+
+QPointF GameRenderer::interpolatePos(Vec2 prev, Vec2 cur, double alpha) const {
+    // En celdas. Tras un túnel o una muerte el salto es mayor a una celda:
+    // no se interpola
+    int dx = cur.x - prev.x;
+    int dy = cur.y - prev.y;
+    if(dx > SUBCELL || dx < -SUBCELL || dy > SUBCELL || dy < -SUBCELL) alpha = 1.0;
+    return QPointF((prev.x + dx * alpha) / SUBCELL, (prev.y + dy * alpha) / SUBCELL);
+}
+
+QPoint GameRenderer::interpolate(Vec2 prev, Vec2 cur, double alpha) const {
+    // En coordenadas de la vista, ya con la cámara restada
+    QPointF p = interpolatePos(prev, cur, alpha);
+    return QPoint(static_cast<int>(p.x() * CELL_SIZE), static_cast<int>(p.y() * CELL_SIZE)) -
+           viewOrigin();
+}
+
+QColor GameRenderer::ghostColor(int index) {
+    static const QColor colors[NUM_GHOSTS] = {
+        Qt::red, Qt::cyan, QColor(255, 184, 255), QColor(255, 184, 82)
+    };
+    return colors[index % NUM_GHOSTS];
+}
+
+void GameRenderer::buildMapLayers() {
+    const GameState &s = view->state;
+    tiles.assign(s);
+    fitCamera();
+    chunkCache.clear();
+    drawnDots = s.dots;
+    drawnPowers = s.powers;
+    camera.centre(static_cast<double>(s.pacmanPos.x) / SUBCELL,
+                  static_cast<double>(s.pacmanPos.y) / SUBCELL);
+}
+
+void GameRenderer::loadMaze(const ChunkedMaze &maze, Vec2 focus) {
+    tiles = maze;
+    fitCamera();
+    chunkCache.clear();
+    drawnDots.clearAll();
+    drawnPowers.clearAll();
+    camera.centre(static_cast<double>(focus.x) / SUBCELL, static_cast<double>(focus.y) / SUBCELL);
+}
+
+QRegion GameRenderer::syncDotLayer() {
+    // Compara los bitboards con lo que ya está dibujado y retoca solo las
+    // celdas que cambiaron. Los bitboards son del tablero normal: con un
+    // laberinto cargado por loadMaze() están vacíos y no cambia nada.
+    const GameState &s = view->state;
+    QRegion changed;
+
+    for(int w = 0; w < Bitboard::WORDS; w++) {
+        uint64_t diff = (s.dots.words[w] ^ drawnDots.words[w]) |
+                        (s.powers.words[w] ^ drawnPowers.words[w]);
+        while(diff) {
+            int c = w * 64 + __builtin_ctzll(diff);
+            diff &= diff - 1;
+
+            int x = c % GRID_WIDTH, y = c / GRID_WIDTH;
+            changed += setCell(x, y, static_cast<uint8_t>(s.cellAt(x, y)));
+        }
+        drawnDots.words[w] = s.dots.words[w];
+        drawnPowers.words[w] = s.powers.words[w];
+    }
+    return changed;
+}
+
+QRect GameRenderer::setCell(int x, int y, uint8_t cell) {
+    tiles.set(x, y, cell);
+    auto cached = chunkCache.find((y >> ChunkedMaze::CHUNK_SHIFT) * tiles.chunksX() +
+                                  (x >> ChunkedMaze::CHUNK_SHIFT));
+    if(cached != chunkCache.end()) {
+        QPainter painter(&cached.value());
+        painter.setRenderHint(QPainter::Antialiasing);
+        drawCell(painter, QRect((x & (ChunkedMaze::CHUNK - 1)) * CELL_SIZE,
+                                (y & (ChunkedMaze::CHUNK - 1)) * CELL_SIZE,
+                                CELL_SIZE, CELL_SIZE), cell);
+    }
+    return cellRect(x, y);
+}
+
+void GameRenderer::followPacman() {
+    QPointF pacman = interpolatePos(view->prevPacmanPos, view->state.pacmanPos, renderAlpha);
+    camera.follow(pacman.x(), pacman.y());
+}
+
+QPoint GameRenderer::viewOrigin() const {
+    return QPoint(static_cast<int>(camera.left() * CELL_SIZE),
+                  static_cast<int>(camera.top() * CELL_SIZE));
+}
+
+const QPixmap &GameRenderer::chunkPixmap(int chunkX, int chunkY) {
+    int key = chunkY * tiles.chunksX() + chunkX;
+    auto cached = chunkCache.find(key);
+    if(cached != chunkCache.end()) return cached.value();
+
+    // Se pinta el bloque entero recorriendo sus celdas seguidas en memoria
+    const int side = ChunkedMaze::CHUNK * CELL_SIZE;
+    QPixmap pixmap(QSize(side, side) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(background);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const uint8_t *cells = tiles.chunk(chunkX, chunkY);
+    const int x0 = chunkX * ChunkedMaze::CHUNK, y0 = chunkY * ChunkedMaze::CHUNK;
+    const int columns = std::min(static_cast<int>(ChunkedMaze::CHUNK), tiles.width() - x0);
+    const int rows = std::min(static_cast<int>(ChunkedMaze::CHUNK), tiles.height() - y0);
+    for(int y = 0; y < rows; y++) {
+        for(int x = 0; x < columns; x++) {
+            uint8_t cell = cells[y * ChunkedMaze::CHUNK + x];
+            if(cell != CELL_EMPTY) {
+                drawCell(painter, QRect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE), cell);
+            }
+        }
+    }
+    painter.end();
+    return chunkCache.insert(key, pixmap).value();
+}
+
+void GameRenderer::drawCell(QPainter &painter, const QRect &rect, int cell) const {
+    if(cell == CELL_WALL) {
+        painter.fillRect(rect, Qt::blue);
+        return;
+    }
+    painter.fillRect(rect, background);
+    if(cell == CELL_DOT) {
+        painter.setBrush(QColor(255, 255, 200));
+        painter.drawEllipse(rect.x() + CELL_SIZE/2 - 2, rect.y() + CELL_SIZE/2 - 2, 4, 4);
+    } else if(cell == CELL_POWER) {
+        painter.setBrush(Qt::white);
+        painter.drawEllipse(rect.x() + CELL_SIZE/2 - 5, rect.y() + CELL_SIZE/2 - 5, 10, 10);
+    }
+}
+
+void GameRenderer::dropHiddenChunks() {
+    // Se guardan los bloques visibles y un anillo alrededor, para que ir y
+    // volver por un borde no los repinte
+    ChunkedMaze::ChunkRange keep =
+        tiles.chunksIn(camera.left() - ChunkedMaze::CHUNK, camera.top() - ChunkedMaze::CHUNK,
+                       camera.viewWidth() + 2 * ChunkedMaze::CHUNK,
+                       camera.viewHeight() + 2 * ChunkedMaze::CHUNK);
+    for(auto it = chunkCache.begin(); it != chunkCache.end();) {
+        int chunkX = it.key() % tiles.chunksX(), chunkY = it.key() / tiles.chunksX();
+        bool near = chunkX >= keep.x0 && chunkX < keep.x1 && chunkY >= keep.y0 && chunkY < keep.y1;
+        if(near) ++it;
+        else it = chunkCache.erase(it);
+    }
+}
+
+QRect GameRenderer::cellRect(int x, int y) const {
+    return QRect(x * CELL_SIZE, y * CELL_SIZE, CELL_SIZE, CELL_SIZE).translated(-viewOrigin());
+}
+
+QRect GameRenderer::actorRect(QPoint center) const {
+    // Un poco más que la celda por el borde antialiasado
+    return QRect(center.x() - CELL_SIZE/2 - 1, center.y() - CELL_SIZE/2 - 1,
+                 CELL_SIZE + 2, CELL_SIZE + 2);
+}
+
+QRect GameRenderer::hudRect() const {
+    return QRect(0, mapHeight(), width(), HUD_HEIGHT);
+}
+
+QRegion GameRenderer::actorRegion() const {
+    const GameState &s = view->state;
+    QRegion region = actorRect(interpolate(view->prevPacmanPos, s.pacmanPos, renderAlpha));
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        region += actorRect(interpolate(view->prevGhostPos[i], s.ghosts[i].pos, renderAlpha));
+    }
+    return region;
+}
+
+void GameRenderer::drawMap(QPainter &painter) {
+    painter.fillRect(hudRect(), background);
+
+    // Solo los bloques que tocan la cámara, y de cada uno solo los
+    // rectángulos a repintar (todo si el painter no recorta, como al
+    // pintar un QImage entero)
+    const QPoint origin = viewOrigin();
+    const int side = ChunkedMaze::CHUNK * CELL_SIZE;
+    const QRect area(0, 0, width(), mapHeight());
+    const QRegion clip = painter.hasClipping() ? painter.clipRegion() & area : QRegion(area);
+    ChunkedMaze::ChunkRange range = tiles.chunksIn(camera.left(), camera.top(),
+                                                   camera.viewWidth(), camera.viewHeight());
+    for(int chunkY = range.y0; chunkY < range.y1; chunkY++) {
+        for(int chunkX = range.x0; chunkX < range.x1; chunkX++) {
+            QRect target(chunkX * side - origin.x(), chunkY * side - origin.y(), side, side);
+            if(!clip.intersects(target)) continue;
+            const QPixmap &pixmap = chunkPixmap(chunkX, chunkY);
+            qreal ratio = pixmap.devicePixelRatio();
+            for(const QRect &r : clip & target) {
+                QPointF source = r.topLeft() - target.topLeft();
+                painter.drawPixmap(r, pixmap, QRectF(source * ratio, r.size() * ratio));
+            }
+        }
+    }
+}
+
+void GameRenderer::drawPacman(QPainter &painter) {
+    const GameState &s = view->state;
+    QPoint p = interpolate(view->prevPacmanPos, s.pacmanPos, renderAlpha);
+    sprites.drawPacman(painter, p, s.pacmanDir, s.mouthAngle);
+}
+
+void GameRenderer::drawGhosts(QPainter &painter) {
+    const GameState &s = view->state;
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        const GhostState &ghost = s.ghosts[i];
+        QPoint p = interpolate(view->prevGhostPos[i], ghost.pos, renderAlpha);
+        sprites.drawGhost(painter, p, i, ghost.scared);
+    }
+}
+
+void GameRenderer::drawUI(QPainter &painter) {
+    const GameState &s = view->state;
+    painter.setPen(Qt::white);
+    painter.drawText(10, mapHeight() + 30,
+                     QString("Score: %1  Lives: %2  Level: %3")
+                         .arg(s.score).arg(s.lives).arg(s.level));
+
+    QString status;
+    if(view->autopilotOn) {
+        status += QString("AUTO  %1 rollouts/s on %2 threads  ")
+                      .arg(view->autopilotRate, 0, 'f', 0)
+                      .arg(view->autopilotThreads);
+    }
+    if(view->netplay) {
+        const RollbackStats &st = view->net;
+        status += QString("NET delay %1  rollbacks %2 (max %3)  late %4  stalls %5%6")
+                      .arg(st.inputDelay).arg(st.rollbacks).arg(st.maxRollback)
+                      .arg(st.lateTicks, 0, 'f', 1).arg(st.stalls)
+                      .arg(st.desyncs ? "  DESYNC" : "");
+    }
+    if(!status.isEmpty()) painter.drawText(10, mapHeight() + 45, status);
+
+    if(s.gameOver) {
+        painter.setFont(QFont("Arial", 20, QFont::Bold));
+        painter.drawText(QRect(0, 0, width(), height()), Qt::AlignCenter, "GAME OVER");
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef GAMERENDERER_H
+#define GAMERENDERER_H
+
+#include <QColor>
+#include <QHash>
+#include <QPainter>
+#include <QPixmap>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRegion>
+#include "pacmancore.h"
+#include "chunkedmaze.h"
+#include "camera.h"
+#include "spriteatlas.h"
+#include "rollback.h"
+
+// Dibujo del juego sin widget: el mapa en bloques con la cámara que sigue
+// a Pac-Man, los actores interpolados entre dos ticks y el HUD, a partir
+// de un Frame publicado por la simulación. Game pinta con uno en su
+// paintEvent y el exportador de video tiene uno por hilo pintando sobre
+// QImage: cada instancia tiene sus propias cachés y no comparte nada.
+class GameRenderer {
+public:
+    static const int CELL_SIZE = 30;
+    static const int HUD_HEIGHT = 50;
+    static const int MAX_VIEW_COLUMNS = 40; // celdas visibles como mucho;
+    static const int MAX_VIEW_ROWS = 30;    // en mapas mayores la cámara se mueve
+
+    // Lo que la simulación publica en cada tick: una copia inmutable de
+    // todo lo que hace falta para dibujar
+    struct Frame {
+        GameState state;
+        Vec2 prevPacmanPos;
+        Vec2 prevGhostPos[NUM_GHOSTS];
+        qint64 tickNs;      // reloj monotónico del límite del tick
+        double tickSeconds;
+        qint64 inputNs;     // hora de la última tecla ya aplicada (0 si ninguna)
+        qint64 appliedNs;   // y hora a la que la aplicó la simulación
+        double lateUs;      // media de lo que se despierta tarde el hilo
+        bool autopilotOn;
+        double autopilotRate;
+        int autopilotThreads;
+        bool netplay;
+        RollbackStats net;
+    };
+
+    GameRenderer();
+
+    // background es el color de fondo (el de la paleta de la ventana) y
+    // devicePixelRatio el de la superficie sobre la que se va a pintar
+    void setup(const QColor &background, qreal devicePixelRatio);
+
+    int width() const { return static_cast<int>(camera.viewWidth()) * CELL_SIZE; }
+    int height() const { return mapHeight() + HUD_HEIGHT; }
+    int mapHeight() const { return static_cast<int>(camera.viewHeight()) * CELL_SIZE; }
+
+    // Frame que se dibuja (tiene que seguir vivo mientras se use) y
+    // fracción del tick ya pasada, para interpolar
+    void setFrame(const Frame *frame, double alpha) { view = frame; renderAlpha = alpha; }
+    const Frame &frame() const { return *view; }
+    double alpha() const { return renderAlpha; }
+
+    // Copia el mapa del frame y centra la cámara en Pac-Man; las capas se
+    // vuelven a pintar cuando se vean
+    void buildMapLayers();
+    // Retoca las celdas de puntos que cambiaron desde el último frame
+    // sincronizado (sea cual sea) y devuelve la región que ocupan
+    QRegion syncDotLayer();
+
+    // Mapa de otro tamaño en lugar del tablero del frame (un laberinto
+    // procedural): la vista pasa a ser de a lo sumo MAX_VIEW_COLUMNS x
+    // MAX_VIEW_ROWS celdas de ese mapa, con la cámara centrada en focus
+    void loadMaze(const ChunkedMaze &maze, Vec2 focus);
+    // Cambia una celda del mapa, la retoca en su bloque si está pintado y
+    // devuelve dónde queda en la vista
+    QRect setCell(int x, int y, uint8_t cell);
+
+    // Cámara tras Pac-Man (interpolado), o puesta en un lugar dado
+    void followPacman();
+    void moveCamera(double left, double top) { camera.moveTo(left, top); }
+    const Camera &viewCamera() const { return camera; }
+    void dropHiddenChunks();
+
+    QPoint viewOrigin() const;
+    QRect hudRect() const;
+    QRegion actorRegion() const;
+    QPointF interpolatePos(Vec2 prev, Vec2 cur, double alpha) const;
+
+    void drawMap(QPainter &painter);
+    void drawPacman(QPainter &painter);
+    void drawGhosts(QPainter &painter);
+    void drawUI(QPainter &painter);
+
+    static QColor ghostColor(int index);
+
+private:
+    const Frame *view;
+    double renderAlpha;
+    QColor background;
+    qreal dpr;
+
+    // Mapa en bloques y cámara que sigue a Pac-Man. Cada bloque visible
+    // se pinta una vez en su propio pixmap (fondo, muros y puntos) y
+    // después solo se retoca la celda de un punto que desaparece o
+    // reaparece; los bloques que quedan lejos de la cámara se descartan,
+    // así que el costo de un frame depende de la ventana y no del mapa.
+    ChunkedMaze tiles;
+    Camera camera;
+    QHash<int, QPixmap> chunkCache;  // por chunkY * chunksX() + chunkX
+    Bitboard drawnDots;
+    Bitboard drawnPowers;
+
+    // Cuadros de Pac-Man y fantasmas prerenderizados
+    SpriteAtlas sprites;
+
+    QPoint interpolate(Vec2 prev, Vec2 cur, double alpha) const;
+    const QPixmap &chunkPixmap(int chunkX, int chunkY);
+    void drawCell(QPainter &painter, const QRect &rect, int cell) const;
+    void fitCamera();
+    QRect cellRect(int x, int y) const;
+    QRect actorRect(QPoint center) const;
+};
+
+#endif // GAMERENDERER_H
@@ -0,0 +1,120 @@
+#include "ghostai.h"
+
+namespace {
+
+const int DIR_DX[4] = {1, 0, -1, 0};
+const int DIR_DY[4] = {0, 1, 0, -1};
+
+// Orden de desempate del arcade: arriba, izquierda, abajo, derecha
+const int TIE_ORDER[4] = {DIR_UP, DIR_LEFT, DIR_DOWN, DIR_RIGHT};
+
+// Esquinas de dispersión
+const int SCATTER_CELLS[NUM_GHOSTS] = {
+    1 * GRID_WIDTH + 17,   // Blinky: arriba a la derecha
+    19 * GRID_WIDTH + 17,  // Inky: abajo a la derecha
+    1 * GRID_WIDTH + 1,    // Pinky: arriba a la izquierda
+    19 * GRID_WIDTH + 1    // Clyde: abajo a la izquierda
+};
+
+// Duración de cada fase en ticks; la última persecución no termina
+const int MODE_PHASES[] = {140, 400, 140, 400, 100, 400, 100};
+const int MODE_PHASE_COUNT = sizeof(MODE_PHASES) / sizeof(MODE_PHASES[0]);
+
+int clampedCell(int x, int y) {
+    x = x < 0 ? 0 : (x >= GRID_WIDTH ? GRID_WIDTH - 1 : x);
+    y = y < 0 ? 0 : (y >= GRID_HEIGHT ? GRID_HEIGHT - 1 : y);
+    return y * GRID_WIDTH + x;
+}
+
+}
+
+const GhostSpawn GHOST_SPAWNS[NUM_GHOSTS] = {
+    {9, 7, DIR_LEFT, 0},     // Blinky empieza fuera de la casa
+    {8, 9, DIR_RIGHT, 80},
+    {9, 9, DIR_UP, 0},
+    {10, 9, DIR_LEFT, 160}
+};
+
+int ghostModeAt(long long tick) {
+    for(int i = 0; i < MODE_PHASE_COUNT; i++) {
+        if(tick < MODE_PHASES[i]) return i % 2 == 0 ? MODE_SCATTER : MODE_CHASE;
+        tick -= MODE_PHASES[i];
+    }
+    return MODE_CHASE;
+}
+
+long long ticksToModeChange(long long tick) {
+    for(int i = 0; i < MODE_PHASE_COUNT; i++) {
+        if(tick < MODE_PHASES[i]) return MODE_PHASES[i] - tick;
+        tick -= MODE_PHASES[i];
+    }
+    return -1;
+}
+
+bool inGhostHouse(int cell) {
+    int x = cell % GRID_WIDTH;
+    int y = cell / GRID_WIDTH;
+    return (y == 9 && x >= 8 && x <= 10) || (y == 8 && x == 9);
+}
+
+int ghostTargetCell(int ghost, int mode, int ghostCell, int pacmanCell,
+                    int pacmanDir, int blinkyCell, const MazeDistances &maze) {
+    if(inGhostHouse(ghostCell)) return HOUSE_EXIT_CELL;
+    if(mode == MODE_SCATTER) return SCATTER_CELLS[ghost];
+
+    int px = pacmanCell % GRID_WIDTH;
+    int py = pacmanCell / GRID_WIDTH;
+    int target = pacmanCell;
+
+    switch(ghost) {
+    case BLINKY:
+        break;
+    case PINKY:
+        // Cuatro celdas por delante de Pac-Man
+        target = clampedCell(px + 4 * DIR_DX[pacmanDir], py + 4 * DIR_DY[pacmanDir]);
+        break;
+    case INKY: {
+        // Doble del vector de Blinky a dos celdas por delante de Pac-Man
+        int ax = px + 2 * DIR_DX[pacmanDir];
+        int ay = py + 2 * DIR_DY[pacmanDir];
+        int bx = blinkyCell % GRID_WIDTH;
+        int by = blinkyCell / GRID_WIDTH;
+        target = clampedCell(2 * ax - bx, 2 * ay - by);
+        break;
+    }
+    case CLYDE:
+        // Persigue de lejos, se retira a su esquina de cerca
+        if(maze.distance(ghostCell, pacmanCell) <= 8) target = SCATTER_CELLS[CLYDE];
+        break;
+    }
+
+    return maze.nearestWalkable(target);
+}
+
+int chooseGhostDirection(const MazeDistances &maze, int cell, int dir, int targetCell) {
+    int reverse = (dir + 2) % 4;
+    int best = reverse;
+    int bestDist = MazeDistances::UNREACHABLE + 1;
+
+    for(int d : TIE_ORDER) {
+        if(d == reverse) continue;
+        int n = maze.neighbour(cell, d);
+        if(n < 0) continue;
+        int dd = maze.distance(n, targetCell);
+        if(dd < bestDist) {
+            bestDist = dd;
+            best = d;
+        }
+    }
+    return best;
+}
+
+int randomGhostDirection(const MazeDistances &maze, int cell, int dir, unsigned r) {
+    int reverse = (dir + 2) % 4;
+    int options[4];
+    int count = 0;
+    for(int d = 0; d < 4; d++) {
+        if(d != reverse && maze.neighbour(cell, d) >= 0) options[count++] = d;
+    }
+    return count > 0 ? options[r % count] : reverse;
+}
@@ -0,0 +1,50 @@
+#ifndef GHOSTAI_H
+#define GHOSTAI_H
+
+#include "mazedistances.h"
+
+// Comportamiento de los fantasmas al estilo arcade: alternan entre
+// dispersión (cada uno a su esquina) y persecución (cada uno con su propio
+// objetivo), y al estar asustados eligen al azar en cada cruce.
+// Las decisiones se toman solo en el centro de una celda, nunca dan media
+// vuelta salvo en un callejón sin salida, y usan las tablas de
+// MazeDistances, así que cada decisión son como mucho tres lecturas.
+
+enum GhostMode { MODE_SCATTER = 0, MODE_CHASE = 1 };
+enum GhostId { BLINKY = 0, INKY = 1, PINKY = 2, CLYDE = 3 };
+
+// Celda (empieza en su centro), dirección inicial y tick de salida de la
+// casa de cada fantasma
+struct GhostSpawn {
+    int x;
+    int y;
+    int dir;
+    int releaseTick;
+};
+extern const GhostSpawn GHOST_SPAWNS[NUM_GHOSTS];
+
+// Celda donde reaparece un fantasma comido y celda de salida de la casa
+const int GHOST_HOUSE_X = 9;
+const int GHOST_HOUSE_Y = 9;
+const int HOUSE_EXIT_CELL = 7 * GRID_WIDTH + 9;
+
+// Modo según el tick (tabla de dispersión/persecución del nivel 1 a 20 Hz)
+int ghostModeAt(long long tick);
+
+// Ticks que faltan desde tick hasta el próximo cambio de modo, o -1 si ya
+// no cambia más
+long long ticksToModeChange(long long tick);
+
+bool inGhostHouse(int cell);
+
+// Celda objetivo del fantasma (siempre transitable)
+int ghostTargetCell(int ghost, int mode, int ghostCell, int pacmanCell,
+                    int pacmanDir, int blinkyCell, const MazeDistances &maze);
+
+// Dirección cuyo vecino está más cerca del objetivo, sin media vuelta
+int chooseGhostDirection(const MazeDistances &maze, int cell, int dir, int targetCell);
+
+// Dirección legal al azar sin media vuelta (r es un número aleatorio)
+int randomGhostDirection(const MazeDistances &maze, int cell, int dir, unsigned r);
+
+#endif // GHOSTAI_H
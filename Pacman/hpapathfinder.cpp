@@ -0,0 +1,317 @@
+#include "hpapathfinder.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Tramos de borde desde este largo dejan una entrada en cada punta
+const int LONG_ENTRANCE = 6;
+
+// Cuadrados por tarea al construir
+const int CLUSTERS_PER_TASK = 16;
+
+}
+
+HpaPathfinder::HpaPathfinder(const ProceduralMaze &maze, int clusterSize, ThreadPool &pool)
+    : maze(maze), size(std::max(4, clusterSize)), generation(0), expanded(0) {
+    const int w = maze.width(), h = maze.height();
+    clustersX = (w + size - 1) / size;
+    clustersY = (h + size - 1) / size;
+
+    // Entradas: pares de celdas vecinas a los dos lados de un borde
+    std::vector<std::pair<int32_t, int32_t>> links;
+    for(int cx = 0; cx + 1 < clustersX; cx++) {
+        int x = (cx + 1) * size - 1;
+        for(int y0 = 0; y0 < h; y0 += size) {
+            int y1 = std::min(y0 + size, h);
+            int run = -1;
+            for(int y = y0; y <= y1; y++) {
+                bool open = y < y1 && !maze.isWall(x, y) && !maze.isWall(x + 1, y);
+                if(open && run < 0) run = y;
+                if(open || run < 0) continue;
+                int last = y - 1;
+                if(last - run + 1 >= LONG_ENTRANCE) {
+                    links.push_back({run * w + x, run * w + x + 1});
+                    links.push_back({last * w + x, last * w + x + 1});
+                } else {
+                    int mid = (run + last) / 2;
+                    links.push_back({mid * w + x, mid * w + x + 1});
+                }
+                run = -1;
+            }
+        }
+    }
+    for(int cy = 0; cy + 1 < clustersY; cy++) {
+        int y = (cy + 1) * size - 1;
+        for(int x0 = 0; x0 < w; x0 += size) {
+            int x1 = std::min(x0 + size, w);
+            int run = -1;
+            for(int x = x0; x <= x1; x++) {
+                bool open = x < x1 && !maze.isWall(x, y) && !maze.isWall(x, y + 1);
+                if(open && run < 0) run = x;
+                if(open || run < 0) continue;
+                int last = x - 1;
+                if(last - run + 1 >= LONG_ENTRANCE) {
+                    links.push_back({y * w + run, (y + 1) * w + run});
+                    links.push_back({y * w + last, (y + 1) * w + last});
+                } else {
+                    int mid = (run + last) / 2;
+                    links.push_back({y * w + mid, (y + 1) * w + mid});
+                }
+                run = -1;
+            }
+        }
+    }
+    for(int y : maze.tunnelRows()) links.push_back({y * w, y * w + w - 1});
+
+    // Nodos sin repetir, ordenados por cuadrado y celda
+    std::vector<int32_t> cells;
+    cells.reserve(links.size() * 2);
+    for(const auto &link : links) {
+        cells.push_back(link.first);
+        cells.push_back(link.second);
+    }
+    auto byCluster = [this](int32_t a, int32_t b) {
+        int ca = clusterOf(a), cb = clusterOf(b);
+        return ca != cb ? ca < cb : a < b;
+    };
+    std::sort(cells.begin(), cells.end(), byCluster);
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    nodeCell = cells;
+
+    clusterFirst.assign(clusterCount() + 1, 0);
+    for(int32_t cell : nodeCell) clusterFirst[clusterOf(cell) + 1]++;
+    for(int c = 0; c < clusterCount(); c++) clusterFirst[c + 1] += clusterFirst[c];
+
+    auto nodeOf = [&](int32_t cell) {
+        int c = clusterOf(cell);
+        auto first = nodeCell.begin() + clusterFirst[c];
+        auto last = nodeCell.begin() + clusterFirst[c + 1];
+        return static_cast<int32_t>(std::lower_bound(first, last, cell) - nodeCell.begin());
+    };
+
+    edges.resize(nodeCell.size());
+    for(const auto &link : links) {
+        int32_t a = nodeOf(link.first), b = nodeOf(link.second);
+        edges[a].push_back({b, 1});
+        edges[b].push_back({a, 1});
+    }
+
+    // Distancias dentro de cada cuadrado: cada tarea solo toca las listas
+    // de los nodos de sus cuadrados
+    for(int first = 0; first < clusterCount(); first += CLUSTERS_PER_TASK) {
+        int last = std::min(first + CLUSTERS_PER_TASK, clusterCount());
+        pool.submit([this, first, last] {
+            ClusterSearch search;
+            for(int c = first; c < last; c++) buildCluster(c, search);
+        });
+    }
+    pool.waitAll();
+
+    nodeX.resize(nodeCell.size());
+    nodeY.resize(nodeCell.size());
+    nodeCluster.resize(nodeCell.size());
+    for(size_t i = 0; i < nodeCell.size(); i++) {
+        nodeX[i] = nodeCell[i] % w;
+        nodeY[i] = nodeCell[i] / w;
+        nodeCluster[i] = clusterOf(nodeCell[i]);
+    }
+    gScore.assign(nodeCell.size() + 1, 0);
+    cameFrom.assign(nodeCell.size() + 1, -1);
+    seen.assign(nodeCell.size() + 1, 0);
+}
+
+long long HpaPathfinder::edgeCount() const {
+    long long count = 0;
+    for(const auto &list : edges) count += static_cast<long long>(list.size());
+    return count;
+}
+
+int HpaPathfinder::clusterOf(int cell) const {
+    return (cell / maze.width()) / size * clustersX + (cell % maze.width()) / size;
+}
+
+int HpaPathfinder::localIndex(int cluster, int cell) const {
+    int x = cell % maze.width() - cluster % clustersX * size;
+    int y = cell / maze.width() - cluster / clustersX * size;
+    return y * size + x;
+}
+
+void HpaPathfinder::bfs(int cluster, int from, ClusterSearch &search) const {
+    // En coordenadas locales y mirando los muros directamente: sin salir
+    // del cuadrado no hay túnel (el túnel es una entrada más)
+    const int w = maze.width();
+    const int x0 = cluster % clustersX * size, y0 = cluster / clustersX * size;
+    const int cw = std::min(size, w - x0), ch = std::min(size, maze.height() - y0);
+    const std::vector<uint8_t> &walls = maze.wallData();
+    search.dist.assign(size * size, -1);
+    search.parent.resize(size * size);
+    search.queue.resize(size * size);
+
+    int head = 0, tail = 0;
+    int start = localIndex(cluster, from);
+    search.dist[start] = 0;
+    search.parent[start] = -1;
+    search.queue[tail++] = start;
+    auto visit = [&](int local, int next) {
+        if(search.dist[next] >= 0) return;
+        search.dist[next] = search.dist[local] + 1;
+        search.parent[next] = local;
+        search.queue[tail++] = next;
+    };
+    while(head < tail) {
+        int local = search.queue[head++];
+        int lx = local % size, ly = local / size;
+        const uint8_t *cell = &walls[(y0 + ly) * w + x0 + lx];
+        if(lx > 0 && !cell[-1]) visit(local, local - 1);
+        if(lx + 1 < cw && !cell[1]) visit(local, local + 1);
+        if(ly > 0 && !cell[-w]) visit(local, local - size);
+        if(ly + 1 < ch && !cell[w]) visit(local, local + size);
+    }
+}
+
+void HpaPathfinder::buildCluster(int cluster, ClusterSearch &search) {
+    for(int u = clusterFirst[cluster]; u < clusterFirst[cluster + 1]; u++) {
+        bfs(cluster, nodeCell[u], search);
+        for(int v = clusterFirst[cluster]; v < clusterFirst[cluster + 1]; v++) {
+            int d = search.dist[localIndex(cluster, nodeCell[v])];
+            if(v != u && d >= 0) edges[u].push_back({v, d});
+        }
+    }
+}
+
+int HpaPathfinder::search(int from, int to) {
+    abstractPath.clear();
+    expanded = 0;
+    if(from == to) return 0;
+
+    // Mismo cuadrado y se llega sin salir: no hace falta el grafo
+    int fromCluster = clusterOf(from), toCluster = clusterOf(to);
+    bfs(fromCluster, from, fromSearch);
+    if(fromCluster == toCluster) {
+        int d = fromSearch.dist[localIndex(toCluster, to)];
+        if(d >= 0) {
+            abstractPath.push_back(to);
+            return d;
+        }
+    }
+    bfs(toCluster, to, toSearch);
+
+    // A* con el destino como nodo extra (goal); el origen entra con sus
+    // distancias a las entradas de su cuadrado
+    const int goal = nodeCount();
+    if(++generation == 0) {
+        std::fill(seen.begin(), seen.end(), 0);
+        generation = 1;
+    }
+    const int w = maze.width();
+    const int toX = to % w, toY = to / w;
+    const bool wraps = !maze.tunnelRows().empty();
+    auto heuristic = [&](int node) {
+        // Manhattan; con túneles, también dando la vuelta por los costados
+        if(node == goal) return 0;
+        int dx = std::abs(nodeX[node] - toX);
+        if(wraps) dx = std::min(dx, w - dx);
+        return dx + std::abs(nodeY[node] - toY);
+    };
+    std::vector<OpenNode> &open = openList;
+    open.clear();
+    auto later = [](const OpenNode &a, const OpenNode &b) { return a.f > b.f; };
+    auto relax = [&](int node, int g, int parent) {
+        if(seen[node] == generation && gScore[node] <= g) return;
+        seen[node] = generation;
+        gScore[node] = g;
+        cameFrom[node] = parent;
+        open.push_back({g + heuristic(node), g, node});
+        std::push_heap(open.begin(), open.end(), later);
+    };
+
+    for(int v = clusterFirst[fromCluster]; v < clusterFirst[fromCluster + 1]; v++) {
+        int d = fromSearch.dist[localIndex(fromCluster, nodeCell[v])];
+        if(d >= 0) relax(v, d, -1);
+    }
+    while(!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), later);
+        OpenNode top = open.back();
+        open.pop_back();
+        int u = top.node, g = top.g;
+        if(g != gScore[u]) continue; // ya se llegó por un camino más corto
+        if(u == goal) break;
+        expanded++;
+
+        if(nodeCluster[u] == toCluster) {
+            int d = toSearch.dist[localIndex(toCluster, nodeCell[u])];
+            if(d >= 0) relax(goal, g + d, u);
+        }
+        for(const Edge &e : edges[u]) relax(e.to, g + e.cost, u);
+    }
+    if(seen[goal] != generation) return -1;
+
+    abstractPath.push_back(to);
+    for(int node = cameFrom[goal]; node >= 0; node = cameFrom[node]) {
+        if(nodeCell[node] != from) abstractPath.push_back(nodeCell[node]);
+    }
+    std::reverse(abstractPath.begin(), abstractPath.end());
+    return gScore[goal];
+}
+
+int HpaPathfinder::distance(int from, int to) {
+    return search(from, to);
+}
+
+void HpaPathfinder::appendSegment(int from, int to, std::vector<int> &cells) {
+    // Dos puntos de paso seguidos son vecinos (una entrada o el túnel) o
+    // están en el mismo cuadrado
+    for(int d = 0; d < 4; d++) {
+        if(maze.neighbour(from, d) == to) {
+            cells.push_back(to);
+            return;
+        }
+    }
+    int cluster = clusterOf(from);
+    bfs(cluster, from, refineSearch);
+    size_t mark = cells.size();
+    int x0 = cluster % clustersX * size, y0 = cluster / clustersX * size;
+    for(int local = localIndex(cluster, to); refineSearch.parent[local] >= 0;
+        local = refineSearch.parent[local]) {
+        cells.push_back((y0 + local / size) * maze.width() + x0 + local % size);
+    }
+    std::reverse(cells.begin() + mark, cells.end());
+}
+
+bool HpaPathfinder::path(int from, int to, std::vector<int> &cells) {
+    cells.clear();
+    if(search(from, to) < 0) return false;
+    cells.push_back(from);
+    int previous = from;
+    for(int waypoint : abstractPath) {
+        appendSegment(previous, waypoint, cells);
+        previous = waypoint;
+    }
+    return true;
+}
+
+int HpaPathfinder::firstStep(int from, int to) {
+    if(search(from, to) <= 0) return DIR_NONE;
+
+    // El primer punto de paso está en el cuadrado de from, y el BFS desde
+    // from ya tiene los padres
+    int cluster = clusterOf(from);
+    int start = localIndex(cluster, from);
+    int local = localIndex(cluster, abstractPath[0]);
+    if(clusterOf(abstractPath[0]) != cluster || fromSearch.dist[local] < 0) {
+        // Vecino por el túnel
+        for(int d = 0; d < 4; d++) {
+            if(maze.neighbour(from, d) == abstractPath[0]) return d;
+        }
+        return DIR_NONE;
+    }
+    while(fromSearch.parent[local] != start) local = fromSearch.parent[local];
+    int x0 = cluster % clustersX * size, y0 = cluster / clustersX * size;
+    int next = (y0 + local / size) * maze.width() + x0 + local % size;
+    for(int d = 0; d < 4; d++) {
+        if(maze.neighbour(from, d) == next) return d;
+    }
+    return DIR_NONE;
+}
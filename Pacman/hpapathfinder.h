@@ -0,0 +1,93 @@
+#ifndef HPAPATHFINDER_H
+#define HPAPATHFINDER_H
+
+// Búsqueda de caminos jerárquica (HPA*) sobre un ProceduralMaze. El
+// laberinto se parte en cuadrados de clusterSize x clusterSize celdas; en
+// cada borde entre dos vecinos, cada tramo de celdas que lo cruzan deja
+// una entrada (dos si el tramo es largo) y el túnel deja otra. Dentro de
+// cada cuadrado se guardan las distancias entre sus entradas (un BFS por
+// entrada, en paralelo por cuadrado). Una consulta conecta el origen y el
+// destino con las entradas de su cuadrado y hace A* sobre ese grafo, que
+// es mucho más chico que la grilla; el camino se refina a celdas solo si
+// se pide, y firstStep() refina únicamente el primer tramo.
+// Los caminos son casi óptimos (pasan por las entradas), no exactos.
+// Las consultas usan memoria auxiliar del objeto: uno por hilo.
+
+#include "mazegen.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+class HpaPathfinder {
+public:
+    HpaPathfinder(const ProceduralMaze &maze, int clusterSize, ThreadPool &pool);
+
+    // Largo del camino de from a to en pasos, o -1 si no hay
+    int distance(int from, int to);
+
+    // Camino de from a to, las dos incluidas; false si no hay
+    bool path(int from, int to, std::vector<int> &cells);
+
+    // Dirección del primer paso de from hacia to, o DIR_NONE
+    int firstStep(int from, int to);
+
+    int clusterCount() const { return clustersX * clustersY; }
+    int nodeCount() const { return static_cast<int>(nodeCell.size()); }
+    long long edgeCount() const;
+
+    // Nodos del grafo abstracto que miró la última consulta
+    int lastExpanded() const { return expanded; }
+
+private:
+    struct Edge {
+        int32_t to;
+        int32_t cost;
+    };
+
+    struct OpenNode {
+        int32_t f;
+        int32_t g;
+        int32_t node;
+    };
+
+    // BFS dentro de un cuadrado, con índices locales
+    struct ClusterSearch {
+        std::vector<int32_t> dist;
+        std::vector<int32_t> parent;
+        std::vector<int32_t> queue;
+    };
+
+    const ProceduralMaze &maze;
+    int size;
+    int clustersX, clustersY;
+
+    // Nodos agrupados por cuadrado: los de c son [clusterFirst[c],
+    // clusterFirst[c + 1])
+    std::vector<int32_t> nodeCell;
+    std::vector<int32_t> nodeX, nodeY, nodeCluster;
+    std::vector<int32_t> clusterFirst;
+    std::vector<std::vector<Edge>> edges;
+
+    // Auxiliares de las consultas
+    ClusterSearch fromSearch, toSearch, refineSearch;
+    std::vector<int32_t> gScore;
+    std::vector<int32_t> cameFrom;
+    std::vector<uint32_t> seen;
+    std::vector<OpenNode> openList; // montículo por f
+    uint32_t generation;
+    std::vector<int32_t> abstractPath;
+    int expanded;
+
+    int clusterOf(int cell) const;
+    int localIndex(int cluster, int cell) const;
+    void bfs(int cluster, int from, ClusterSearch &search) const;
+    void buildCluster(int cluster, ClusterSearch &search);
+
+    // A* abstracto: deja en abstractPath las celdas de paso de from a to
+    // (sin from, con to) y devuelve el largo, o -1
+    int search(int from, int to);
+    void appendSegment(int from, int to, std::vector<int> &cells);
+};
+
+#endif // HPAPATHFINDER_H
@@ -0,0 +1,37 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Últimas muestras de una latencia (en nanosegundos) y sus percentiles.
+// Guarda una ventana fija para que el overlay refleje lo reciente.
+class LatencyStats {
+public:
+    explicit LatencyStats(size_t window = 512) : samples(window, 0), next(0), count(0) {}
+
+    void add(int64_t ns) {
+        samples[next] = ns;
+        next = (next + 1) % samples.size();
+        if(count < samples.size()) count++;
+    }
+
+    size_t size() const { return count; }
+
+    // Percentil p (0..100) de la ventana; 0 si no hay muestras
+    int64_t percentile(double p) const {
+        if(count == 0) return 0;
+        std::vector<int64_t> sorted(samples.begin(), samples.begin() + count);
+        size_t k = static_cast<size_t>(p / 100.0 * (count - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        return sorted[k];
+    }
+
+private:
+    std::vector<int64_t> samples;
+    size_t next;
+    size_t count;
+};
+
+#endif // LATENCYSTATS_H
@@ -1,14 +1,202 @@
 #include <QApplication>
+#include <QElapsedTimer>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
 #include "game.h"
+#include "mazeview.h"
+#include "replay.h"
+#include "videoexport.h"
+
+namespace {
+
+// --replay archivo: vuelve a simular la grabación sin ventana y compara
+// el estado final con el grabado
+int runReplay(const char *path) {
+    Recording rec;
+    if(!rec.load(path)) {
+        std::fprintf(stderr, "no se pudo leer %s\n", path);
+        return 2;
+    }
+
+    ReplayResult result = replayRecording(rec);
+    bool match = result == rec.final;
+    std::printf("tick %lld score %d lives %d level %d: %s\n",
+                static_cast<long long>(result.tick), result.score, result.lives,
+                result.level, match ? "coincide" : "NO coincide");
+    if(!match) {
+        std::printf("esperado: tick %lld score %d lives %d level %d\n",
+                    static_cast<long long>(rec.final.tick), rec.final.score,
+                    rec.final.lives, rec.final.level);
+    }
+    return match ? 0 : 1;
+}
+
+// --video archivo: pinta la grabación sin ventana, a fps frames por
+// segundo, en PNG sueltos (--png dir) o en RGB24 crudo (--raw destino, -
+// para la salida estándar, listo para pasarle a ffmpeg). fps es un
+// múltiplo de Game::TICK_RATE: cada tick da fps / TICK_RATE frames.
+int runVideo(const char *path, const char *pngDir, const char *rawPath, int fps, int threads) {
+    Recording rec;
+    if(!rec.load(path)) {
+        std::fprintf(stderr, "no se pudo leer %s\n", path);
+        return 2;
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    const int framesPerTick = fps / Game::TICK_RATE;
+    VideoExporter exporter;
+    if(!exporter.load(rec, framesPerTick, QApplication::palette().color(QPalette::Window))) {
+        std::fprintf(stderr, "la grabación %s no se reproduce igual\n", path);
+        return 1;
+    }
+
+    bool ok;
+    if(pngDir) {
+        ok = exporter.writePng(QString::fromLocal8Bit(pngDir), threads);
+    } else {
+        bool toStdout = std::strcmp(rawPath, "-") == 0;
+        std::FILE *out = toStdout ? stdout : std::fopen(rawPath, "wb");
+        if(!out) {
+            std::fprintf(stderr, "no se pudo escribir %s\n", rawPath);
+            return 2;
+        }
+        ok = exporter.writeRaw(out, threads);
+        if(!toStdout) ok = std::fclose(out) == 0 && ok;
+    }
+    if(!ok) {
+        std::fprintf(stderr, "error al escribir el video\n");
+        return 2;
+    }
+
+    // Todo a stderr: stdout puede ser el propio video
+    const double seconds = elapsed.nsecsElapsed() / 1e9;
+    const double videoSeconds = static_cast<double>(exporter.frameCount()) /
+                                (framesPerTick * Game::TICK_RATE);
+    std::fprintf(stderr, "%d frames de %dx%d en %.2f s: %.0f frames/s, %.1fx tiempo real\n",
+                 exporter.frameCount(), exporter.frameSize().width(), exporter.frameSize().height(),
+                 seconds, exporter.frameCount() / seconds, videoSeconds / seconds);
+    if(rawPath) {
+        std::fprintf(stderr, "ffmpeg -f rawvideo -pix_fmt rgb24 -s %dx%d -r %d -i %s video.mp4\n",
+                     exporter.frameSize().width(), exporter.frameSize().height(),
+                     framesPerTick * Game::TICK_RATE, rawPath);
+    }
+    return 0;
+}
+
+}
 
 int main(int argc, char *argv[]) {
+    const char *replayPath = nullptr;
+    const char *recordPath = nullptr;
+    const char *capturePath = nullptr;
+    const char *viewPath = nullptr;
+    const char *joinAddress = nullptr;
+    const char *videoPath = nullptr;
+    const char *pngDir = nullptr;
+    const char *rawPath = nullptr;
+    int videoFps = Game::TICK_RATE;
+    int videoThreads = 0;
+    int hostPort = 0;
+    int loopbackLatency = -1;
+    int mazeSide = 0;
+    int inputDelay = 2;
+    uint64_t seed = 0;
+    for(int i = 1; i < argc; i++) {
+        // Todas las opciones llevan valor; lo que falte o no se conozca es
+        // un error antes de abrir nada
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(!value) {
+            std::fprintf(stderr, "falta el valor de %s\n", argv[i]);
+            return 2;
+        }
+        if(std::strcmp(argv[i], "--replay") == 0) replayPath = value;
+        else if(std::strcmp(argv[i], "--record") == 0) recordPath = value;
+        else if(std::strcmp(argv[i], "--capture") == 0) capturePath = value;
+        else if(std::strcmp(argv[i], "--view") == 0) viewPath = value;
+        else if(std::strcmp(argv[i], "--seed") == 0) seed = std::strtoull(value, nullptr, 10);
+        else if(std::strcmp(argv[i], "--host") == 0) hostPort = std::atoi(value);
+        else if(std::strcmp(argv[i], "--join") == 0) joinAddress = value;
+        else if(std::strcmp(argv[i], "--loopback") == 0) loopbackLatency = std::atoi(value);
+        else if(std::strcmp(argv[i], "--delay") == 0) inputDelay = std::atoi(value);
+        else if(std::strcmp(argv[i], "--video") == 0) videoPath = value;
+        else if(std::strcmp(argv[i], "--png") == 0) pngDir = value;
+        else if(std::strcmp(argv[i], "--raw") == 0) rawPath = value;
+        else if(std::strcmp(argv[i], "--fps") == 0) videoFps = std::atoi(value);
+        else if(std::strcmp(argv[i], "--threads") == 0) videoThreads = std::atoi(value);
+        else if(std::strcmp(argv[i], "--maze") == 0) mazeSide = std::atoi(value);
+        else {
+            std::fprintf(stderr, "opción desconocida: %s\n", argv[i]);
+            return 2;
+        }
+        i++;
+    }
+    if(replayPath) return runReplay(replayPath);
+    if(videoPath && !pngDir && !rawPath) {
+        std::fprintf(stderr, "--video necesita --png dir o --raw destino\n");
+        return 2;
+    }
+    if(videoPath && (videoFps <= 0 || videoFps % Game::TICK_RATE != 0)) {
+        std::fprintf(stderr, "--fps tiene que ser un múltiplo positivo de %d\n", Game::TICK_RATE);
+        return 2;
+    }
+
+    // Dos jugadores: --host PUERTO lleva a Pac-Man, --join HOST:PUERTO al
+    // fantasma; --loopback TICKS juega contra un fantasma simulado
+    std::unique_ptr<UdpLink> udp;
+    int localPlayer = RollbackSession::PLAYER_PACMAN;
+    if(hostPort > 0) {
+        udp.reset(new UdpLink);
+        if(!udp->host(hostPort)) {
+            std::fprintf(stderr, "no se pudo escuchar en el puerto %d\n", hostPort);
+            return 2;
+        }
+    } else if(joinAddress) {
+        std::string address = joinAddress;
+        size_t colon = address.rfind(':');
+        udp.reset(new UdpLink);
+        if(colon == std::string::npos ||
+           !udp->join(address.substr(0, colon).c_str(), std::atoi(address.c_str() + colon + 1))) {
+            std::fprintf(stderr, "no se pudo conectar con %s\n", joinAddress);
+            return 2;
+        }
+        localPlayer = RollbackSession::PLAYER_GHOST;
+    }
+
     // suprimir warning de session manager
     unsetenv("SESSION_MANAGER");
 
+    // Exportar no abre ventana, y la plataforma offscreen deja pintar los
+    // QPixmap desde los hilos del exportador
+    if(videoPath && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     QApplication app(argc, argv);
+    if(videoPath) return runVideo(videoPath, pngDir, rawPath, videoFps, videoThreads);
+
+    // --maze LADO: un laberinto procedural de LADO x LADO (21 a 4095, con
+    // --seed) mayor que la ventana, con la cámara siguiendo a Pac-Man
+    if(mazeSide > 0) {
+        MazeView view(mazeSide, seed ? seed : 1);
+        view.show();
+        return app.exec();
+    }
 
     // crear directamente el widget del juego
     Game game;
+    if(seed) game.setSeed(seed);
+    if(capturePath) game.startCapture(QString::fromLocal8Bit(capturePath));
+    if(udp) game.startNetplay(std::move(udp), localPlayer, inputDelay);
+    else if(loopbackLatency >= 0) game.startLoopback(loopbackLatency, inputDelay);
+    else if(recordPath) game.startRecording(QString::fromLocal8Bit(recordPath));
+    if(viewPath && !game.openReplay(QString::fromLocal8Bit(viewPath))) {
+        std::fprintf(stderr, "no se pudo abrir %s\n", viewPath);
+        return 2;
+    }
     game.show();
 
     return app.exec();
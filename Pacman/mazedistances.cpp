@@ -0,0 +1,84 @@
+#include "mazedistances.h"
+
+namespace {
+
+const int DIR_DX[4] = {1, 0, -1, 0};
+const int DIR_DY[4] = {0, 1, 0, -1};
+
+}
+
+MazeDistances::MazeDistances() : nodes(0) {
+    for(int c = 0; c < GRID_WIDTH * GRID_HEIGHT; c++) {
+        nodeOf[c] = -1;
+        nearest[c] = -1;
+        moves[c] = 0;
+        for(int d = 0; d < 4; d++) neighbours[c][d] = -1;
+    }
+}
+
+void MazeDistances::build(const Bitboard &walls) {
+    const int cells = GRID_WIDTH * GRID_HEIGHT;
+
+    // Numerar celdas transitables
+    nodes = 0;
+    for(int c = 0; c < cells; c++) {
+        nodeOf[c] = !walls.test(c) ? nodes++ : -1;
+    }
+
+    // Vecinos con túnel horizontal y máscara de movimientos legales
+    for(int c = 0; c < cells; c++) {
+        int x = c % GRID_WIDTH;
+        int y = c / GRID_WIDTH;
+        moves[c] = 0;
+        for(int d = 0; d < 4; d++) {
+            int nx = (x + DIR_DX[d] + GRID_WIDTH) % GRID_WIDTH;
+            int ny = y + DIR_DY[d];
+            int n = ny * GRID_WIDTH + nx;
+            bool ok = nodeOf[c] >= 0 && ny >= 0 && ny < GRID_HEIGHT && nodeOf[n] >= 0;
+            neighbours[c][d] = ok ? n : -1;
+            if(ok) moves[c] |= 1 << d;
+        }
+    }
+
+    // BFS desde cada celda
+    dist.assign(nodes * nodes, UNREACHABLE);
+    std::vector<int> queue(cells);
+    for(int src = 0; src < cells; src++) {
+        if(nodeOf[src] < 0) continue;
+        uint8_t *row = &dist[nodeOf[src] * nodes];
+        int head = 0, tail = 0;
+        queue[tail++] = src;
+        row[nodeOf[src]] = 0;
+        while(head < tail) {
+            int c = queue[head++];
+            int next = row[nodeOf[c]] + 1;
+            for(int d = 0; d < 4; d++) {
+                int n = neighbours[c][d];
+                if(n >= 0 && row[nodeOf[n]] == UNREACHABLE) {
+                    row[nodeOf[n]] = static_cast<uint8_t>(next);
+                    queue[tail++] = n;
+                }
+            }
+        }
+    }
+
+    // Celda transitable más cercana (euclídea) para cada celda
+    for(int c = 0; c < cells; c++) {
+        if(nodeOf[c] >= 0) {
+            nearest[c] = c;
+            continue;
+        }
+        int best = -1, bestD = 1 << 30;
+        for(int o = 0; o < cells; o++) {
+            if(nodeOf[o] < 0) continue;
+            int dx = o % GRID_WIDTH - c % GRID_WIDTH;
+            int dy = o / GRID_WIDTH - c / GRID_WIDTH;
+            int d2 = dx*dx + dy*dy;
+            if(d2 < bestD) {
+                bestD = d2;
+                best = o;
+            }
+        }
+        nearest[c] = best;
+    }
+}
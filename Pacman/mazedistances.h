@@ -0,0 +1,47 @@
+#ifndef MAZEDISTANCES_H
+#define MAZEDISTANCES_H
+
+#include "pacmandefs.h"
+#include "bitboard.h"
+#include <cstdint>
+#include <vector>
+
+// Distancias de camino más corto entre todos los pares de celdas
+// transitables del laberinto (con el túnel). Se calcula una vez con un
+// BFS desde cada celda y después cada consulta es una lectura de tabla.
+// Las celdas se identifican como y * GRID_WIDTH + x.
+class MazeDistances {
+public:
+    static constexpr uint8_t UNREACHABLE = 255;
+
+    MazeDistances();
+
+    void build(const Bitboard &walls);
+    bool isBuilt() const { return nodes > 0; }
+
+    bool walkable(int cell) const { return nodeOf[cell] >= 0; }
+    int walkableCount() const { return nodes; }
+
+    // Celda vecina en la dirección dada (con túnel), o -1 si es muro
+    int neighbour(int cell, int dir) const { return neighbours[cell][dir]; }
+
+    // Máscara de 4 bits con las direcciones legales desde la celda
+    int legalMoves(int cell) const { return moves[cell]; }
+
+    int distance(int fromCell, int toCell) const {
+        return dist[nodeOf[fromCell] * nodes + nodeOf[toCell]];
+    }
+
+    // Celda transitable más cercana (para objetivos que caen en un muro)
+    int nearestWalkable(int cell) const { return nearest[cell]; }
+
+private:
+    int nodes;
+    int16_t nodeOf[GRID_WIDTH * GRID_HEIGHT];
+    int16_t nearest[GRID_WIDTH * GRID_HEIGHT];
+    int16_t neighbours[GRID_WIDTH * GRID_HEIGHT][4];
+    uint8_t moves[GRID_WIDTH * GRID_HEIGHT];
+    std::vector<uint8_t> dist;
+};
+
+#endif // MAZEDISTANCES_H
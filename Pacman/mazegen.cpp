@@ -0,0 +1,239 @@
+#include "mazegen.h"
+#include "rng.h"
+#include "threadpool.h"
+#include <algorithm>
+
+namespace {
+
+const int DIR_STEP_X[4] = {1, 0, -1, 0};
+const int DIR_STEP_Y[4] = {0, 1, 0, -1};
+
+int oddSize(int size) {
+    size = std::max(ProceduralMaze::MIN_SIZE, std::min(size, ProceduralMaze::MAX_SIZE));
+    return size % 2 ? size : size - 1;
+}
+
+}
+
+ProceduralMaze::ProceduralMaze(int width, int height, uint64_t seed, ThreadPool &pool)
+    : w(oddSize(width)), h(oddSize(height)) {
+    latticeW = (w - 1) / 2;
+    latticeH = (h - 1) / 2;
+    regionsX = std::max(1, latticeW / REGION);
+    regionsY = std::max(1, latticeH / REGION);
+    hx = (w / 2 - 2) | 1;
+    hy = (h / 2 - 1) | 1;
+    walls.assign(static_cast<size_t>(w) * h, 1);
+
+    // Flujos de la semilla: uno por región para el backtracker, uno por
+    // borde entre regiones y otro por región para los callejones
+    const int regionCount = regionsX * regionsY;
+    for(int ry = 0; ry < regionsY; ry++) {
+        for(int rx = 0; rx < regionsX; rx++) {
+            uint32_t rng = streamSeed(seed, ry * regionsX + rx);
+            pool.submit([this, rx, ry, rng] { carveRegion(rx, ry, rng); });
+        }
+    }
+    pool.waitAll();
+
+    joinRegions(seed);
+    placeTunnels();
+    placeHouse();
+
+    for(int ry = 0; ry < regionsY; ry++) {
+        for(int rx = 0; rx < regionsX; rx++) {
+            uint32_t rng = streamSeed(seed, 3 * regionCount + ry * regionsX + rx);
+            pool.submit([this, rx, ry, rng] { braidRegion(rx, ry, rng); });
+        }
+    }
+    pool.waitAll();
+}
+
+int ProceduralMaze::regionEnd(int index, int regions, int lattice) const {
+    // La última región se queda con el resto
+    return index == regions - 1 ? lattice : (index + 1) * REGION;
+}
+
+bool ProceduralMaze::inHouseBox(int x, int y) const {
+    // Casa, sus muros y el pasillo que la rodea
+    return x >= hx - 2 && x <= hx + HOUSE_WIDTH + 1 && y >= hy - 2 && y <= hy + HOUSE_HEIGHT + 1;
+}
+
+bool ProceduralMaze::inHouse(int cell) const {
+    if(cell == doorCell()) return true;
+    int x = cell % w;
+    int y = cell / w;
+    return x >= hx && x < hx + HOUSE_WIDTH && y >= hy && y < hy + HOUSE_HEIGHT;
+}
+
+int ProceduralMaze::neighbour(int cell, int dir) const {
+    int x = cell % w + DIR_STEP_X[dir];
+    int y = cell / w + DIR_STEP_Y[dir];
+    if(y < 0 || y >= h) return -1;
+
+    // Túnel (wrap around)
+    if(x < 0) x = w - 1;
+    if(x >= w) x = 0;
+
+    int next = y * w + x;
+    return walls[next] ? -1 : next;
+}
+
+int ProceduralMaze::legalMoves(int cell) const {
+    int mask = 0;
+    for(int d = 0; d < 4; d++) {
+        if(neighbour(cell, d) >= 0) mask |= 1 << d;
+    }
+    return mask;
+}
+
+void ProceduralMaze::carveRegion(int rx, int ry, uint32_t rng) {
+    // Backtracker iterativo dentro de la región: pasillos largos y un
+    // único camino entre dos celdas (los ciclos se abren después)
+    const int x0 = regionStart(rx), x1 = regionEnd(rx, regionsX, latticeW);
+    const int y0 = regionStart(ry), y1 = regionEnd(ry, regionsY, latticeH);
+    const int nx = x1 - x0, ny = y1 - y0;
+
+    std::vector<uint8_t> visited(static_cast<size_t>(nx) * ny, 0);
+    std::vector<int> stack;
+    stack.reserve(nx * ny);
+
+    rng = xorshift32(rng);
+    int first = static_cast<int>(rng % (nx * ny));
+    visited[first] = 1;
+    stack.push_back(first);
+    walls[(2 * (y0 + first / nx) + 1) * w + 2 * (x0 + first % nx) + 1] = 0;
+
+    while(!stack.empty()) {
+        int local = stack.back();
+        int i = local % nx, j = local / nx;
+        int options[4];
+        int count = 0;
+        for(int d = 0; d < 4; d++) {
+            int ni = i + DIR_STEP_X[d], nj = j + DIR_STEP_Y[d];
+            if(ni < 0 || ni >= nx || nj < 0 || nj >= ny) continue;
+            if(!visited[nj * nx + ni]) options[count++] = d;
+        }
+        if(count == 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        rng = xorshift32(rng);
+        int d = options[rng % count];
+        int ni = i + DIR_STEP_X[d], nj = j + DIR_STEP_Y[d];
+        int x = 2 * (x0 + i) + 1, y = 2 * (y0 + j) + 1;
+        walls[(y + DIR_STEP_Y[d]) * w + x + DIR_STEP_X[d]] = 0;
+        walls[(y + 2 * DIR_STEP_Y[d]) * w + x + 2 * DIR_STEP_X[d]] = 0;
+        visited[nj * nx + ni] = 1;
+        stack.push_back(nj * nx + ni);
+    }
+}
+
+void ProceduralMaze::joinRegions(uint64_t seed) {
+    // Cada par de regiones vecinas se une por varios pasos al azar en su
+    // borde, uno cada 8 celdas de pasillo más o menos
+    const int regionCount = regionsX * regionsY;
+    int border = 0;
+    for(int ry = 0; ry < regionsY; ry++) {
+        for(int rx = 0; rx < regionsX; rx++) {
+            const int x1 = regionEnd(rx, regionsX, latticeW);
+            const int y1 = regionEnd(ry, regionsY, latticeH);
+            if(rx + 1 < regionsX) {
+                uint32_t rng = streamSeed(seed, regionCount + border++);
+                int span = y1 - regionStart(ry);
+                for(int k = 0; k < std::max(1, span / 8); k++) {
+                    rng = xorshift32(rng);
+                    int j = regionStart(ry) + static_cast<int>(rng % span);
+                    walls[(2 * j + 1) * w + 2 * x1] = 0;
+                }
+            }
+            if(ry + 1 < regionsY) {
+                uint32_t rng = streamSeed(seed, regionCount + border++);
+                int span = x1 - regionStart(rx);
+                for(int k = 0; k < std::max(1, span / 8); k++) {
+                    rng = xorshift32(rng);
+                    int i = regionStart(rx) + static_cast<int>(rng % span);
+                    walls[2 * y1 * w + 2 * i + 1] = 0;
+                }
+            }
+        }
+    }
+}
+
+void ProceduralMaze::placeTunnels() {
+    // Un túnel por fila de regiones, a media altura de cada una
+    for(int ry = 0; ry < regionsY; ry++) {
+        int j = (regionStart(ry) + regionEnd(ry, regionsY, latticeH)) / 2;
+        int y = 2 * j + 1;
+        walls[y * w] = 0;
+        walls[y * w + w - 1] = 0;
+        tunnels.push_back(y);
+    }
+}
+
+void ProceduralMaze::placeHouse() {
+    // La caja de la casa reemplaza lo que había: el pasillo de alrededor
+    // queda sobre celdas de pasillo, así que todo camino que entraba en la
+    // caja sigue llegando a él y el laberinto sigue conectado
+    for(int y = hy - 2; y <= hy + HOUSE_HEIGHT + 1; y++) {
+        for(int x = hx - 2; x <= hx + HOUSE_WIDTH + 1; x++) {
+            bool ring = x == hx - 2 || x == hx + HOUSE_WIDTH + 1 ||
+                        y == hy - 2 || y == hy + HOUSE_HEIGHT + 1;
+            bool inside = x >= hx && x < hx + HOUSE_WIDTH && y >= hy && y < hy + HOUSE_HEIGHT;
+            walls[y * w + x] = ring || inside ? 0 : 1;
+        }
+    }
+    walls[doorCell()] = 0;
+}
+
+void ProceduralMaze::braidRegion(int rx, int ry, uint32_t rng) {
+    // Cada callejón abre un muro hacia otra celda de la región, mejor si
+    // también es un callejón (así se arreglan dos de una vez). Una región
+    // de al menos 2x2 siempre tiene una: el paso que ya tenía gasta como
+    // mucho una de sus vecinas.
+    const int x0 = regionStart(rx), x1 = regionEnd(rx, regionsX, latticeW);
+    const int y0 = regionStart(ry), y1 = regionEnd(ry, regionsY, latticeH);
+
+    auto exits = [this](int x, int y) {
+        int count = 0;
+        for(int d = 0; d < 4; d++) count += !walls[(y + DIR_STEP_Y[d]) * w + x + DIR_STEP_X[d]];
+        return count;
+    };
+
+    for(int j = y0; j < y1; j++) {
+        for(int i = x0; i < x1; i++) {
+            int x = 2 * i + 1, y = 2 * j + 1;
+            if(inHouseBox(x, y) || exits(x, y) >= 2) continue;
+
+            int options[4], deadEnds[4];
+            int count = 0, deadCount = 0;
+            for(int d = 0; d < 4; d++) {
+                int ni = i + DIR_STEP_X[d], nj = j + DIR_STEP_Y[d];
+                if(ni < x0 || ni >= x1 || nj < y0 || nj >= y1) continue;
+                if(!walls[(y + DIR_STEP_Y[d]) * w + x + DIR_STEP_X[d]]) continue;
+                options[count++] = d;
+                int nx = 2 * ni + 1, ny = 2 * nj + 1;
+                if(!inHouseBox(nx, ny) && exits(nx, ny) == 1) deadEnds[deadCount++] = d;
+            }
+            if(count == 0) continue;
+
+            rng = xorshift32(rng);
+            int d = deadCount ? deadEnds[rng % deadCount] : options[rng % count];
+            walls[(y + DIR_STEP_Y[d]) * w + x + DIR_STEP_X[d]] = 0;
+        }
+    }
+}
+
+uint64_t ProceduralMaze::hash() const {
+    // FNV-1a sobre las medidas y los muros
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(static_cast<uint64_t>(w));
+    mix(static_cast<uint64_t>(h));
+    for(uint8_t wall : walls) mix(wall);
+    return hash;
+}
@@ -0,0 +1,92 @@
+#ifndef MAZEGEN_H
+#define MAZEGEN_H
+
+// Laberintos procedurales con semilla, de 21x21 hasta 4095x4095 celdas,
+// con las reglas del mapa normal: sin callejones sin salida, con túneles
+// en los bordes y con la casa de los fantasmas en el centro.
+//
+// Las celdas de pasillo están en las coordenadas impares y los muros
+// entre ellas en las pares. El laberinto se parte en regiones de
+// REGION x REGION celdas de pasillo y cada región genera el suyo en un
+// hilo del pool (backtracker con pila propia y su propio flujo de la
+// semilla); después se abren pasos entre regiones vecinas, se ponen los
+// túneles y la casa, y por último cada región abre un muro en cada
+// callejón, también en paralelo. Cada región solo escribe muros que tiene
+// por dentro, así que el resultado no depende de cuántos hilos haya.
+// Las celdas se identifican como y * width() + x.
+
+#include "pacmandefs.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+class ProceduralMaze {
+public:
+    static constexpr int MIN_SIZE = 21;
+    static constexpr int MAX_SIZE = 4095;
+    static constexpr int REGION = 32;
+
+    // Las medidas se ajustan a impares entre MIN_SIZE y MAX_SIZE
+    ProceduralMaze(int width, int height, uint64_t seed, ThreadPool &pool);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int cellCount() const { return w * h; }
+
+    bool isWall(int cell) const { return walls[cell] != 0; }
+    bool isWall(int x, int y) const { return walls[y * w + x] != 0; }
+    const std::vector<uint8_t> &wallData() const { return walls; }
+
+    // Puertas y muros que se rompen: cambia una celda en plena partida.
+    // Lo construido sobre el laberinto no se entera: un DistanceField se
+    // repara con wallChanged() y un HpaPathfinder hay que volver a armarlo.
+    void setWall(int cell, bool wall) { walls[cell] = wall ? 1 : 0; }
+
+    // Celda vecina en la dirección dada (con túnel), o -1 si es muro
+    int neighbour(int cell, int dir) const;
+
+    // Máscara de 4 bits con las direcciones legales desde la celda
+    int legalMoves(int cell) const;
+
+    // Casa de los fantasmas: interior de houseWidth() x houseHeight()
+    // desde (houseX(), houseY()) y la puerta encima, rodeada por un pasillo
+    int houseX() const { return hx; }
+    int houseY() const { return hy; }
+    int houseWidth() const { return HOUSE_WIDTH; }
+    int houseHeight() const { return HOUSE_HEIGHT; }
+    int doorCell() const { return (hy - 1) * w + hx + HOUSE_WIDTH / 2; }
+    bool inHouse(int cell) const;
+
+    // Salida de Pac-Man: el pasillo debajo de la casa
+    int pacmanStart() const { return (hy + HOUSE_HEIGHT + 1) * w + hx + HOUSE_WIDTH / 2; }
+
+    // Filas con túnel (la primera y la última celda se conectan)
+    const std::vector<int> &tunnelRows() const { return tunnels; }
+
+    // Huella del laberinto, para comparar generaciones
+    uint64_t hash() const;
+
+private:
+    static constexpr int HOUSE_WIDTH = 5;
+    static constexpr int HOUSE_HEIGHT = 3;
+
+    int w, h;
+    int latticeW, latticeH;      // celdas de pasillo por fila y columna
+    int regionsX, regionsY;
+    int hx, hy;
+    std::vector<uint8_t> walls;  // 1 = muro
+    std::vector<int> tunnels;
+
+    int regionStart(int index) const { return index * REGION; }
+    int regionEnd(int index, int regions, int lattice) const;
+    bool inHouseBox(int x, int y) const;
+
+    void carveRegion(int rx, int ry, uint32_t rng);
+    void joinRegions(uint64_t seed);
+    void placeTunnels();
+    void placeHouse();
+    void braidRegion(int rx, int ry, uint32_t rng);
+};
+
+#endif // MAZEGEN_H
@@ -0,0 +1,83 @@
+#include "mazegraph.h"
+
+MazeGraph::MazeGraph() {
+    for(int c = 0; c < CELL_COUNT; c++) {
+        junction[c] = false;
+        cellEdge[c] = -1;
+        cellOffset[c] = 0;
+        wrapping[c] = 0;
+        for(int d = 0; d < 4; d++) {
+            forced[c][d] = -1;
+            toJunction[c][d] = 0;
+        }
+    }
+}
+
+void MazeGraph::build(const MazeDistances &maze) {
+    nodes.clear();
+    edges.clear();
+
+    // Salida obligada con la misma regla que chooseGhostDirection y
+    // randomGhostDirection: las salidas legales sin media vuelta; si no
+    // hay ninguna, media vuelta
+    for(int c = 0; c < CELL_COUNT; c++) {
+        int moves = maze.walkable(c) ? maze.legalMoves(c) : 0;
+        int degree = __builtin_popcount(moves);
+        junction[c] = degree >= 3;
+        int x = c % GRID_WIDTH;
+        wrapping[c] = 0;
+        if(x == 0 && maze.neighbour(c, DIR_LEFT) >= 0) wrapping[c] |= 1 << DIR_LEFT;
+        if(x == GRID_WIDTH - 1 && maze.neighbour(c, DIR_RIGHT) >= 0) wrapping[c] |= 1 << DIR_RIGHT;
+        if(maze.walkable(c) && degree != 2) nodes.push_back(static_cast<int16_t>(c));
+        for(int d = 0; d < 4; d++) {
+            int reverse = (d + 2) % 4;
+            int options = moves & ~(1 << reverse);
+            int count = __builtin_popcount(options);
+            forced[c][d] = !maze.walkable(c) || count >= 2 ? -1
+                         : static_cast<int8_t>(count == 1 ? __builtin_ctz(options) : reverse);
+        }
+    }
+
+    // Pasos hasta el siguiente punto de decisión siguiendo las salidas
+    // obligadas (255 si no hay ninguno en ese sentido)
+    for(int c = 0; c < CELL_COUNT; c++) {
+        for(int d = 0; d < 4; d++) {
+            toJunction[c][d] = 0;
+            if(forced[c][d] < 0) continue;
+            int cell = c;
+            int dir = d;
+            int steps = 0;
+            while(forced[cell][dir] >= 0 && steps < 255) {
+                dir = forced[cell][dir];
+                cell = maze.neighbour(cell, dir);
+                steps++;
+                if(cell < 0) break;
+            }
+            toJunction[c][d] = static_cast<uint8_t>(cell < 0 ? 255 : steps);
+        }
+    }
+
+    // Aristas: desde cada nodo, un pasillo por salida hasta el nodo
+    // siguiente
+    for(int c = 0; c < CELL_COUNT; c++) cellEdge[c] = -1;
+    for(int16_t from : nodes) {
+        for(int d = 0; d < 4; d++) {
+            int cell = maze.neighbour(from, d);
+            if(cell < 0) continue;
+            int index = static_cast<int>(edges.size());
+            int dir = d;
+            int length = 1;
+            while(__builtin_popcount(maze.legalMoves(cell)) == 2 && length < CELL_COUNT) {
+                if(cellEdge[cell] < 0) {
+                    cellEdge[cell] = static_cast<int16_t>(index);
+                    cellOffset[cell] = static_cast<int16_t>(length);
+                }
+                dir = forced[cell][dir];
+                cell = maze.neighbour(cell, dir);
+                length++;
+            }
+            edges.push_back({from, static_cast<int16_t>(cell), static_cast<int8_t>(d),
+                             static_cast<int8_t>(dir), static_cast<int16_t>(length)});
+        }
+    }
+}
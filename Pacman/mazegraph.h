@@ -0,0 +1,65 @@
+#ifndef MAZEGRAPH_H
+#define MAZEGRAPH_H
+
+#include "mazedistances.h"
+#include <cstdint>
+#include <vector>
+
+// El laberinto compilado como grafo: los nodos son los cruces (tres o más
+// salidas) y los callejones sin salida, y cada arista es un pasillo entre
+// dos nodos con su largo en celdas. Dentro de un pasillo un fantasma solo
+// tiene una salida sin dar media vuelta, así que no hace falta decidir
+// nada hasta llegar al siguiente cruce.
+// Se construye una vez a partir de MazeDistances (con el túnel).
+class MazeGraph {
+public:
+    struct Edge {
+        int16_t from;     // celda del nodo de salida
+        int16_t to;       // celda del nodo de llegada
+        int8_t dir;       // dirección de salida desde from
+        int8_t arriveDir; // dirección con la que se llega a to
+        int16_t length;   // pasos de celda de from a to
+    };
+
+    MazeGraph();
+
+    void build(const MazeDistances &maze);
+    bool isBuilt() const { return !edges.empty(); }
+
+    // Celda donde un fantasma tiene que elegir camino
+    bool isJunction(int cell) const { return junction[cell]; }
+
+    // Dirección que toma en el centro de cell quien llega con dir cuando
+    // no hay nada que elegir (en un callejón, la media vuelta), o -1 en
+    // un cruce
+    int forcedDir(int cell, int dir) const { return forced[cell][dir]; }
+
+    // Pasos de celda desde el centro de cell, llegando con dir, hasta el
+    // centro del siguiente cruce; 0 si cell ya es un cruce
+    int junctionDistance(int cell, int dir) const { return toJunction[cell][dir]; }
+
+    int nodeCount() const { return static_cast<int>(nodes.size()); }
+    int edgeCount() const { return static_cast<int>(edges.size()); }
+    const Edge &edge(int i) const { return edges[i]; }
+
+    // Arista que recorre una celda de pasillo y cuántos pasos lleva desde
+    // su nodo de salida, o -1 en un nodo. Cada pasillo aparece dos veces,
+    // una por sentido; aquí se guarda el primero que se encontró.
+    int edgeOf(int cell) const { return cellEdge[cell]; }
+    int edgeOffset(int cell) const { return cellOffset[cell]; }
+
+    // Si al salir de cell con dir se pasa por el túnel al otro lado
+    bool wraps(int cell, int dir) const { return (wrapping[cell] >> dir) & 1; }
+
+private:
+    std::vector<int16_t> nodes;
+    std::vector<Edge> edges;
+    bool junction[CELL_COUNT];
+    int8_t forced[CELL_COUNT][4];
+    uint8_t toJunction[CELL_COUNT][4];
+    uint8_t wrapping[CELL_COUNT];
+    int16_t cellEdge[CELL_COUNT];
+    int16_t cellOffset[CELL_COUNT];
+};
+
+#endif // MAZEGRAPH_H
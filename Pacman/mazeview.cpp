@@ -0,0 +1,116 @@
+#include "mazeview.h"
+#include "game.h"
+#include "threadpool.h"
+#include <QPainter>
+
+MazeView::MazeView(int side, uint64_t seed, QWidget *parent)
+    : QWidget(parent), nextDir(DIR_NONE), clock(Game::TICK_RATE), lastNs(0), frame() {
+    {
+        // El pool solo hace falta para generar
+        ThreadPool pool;
+        game.reset(new ProceduralGame(side, seed, pool));
+    }
+
+    renderer.setup(palette().color(QPalette::Window), devicePixelRatioF());
+    frame.tickSeconds = clock.tickLength();
+    loadMap();
+    setFixedSize(renderer.width(), renderer.height());
+    setWindowTitle(QString("Pac-Man %1x%2").arg(game->maze().width()).arg(game->maze().height()));
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &MazeView::renderFrame);
+    timer->start(1000 / 60);
+    elapsed.start();
+}
+
+void MazeView::loadMap() {
+    // Mapa entero de nuevo (al empezar, al reiniciar o al pasar de nivel)
+    const GameState &s = game->state();
+    frame.state = s;
+    frame.prevPacmanPos = s.pacmanPos;
+    for(int i = 0; i < NUM_GHOSTS; i++) frame.prevGhostPos[i] = s.ghosts[i].pos;
+    renderer.setFrame(&frame, 1.0);
+    renderer.loadMaze(game->tiles(), s.pacmanPos);
+    lastActorRegion = QRegion();
+    update();
+}
+
+QRegion MazeView::simulateTick() {
+    const GameState &s = game->state();
+    frame.prevPacmanPos = s.pacmanPos;
+    for(int i = 0; i < NUM_GHOSTS; i++) frame.prevGhostPos[i] = s.ghosts[i].pos;
+    int level = s.level;
+
+    game->step(nextDir);
+    nextDir = DIR_NONE;
+    frame.state = s;
+    if(s.level != level) {
+        loadMap();
+        return QRegion();
+    }
+
+    QRegion changed;
+    const int width = game->maze().width();
+    for(int cell : game->changedCells()) {
+        int x = cell % width, y = cell / width;
+        changed += renderer.setCell(x, y, game->tiles().at(x, y));
+    }
+    return changed;
+}
+
+void MazeView::renderFrame() {
+    qint64 now = elapsed.nsecsElapsed();
+    int ticks = clock.advance((now - lastNs) / 1e9);
+    lastNs = now;
+
+    QRegion changed;
+    for(int t = 0; t < ticks; t++) changed += simulateTick();
+    renderer.setFrame(&frame, clock.alpha());
+    renderer.followPacman();
+    scheduleRepaint(changed);
+}
+
+void MazeView::scheduleRepaint(const QRegion &changedCells) {
+    // Como Game::scheduleRepaint(): toda la vista si la cámara se movió,
+    // si no solo los actores, el HUD y las celdas que cambiaron
+    if(frame.state.gameOver) {
+        update();
+        return;
+    }
+    if(renderer.viewOrigin() != paintedOrigin) {
+        paintedOrigin = renderer.viewOrigin();
+        renderer.dropHiddenChunks();
+        lastActorRegion = renderer.actorRegion();
+        update();
+        return;
+    }
+    QRegion current = renderer.actorRegion();
+    update(lastActorRegion + current + renderer.hudRect() + changedCells);
+    lastActorRegion = current;
+}
+
+void MazeView::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    painter.setClipRegion(event->region());
+    renderer.drawMap(painter);
+    renderer.drawPacman(painter);
+    renderer.drawGhosts(painter);
+    renderer.drawUI(painter);
+}
+
+void MazeView::keyPressEvent(QKeyEvent *event) {
+    switch(event->key()) {
+    case Qt::Key_Left:  nextDir = DIR_LEFT; break;
+    case Qt::Key_Right: nextDir = DIR_RIGHT; break;
+    case Qt::Key_Up:    nextDir = DIR_UP; break;
+    case Qt::Key_Down:  nextDir = DIR_DOWN; break;
+    case Qt::Key_R:
+        game->reset();
+        nextDir = DIR_NONE;
+        clock.reset();
+        loadMap();
+        break;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef MAZEVIEW_H
+#define MAZEVIEW_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QPaintEvent>
+#include <QElapsedTimer>
+#include <QRegion>
+#include "proceduralgame.h"
+#include "fixedclock.h"
+#include "gamerenderer.h"
+#include <memory>
+
+// Vista Qt de una partida en un laberinto procedural grande (--maze): el
+// mapa es mayor que la ventana y la cámara sigue a Pac-Man por él. A
+// diferencia de Game no hay hilo de simulación, red ni grabaciones: los
+// ticks se simulan en el timer de dibujo con un FixedClock y el dibujo es
+// el mismo GameRenderer, con el laberinto cargado en lugar del tablero.
+class MazeView : public QWidget {
+    Q_OBJECT
+
+public:
+    // Genera el laberinto de side x side celdas (ajustado a impar)
+    MazeView(int side, uint64_t seed, QWidget *parent = nullptr);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private slots:
+    void renderFrame();
+
+private:
+    std::unique_ptr<ProceduralGame> game;
+    int nextDir;
+    FixedClock clock;
+    QElapsedTimer elapsed;
+    qint64 lastNs;
+
+    GameRenderer renderer;
+    GameRenderer::Frame frame;
+    QTimer *timer;
+    QPoint paintedOrigin;
+    QRegion lastActorRegion;
+
+    void loadMap();
+    QRegion simulateTick();
+    void scheduleRepaint(const QRegion &changedCells);
+};
+
+#endif // MAZEVIEW_H
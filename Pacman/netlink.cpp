@@ -0,0 +1,125 @@
+#include "netlink.h"
+#include "rng.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+UdpLink::UdpLink() : fd(-1), hasPeer(false), peerSize(0) {
+    std::memset(&peer, 0, sizeof(peer));
+}
+
+UdpLink::~UdpLink() {
+    if(fd >= 0) ::close(fd);
+}
+
+bool UdpLink::openSocket(int family, int port) {
+    fd = ::socket(family, SOCK_DGRAM, 0);
+    if(fd < 0) return false;
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    sockaddr_storage local;
+    std::memset(&local, 0, sizeof(local));
+    socklen_t size;
+    if(family == AF_INET6) {
+        sockaddr_in6 *a = reinterpret_cast<sockaddr_in6 *>(&local);
+        a->sin6_family = AF_INET6;
+        a->sin6_addr = in6addr_any;
+        a->sin6_port = htons(static_cast<uint16_t>(port));
+        size = sizeof(sockaddr_in6);
+    } else {
+        sockaddr_in *a = reinterpret_cast<sockaddr_in *>(&local);
+        a->sin_family = AF_INET;
+        a->sin_addr.s_addr = htonl(INADDR_ANY);
+        a->sin_port = htons(static_cast<uint16_t>(port));
+        size = sizeof(sockaddr_in);
+    }
+    return ::bind(fd, reinterpret_cast<sockaddr *>(&local), size) == 0;
+}
+
+bool UdpLink::host(int port) {
+    return openSocket(AF_INET, port);
+}
+
+bool UdpLink::join(const char *address, int port) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *found = nullptr;
+    char service[16];
+    std::snprintf(service, sizeof(service), "%d", port);
+    if(::getaddrinfo(address, service, &hints, &found) != 0 || !found) return false;
+
+    bool ok = openSocket(found->ai_family, 0);
+    if(ok) {
+        std::memcpy(&peer, found->ai_addr, found->ai_addrlen);
+        peerSize = found->ai_addrlen;
+        hasPeer = true;
+    }
+    ::freeaddrinfo(found);
+    return ok;
+}
+
+void UdpLink::send(const uint8_t *data, size_t size) {
+    if(fd < 0 || !hasPeer) return;
+    // Si el buffer del sistema está lleno se pierde: ya se reenviará
+    ::sendto(fd, data, size, 0, reinterpret_cast<const sockaddr *>(&peer), peerSize);
+}
+
+int UdpLink::receive(uint8_t *data, size_t capacity) {
+    if(fd < 0) return -1;
+    sockaddr_storage from;
+    socklen_t fromSize = sizeof(from);
+    ssize_t n = ::recvfrom(fd, data, capacity, 0, reinterpret_cast<sockaddr *>(&from), &fromSize);
+    if(n < 0) return -1;
+    if(!hasPeer) {
+        peer = from;
+        peerSize = fromSize;
+        hasPeer = true;
+    }
+    return static_cast<int>(n);
+}
+
+LoopbackLink::LoopbackLink()
+    : other(nullptr), frame(0), latency(0), jitter(0), loss(0), rng(1) {}
+
+void LoopbackLink::connect(LoopbackLink &a, LoopbackLink &b) {
+    a.other = &b;
+    b.other = &a;
+}
+
+void LoopbackLink::setConditions(int latencyFrames, int jitterFrames, int lossPercent, uint32_t seed) {
+    latency = latencyFrames;
+    jitter = jitterFrames;
+    loss = lossPercent;
+    rng = streamSeed(seed, 0);
+}
+
+void LoopbackLink::send(const uint8_t *data, size_t size) {
+    if(!other) return;
+    rng = xorshift32(rng);
+    if(static_cast<int>(rng % 100) < loss) return;
+
+    int delay = latency;
+    if(jitter > 0) {
+        rng = xorshift32(rng);
+        delay += static_cast<int>(rng % (jitter + 1));
+    }
+    // La entrega se mide con el reloj del otro extremo; con variación los
+    // paquetes pueden llegar desordenados, igual que en UDP
+    other->inbox.push_back({other->frame + delay, std::vector<uint8_t>(data, data + size)});
+}
+
+int LoopbackLink::receive(uint8_t *data, size_t capacity) {
+    for(auto it = inbox.begin(); it != inbox.end(); ++it) {
+        if(it->deliverAt > frame) continue;
+        size_t n = it->bytes.size() < capacity ? it->bytes.size() : capacity;
+        std::memcpy(data, it->bytes.data(), n);
+        inbox.erase(it);
+        return static_cast<int>(n);
+    }
+    return -1;
+}
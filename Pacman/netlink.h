@@ -0,0 +1,79 @@
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <sys/socket.h>
+#include <vector>
+
+// Transporte de datagramas para el modo a dos jugadores. No garantiza
+// entrega ni orden: el protocolo de RollbackSession ya reenvía las
+// entradas que el otro lado no ha confirmado.
+class NetLink {
+public:
+    virtual ~NetLink() {}
+
+    virtual void send(const uint8_t *data, size_t size) = 0;
+
+    // Copia el siguiente paquete recibido y devuelve su tamaño, o -1 si no
+    // hay ninguno pendiente. Nunca bloquea.
+    virtual int receive(uint8_t *data, size_t capacity) = 0;
+};
+
+// UDP sin bloqueo. El anfitrión escucha en un puerto y aprende la
+// dirección del otro jugador con el primer paquete que le llega; el que se
+// une conoce la dirección desde el principio.
+class UdpLink : public NetLink {
+public:
+    UdpLink();
+    ~UdpLink() override;
+
+    bool host(int port);
+    bool join(const char *address, int port);
+
+    void send(const uint8_t *data, size_t size) override;
+    int receive(uint8_t *data, size_t capacity) override;
+
+private:
+    int fd;
+    bool hasPeer;
+    sockaddr_storage peer;
+    socklen_t peerSize;
+
+    bool openSocket(int family, int port);
+};
+
+// Par de enlaces en memoria, con latencia, variación y pérdida simuladas
+// en frames. Sirve para probar el rollback sin red.
+class LoopbackLink : public NetLink {
+public:
+    LoopbackLink();
+
+    static void connect(LoopbackLink &a, LoopbackLink &b);
+
+    // Latencia y variación en frames, pérdida en tanto por ciento
+    void setConditions(int latencyFrames, int jitterFrames, int lossPercent, uint32_t seed);
+
+    // Un frame más de reloj simulado para este extremo
+    void advanceFrame() { frame++; }
+
+    void send(const uint8_t *data, size_t size) override;
+    int receive(uint8_t *data, size_t capacity) override;
+
+private:
+    struct Packet {
+        long long deliverAt;
+        std::vector<uint8_t> bytes;
+    };
+
+    LoopbackLink *other;
+    std::deque<Packet> inbox;
+    long long frame;
+    int latency;
+    int jitter;
+    int loss;
+    uint32_t rng;
+};
+
+#endif // NETLINK_H
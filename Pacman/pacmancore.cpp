@@ -0,0 +1,687 @@
+#include "pacmancore.h"
+#include "ghostai.h"
+#include "rng.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Ticks que cruise() simula de una vez como mucho: un choque a mitad del
+// tramo obliga a deshacer lo que Pac-Man hizo después
+const long long CRUISE_WINDOW = 48;
+
+const int DIR_DX[4] = {1, 0, -1, 0};
+const int DIR_DY[4] = {0, 1, 0, -1};
+
+const int32_t WORLD_WIDTH = GRID_WIDTH * SUBCELL;
+
+// Las posiciones son enteras: sumar distance de una vez es lo mismo que
+// sumar los pasos uno a uno
+Vec2 offset(Vec2 pos, int dir, long long distance) {
+    return {pos.x + static_cast<int32_t>(DIR_DX[dir] * distance),
+            pos.y + static_cast<int32_t>(DIR_DY[dir] * distance)};
+}
+
+// Túnel (wrap around): al salir por un lado se aparece en el centro de la
+// celda del otro
+int32_t wrapX(int32_t x) {
+    if(x < 0) return WORLD_WIDTH - HALF_CELL;
+    if(x >= WORLD_WIDTH) return HALF_CELL;
+    return x;
+}
+
+bool jumped(Vec2 from, Vec2 to) {
+    return std::abs(to.x - from.x) > SUBCELL || std::abs(to.y - from.y) > SUBCELL;
+}
+
+// Punto a phase/256 del recorrido de from a to (to si fue un salto)
+Vec2 partWay(Vec2 from, Vec2 to, int phase) {
+    if(jumped(from, to)) return to;
+    return {from.x + (to.x - from.x) * phase / 256, from.y + (to.y - from.y) * phase / 256};
+}
+
+}
+
+PacmanCore::PacmanCore() : ghostPolicy(nullptr), difficulty(ARCADE_DIFFICULTY) {
+    reset();
+}
+
+void PacmanCore::reset(uint64_t seed) {
+    s.score = 0;
+    s.lives = 3;
+    s.gameOver = false;
+    s.frightenedTimer = 0;
+    s.mouthAngle = 0;
+    s.level = 1;
+    s.tick = 0;
+    s.seed = seed;
+    s.pacmanSpeed = difficulty.pacmanSpeed;
+    s.frightenedTicks = difficulty.frightenedTicks;
+    s.ghostWander = difficulty.ghostWander;
+    s.nextDir = DIR_RIGHT;
+    s.humanGhost = -1;
+    s.ghostNextDir = DIR_NONE;
+
+    resetActors();
+    initMap();
+
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        s.ghosts[i].rng = streamSeed(seed, i);
+    }
+}
+
+void PacmanCore::resetActors() {
+    s.ghostMode = MODE_SCATTER;
+    s.levelTick = 0;
+    s.frightenedTimer = 0;
+
+    // Inicializar Pac-Man
+    s.pacmanPos = cellCentre(9, 15);
+    s.pacmanDir = DIR_RIGHT;
+
+    // Inicializar fantasmas
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        const GhostSpawn &spawn = GHOST_SPAWNS[i];
+        GhostState &ghost = s.ghosts[i];
+        ghost.pos = cellCentre(spawn.x, spawn.y);
+        ghost.dir = spawn.dir;
+        ghost.scared = false;
+    }
+
+    // Todos quietos hasta el primer tick
+    pacmanFrom = s.pacmanPos;
+    turnPhase = 0;
+    for(int i = 0; i < NUM_GHOSTS; i++) ghostFrom[i] = s.ghosts[i].pos;
+}
+
+void PacmanCore::nextLevel() {
+    // Nivel completado: se rellena el mapa y los actores vuelven a su sitio
+    s.level++;
+    resetActors();
+    loadLevelMap(s);
+}
+
+void PacmanCore::initMap() {
+    loadLevelMap(s);
+
+    if(!maze.isBuilt()) {
+        maze.build(s.walls);
+        graph.build(maze);
+    }
+}
+
+void PacmanCore::loadLevelMap(GameState &state) {
+    // Mapa simplificado (1=muro, 2=punto, 3=power pellet)
+    static const int tempMap[GRID_HEIGHT][GRID_WIDTH] = {
+        {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+        {1,2,2,2,2,2,2,2,2,1,2,2,2,2,2,2,2,2,1},
+        {1,3,1,1,2,1,1,1,2,1,2,1,1,1,2,1,1,3,1},
+        {1,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,1},
+        {1,2,1,1,2,1,2,1,1,1,1,1,2,1,2,1,1,2,1},
+        {1,2,2,2,2,1,2,2,2,1,2,2,2,1,2,2,2,2,1},
+        {1,1,1,1,2,1,1,1,0,1,0,1,1,1,2,1,1,1,1},
+        {1,1,1,1,2,1,0,0,0,0,0,0,0,1,2,1,1,1,1},
+        {1,1,1,1,2,1,0,1,1,0,1,1,0,1,2,1,1,1,1},
+        {0,0,0,0,2,0,0,1,0,0,0,1,0,0,2,0,0,0,0},
+        {1,1,1,1,2,1,0,1,1,1,1,1,0,1,2,1,1,1,1},
+        {1,1,1,1,2,1,0,0,0,0,0,0,0,1,2,1,1,1,1},
+        {1,1,1,1,2,1,0,1,1,1,1,1,0,1,2,1,1,1,1},
+        {1,2,2,2,2,2,2,2,2,1,2,2,2,2,2,2,2,2,1},
+        {1,2,1,1,2,1,1,1,2,1,2,1,1,1,2,1,1,2,1},
+        {1,3,2,1,2,2,2,2,2,2,2,2,2,2,2,1,2,3,1},
+        {1,1,2,1,2,1,2,1,1,1,1,1,2,1,2,1,2,1,1},
+        {1,2,2,2,2,1,2,2,2,1,2,2,2,1,2,2,2,2,1},
+        {1,2,1,1,1,1,1,1,2,1,2,1,1,1,1,1,1,2,1},
+        {1,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,1},
+        {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}
+    };
+
+    state.walls.clearAll();
+    state.dots.clearAll();
+    state.powers.clearAll();
+    for(int i = 0; i < GRID_HEIGHT; i++) {
+        for(int j = 0; j < GRID_WIDTH; j++) {
+            int c = i * GRID_WIDTH + j;
+            switch(tempMap[i][j]) {
+            case CELL_WALL:  state.walls.set(c); break;
+            case CELL_DOT:   state.dots.set(c); break;
+            case CELL_POWER: state.powers.set(c); break;
+            }
+        }
+    }
+}
+
+int PacmanCore::cellOf(Vec2 pos) {
+    return (pos.y >> SUBCELL_SHIFT) * GRID_WIDTH + (pos.x >> SUBCELL_SHIFT);
+}
+
+void PacmanCore::step(int input, int ghostInput, int inputPhase) {
+    if(s.gameOver) return;
+
+    // Una dirección fuera de rango indexaría las tablas: cuenta como ninguna
+    if(input < DIR_NONE || input > DIR_UP) input = DIR_NONE;
+    if(ghostInput < DIR_NONE || ghostInput > DIR_UP) ghostInput = DIR_NONE;
+    if(inputPhase < 0 || inputPhase > 255) inputPhase = 0;
+
+    // Sin cambio de dirección no hay nada que adelantar
+    if(input == DIR_NONE || input == s.nextDir) inputPhase = 0;
+    if(input != DIR_NONE) s.nextDir = input;
+    if(ghostInput != DIR_NONE) s.ghostNextDir = ghostInput;
+
+    pacmanFrom = s.pacmanPos;
+    turnPhase = 0;
+    movePacman(inputPhase);
+    moveGhosts();
+    checkCollisions();
+    updateFrightened();
+
+    s.tick++;
+    s.levelTick++;
+
+    if(!s.gameOver && s.dots.empty() && s.powers.empty()) nextLevel();
+}
+
+void PacmanCore::updateFrightened() {
+    if(s.frightenedTimer > 0) {
+        s.frightenedTimer--;
+        if(s.frightenedTimer == 0) {
+            for(auto &ghost : s.ghosts) {
+                ghost.scared = false;
+            }
+        }
+    }
+}
+
+long long PacmanCore::advance(long long maxTicks) {
+    // Lo que impide saltar (Pac-Man pegado a un fantasma, un fantasma en
+    // la boca del túnel, el fantasma humano) suele durar varios ticks:
+    // tras cada intento fallido se espera el doble antes de volver a mirar
+    long long done = 0;
+    int backoff = 0;
+    int firstCentre[NUM_GHOSTS];
+    while(done < maxTicks && !s.gameOver) {
+        long long quiet = quietTicks(firstCentre);
+        quiet = std::min(quiet, std::min(maxTicks - done, CRUISE_WINDOW));
+        if(quiet > 0) quiet = cruise(quiet, firstCentre);
+        if(quiet > 0) {
+            done += quiet;
+            backoff = 0;
+            continue;
+        }
+        backoff = std::min(backoff * 2 + 1, 8);
+        for(int t = 0; t < backoff && done < maxTicks && !s.gameOver; t++) {
+            step();
+            done++;
+        }
+    }
+    return done;
+}
+
+int PacmanCore::centrePeriod() const {
+    // Ticks entre dos centros de celda seguidos para quien acaba de
+    // ajustarse a uno: el n con |n * speed - SUBCELL| < speed / 2 (7 a 0.15)
+    return (SUBCELL + s.pacmanSpeed / 2) / s.pacmanSpeed;
+}
+
+int PacmanCore::ticksToCentre(const GhostState &ghost) const {
+    // Distancia en línea recta al centro que le toca (el de su celda si no
+    // lo pasó por más de half) y comprobación con la misma cuenta de
+    // moveGhosts(); si no coincide, se busca tick a tick
+    const int speed = s.pacmanSpeed;
+    const int half = speed / 2;
+    int along = DIR_DX[ghost.dir] * ((ghost.pos.x & (SUBCELL - 1)) - HALF_CELL) +
+                DIR_DY[ghost.dir] * ((ghost.pos.y & (SUBCELL - 1)) - HALF_CELL);
+    int ahead = along < half ? -along : SUBCELL - along;
+    int t = ahead < half ? 0 : (ahead - half) / speed + 1;
+    if(atCentre(offset(ghost.pos, ghost.dir, t * speed)) &&
+       (t == 0 || !atCentre(offset(ghost.pos, ghost.dir, (t - 1) * speed)))) {
+        return t;
+    }
+    int limit = centrePeriod() + 1;
+    for(t = 0; t <= limit; t++) {
+        if(atCentre(offset(ghost.pos, ghost.dir, t * speed))) return t;
+    }
+    return -1;
+}
+
+long long PacmanCore::quietTicks(int firstCentre[NUM_GHOSTS]) const {
+    // El fantasma humano decide en cualquier centro de celda y una
+    // política puede decidir cualquier cosa en cada cruce
+    if(s.gameOver || s.humanGhost >= 0 || ghostPolicy) return 0;
+
+    // Cambio de modo (todos dan media vuelta)
+    if(ghostModeAt(s.levelTick) != s.ghostMode) return 0;
+    long long quiet = ticksToModeChange(s.levelTick);
+    if(quiet < 0) quiet = 1LL << 40;
+
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        const GhostState &ghost = s.ghosts[i];
+        firstCentre[i] = -1;
+        int cell = cellOf(ghost.pos);
+        long long wait = GHOST_SPAWNS[i].releaseTick - s.levelTick;
+        if(inGhostHouse(cell) && wait > 0) {
+            // Esperando en la casa: quieto hasta su salida, y si está en el
+            // centro de la celda ese mismo tick decide
+            Vec2 centre = ghost.pos;
+            if(!snapToCentre(centre) || centre.x != ghost.pos.x || centre.y != ghost.pos.y) {
+                quiet = std::min(quiet, wait);
+            }
+            firstCentre[i] = static_cast<int>(std::min(wait, 1LL << 30));
+            continue;
+        }
+
+        // Tick en que pasa por el siguiente centro de celda; si antes salta
+        // por el túnel, tick a tick
+        firstCentre[i] = ticksToCentre(ghost);
+        if(firstCentre[i] < 0) return 0;
+        if(graph.wraps(cell, ghost.dir)) {
+            int32_t x = offset(ghost.pos, ghost.dir, firstCentre[i] * s.pacmanSpeed).x;
+            if(x < 0 || x >= WORLD_WIDTH) return 0;
+        }
+    }
+
+    // Fin de nivel: como mucho se come un punto por tick. Cada palabra no
+    // vacía tiene al menos uno, así que casi nunca hace falta contarlos.
+    int words = 0;
+    for(int w = 0; w < Bitboard::WORDS; w++) words += (s.dots.words[w] | s.powers.words[w]) != 0;
+    if(words - 1 < quiet) quiet = std::min<long long>(quiet, s.dotsRemaining() - 1);
+    return std::max(quiet, 0LL);
+}
+
+long long PacmanCore::cruise(long long ticks, const int firstCentre[NUM_GHOSTS]) {
+    // step() repetido sin lo que quietTicks() descarta (cambios de modo,
+    // fin de nivel). Pac-Man va tick a tick (gira, come puntos, se para en
+    // los muros, cruza el túnel) y deja su posición de cada tick; cada
+    // fantasma salta de centro en centro, en un pasillo con la salida
+    // obligada y en un cruce con la misma decisión que moveGhosts()
+    // tomaría en ese tick. Lo que step() resolvería de otra forma (un
+    // power pellet, un choque, un fantasma que entra en el túnel o en la
+    // casa antes de tiempo) acorta el tramo hasta ese tick y se repite.
+    // Devuelve los ticks avanzados; 0 si el primero ya no se puede saltar.
+    const GameState start = s;
+    long long end = ticks;
+    trailStart = s.pacmanPos;
+
+    pacmanTrail.resize(end);
+    long long moved = 0;
+    while(moved < end) {
+        int score = s.score;
+        movePacman(0);
+        int cell = cellOf(s.pacmanPos);
+        pacmanTrail[moved++] = {s.pacmanPos, s.pacmanDir, s.mouthAngle, s.score != score ? cell : -1};
+        if(start.powers.test(cell)) end = moved - 1;
+    }
+
+    // Deshace lo que Pac-Man hizo desde el tick stop
+    auto rewind = [&](long long stop) {
+        for(long long t = stop; t < moved; t++) {
+            int cell = pacmanTrail[t].eaten;
+            if(cell < 0) continue;
+            if(start.powers.test(cell)) {
+                s.powers.set(cell);
+                s.score -= 50;
+                s.frightenedTimer = start.frightenedTimer;
+                for(int i = 0; i < NUM_GHOSTS; i++) s.ghosts[i] = start.ghosts[i];
+            } else {
+                s.dots.set(cell);
+                s.score -= 10;
+            }
+        }
+        s.pacmanPos = stop > 0 ? pacmanTrail[stop - 1].pos : start.pacmanPos;
+        s.pacmanDir = stop > 0 ? pacmanTrail[stop - 1].dir : start.pacmanDir;
+        s.mouthAngle = stop > 0 ? pacmanTrail[stop - 1].mouthAngle : start.mouthAngle;
+        moved = stop;
+    };
+    if(moved > end) rewind(end);
+    if(end == 0) return 0;
+
+    // Cada fantasma hasta el primer tick que haya que dejar a step(); los
+    // que llegaron más lejos se repiten hasta ahí
+    GhostState ghosts[NUM_GHOSTS];
+    long long reached[NUM_GHOSTS];
+    blinkyCentres.clear();
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        ghosts[i] = s.ghosts[i];
+        reached[i] = end;
+        end = cruiseGhost(i, ghosts[i], end, firstCentre[i]);
+    }
+    if(end == 0) {
+        rewind(0);
+        return 0;
+    }
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        if(reached[i] == end) continue;
+        if(i == BLINKY) blinkyCentres.clear();
+        ghosts[i] = s.ghosts[i];
+        cruiseGhost(i, ghosts[i], end, firstCentre[i]);
+    }
+    if(moved > end) rewind(end);
+    for(int i = 0; i < NUM_GHOSTS; i++) s.ghosts[i] = ghosts[i];
+
+    if(s.frightenedTimer > 0) {
+        if(s.frightenedTimer <= end) {
+            s.frightenedTimer = 0;
+            for(auto &ghost : s.ghosts) ghost.scared = false;
+        } else {
+            s.frightenedTimer -= static_cast<int>(end);
+        }
+    }
+    s.tick += end;
+    s.levelTick += end;
+    return end;
+}
+
+long long PacmanCore::cruiseGhost(int i, GhostState &ghost, long long end, int firstCentre) {
+    // Deja en ghost su estado tras end ticks y devuelve end, o el primer
+    // tick que hay que dejar a step()
+    const int speed = s.pacmanSpeed;
+    const int period = centrePeriod();
+
+    // Recorrido de Pac-Man en el tick t del tramo, contra el del fantasma
+    auto touches = [&](long long t, Vec2 from, Vec2 to) {
+        return sweptContact(t > 0 ? pacmanTrail[t - 1].pos : trailStart, pacmanTrail[t].pos,
+                            from, to);
+    };
+
+    // Ticks de from a to (sin incluirlo) recorriendo un tramo recto desde
+    // pos a step por tick: el primero donde toca a Pac-Man, o -1
+    auto contact = [&](Vec2 pos, int dir, long long from, long long to, int step) -> long long {
+        for(long long t = from; t < to; t++) {
+            if(touches(t, offset(pos, dir, (t - from) * step), offset(pos, dir, (t - from + 1) * step))) {
+                return t;
+            }
+        }
+        return -1;
+    };
+
+    // Hasta el primer centro sigue recto, o quieto si espera en la casa
+    bool waiting = inGhostHouse(cellOf(ghost.pos)) && s.levelTick < GHOST_SPAWNS[i].releaseTick;
+    int step = waiting ? 0 : speed;
+    long long t = std::min<long long>(firstCentre, end);
+    long long hit = contact(ghost.pos, ghost.dir, 0, t, step);
+    if(hit >= 0) return hit;
+    if(t == end) {
+        ghost.pos = offset(ghost.pos, ghost.dir, end * step);
+        return end;
+    }
+
+    long long scaredTicks = ghost.scared ? s.frightenedTimer : 0;
+    int dir = ghost.dir;
+    int cell = cellOf(offset(ghost.pos, dir, t * step));
+    for(;;) {
+        int forced = graph.forcedDir(cell, dir);
+        if(t < scaredTicks) {
+            ghost.rng = xorshift32(ghost.rng);
+            dir = forced >= 0 ? forced : randomGhostDirection(maze, cell, dir, ghost.rng);
+        } else if(forced >= 0) {
+            dir = forced;
+        } else if(wanders(ghost.rng)) {
+            dir = randomGhostDirection(maze, cell, dir, ghost.rng);
+        } else {
+            const PacmanAt &pacman = pacmanTrail[t];
+            int target = ghostTargetCell(i, s.ghostMode, cell, cellOf(pacman.pos), pacman.dir,
+                                         blinkyCellAt(t), maze);
+            dir = chooseGhostDirection(maze, cell, dir, target);
+        }
+        if(i == BLINKY) blinkyCentres.push_back({t, cell, dir});
+
+        Vec2 centre = cellCentre(cell % GRID_WIDTH, cell / GRID_WIDTH);
+        long long next = std::min(t + period, end);
+        hit = graph.wraps(cell, dir) ? -1 : contact(centre, dir, t, next, speed);
+        if(hit >= 0) return hit;
+
+        // La casa cerrada se deja a step(), desde el tick siguiente al
+        // centro (aún no salió de la celda)
+        int to = maze.neighbour(cell, dir);
+        bool blocked = inGhostHouse(to) && s.levelTick + t < GHOST_SPAWNS[i].releaseTick;
+        if(blocked && t + 1 < end) return t + 1;
+
+        // Por el túnel va tick a tick hasta el salto, que lo deja en el
+        // centro de la celda del otro lado: decide en el tick siguiente
+        if(graph.wraps(cell, dir) && !blocked) {
+            Vec2 pos = centre;
+            for(next = t; next < end; next++) {
+                Vec2 from = pos;
+                pos = getNextPos(pos, dir);
+                if(touches(next, from, pos)) return next;
+                if(cellOf(pos) == to) break;
+            }
+            if(next + 1 >= end) {
+                ghost.pos = pos;
+                ghost.dir = dir;
+                return end;
+            }
+            cell = to;
+            t = next + 1;
+            continue;
+        }
+
+        if(next == end || blocked) {
+            ghost.pos = offset(centre, dir, (end - t) * speed);
+            ghost.dir = dir;
+            return end;
+        }
+        cell = to;
+        t = next;
+    }
+}
+
+int PacmanCore::blinkyCellAt(long long t) const {
+    // Celda de Blinky al empezar el tick t del tramo, antes de moverse
+    const GhostState &blinky = s.ghosts[BLINKY];
+    bool waiting = inGhostHouse(cellOf(blinky.pos)) && s.levelTick < GHOST_SPAWNS[BLINKY].releaseTick;
+    Vec2 pos = blinky.pos;
+    int dir = blinky.dir;
+    int step = waiting ? 0 : s.pacmanSpeed;
+    long long from = 0;
+    auto last = std::lower_bound(blinkyCentres.begin(), blinkyCentres.end(), t,
+                                 [](const CentreEvent &e, long long tick) { return e.tick < tick; });
+    if(last != blinkyCentres.begin()) {
+        const CentreEvent &e = *(last - 1);
+        pos = cellCentre(e.cell % GRID_WIDTH, e.cell / GRID_WIDTH);
+        dir = e.dir;
+        from = e.tick;
+        step = s.pacmanSpeed;
+    }
+    // Saliendo por el túnel ya saltó al otro lado
+    pos = offset(pos, dir, (t - from) * step);
+    pos.x = wrapX(pos.x);
+    return cellOf(pos);
+}
+
+Vec2 PacmanCore::getNextPos(Vec2 pos, int dir) const {
+    Vec2 next = pos;
+    switch(dir) {
+    case DIR_RIGHT: next.x += s.pacmanSpeed; break;
+    case DIR_DOWN:  next.y += s.pacmanSpeed; break;
+    case DIR_LEFT:  next.x -= s.pacmanSpeed; break;
+    case DIR_UP:    next.y -= s.pacmanSpeed; break;
+    }
+    next.x = wrapX(next.x);
+    return next;
+}
+
+bool PacmanCore::canMove(Vec2 pos, int dir) const {
+    // Dentro de la misma celda siempre se puede avanzar; al cruzar a la
+    // vecina basta con la máscara de direcciones legales de la celda
+    int from = cellOf(pos);
+    if(cellOf(getNextPos(pos, dir)) == from) return true;
+    return (maze.legalMoves(from) >> dir) & 1;
+}
+
+void PacmanCore::movePacman(int inputPhase) {
+    // La parte del tick anterior a la tecla, en la dirección que llevaba
+    Vec2 start = s.pacmanPos;
+    int before = s.pacmanSpeed * inputPhase / 256;
+    if(before > 0) {
+        advancePacman(before);
+        pacmanTurn = s.pacmanPos;
+        turnPhase = inputPhase;
+    }
+
+    // Intentar cambiar dirección
+    if(s.nextDir != s.pacmanDir && canMove(s.pacmanPos, s.nextDir)) {
+        s.pacmanDir = s.nextDir;
+    }
+
+    // Mover en la dirección actual
+    advancePacman(s.pacmanSpeed - before);
+    if(s.pacmanPos.x != start.x || s.pacmanPos.y != start.y) {
+        s.mouthAngle = (s.mouthAngle + 5) % 60;
+    }
+
+    // Comer puntos
+    eatDot(cellOf(s.pacmanPos));
+}
+
+void PacmanCore::advancePacman(int distance) {
+    // Igual que getNextPos/canMove pero con un tramo arbitrario
+    Vec2 next = s.pacmanPos;
+    switch(s.pacmanDir) {
+    case DIR_RIGHT: next.x += distance; break;
+    case DIR_DOWN:  next.y += distance; break;
+    case DIR_LEFT:  next.x -= distance; break;
+    case DIR_UP:    next.y -= distance; break;
+    }
+    next.x = wrapX(next.x);
+
+    int from = cellOf(s.pacmanPos);
+    if(cellOf(next) != from && !((maze.legalMoves(from) >> s.pacmanDir) & 1)) return;
+    s.pacmanPos = next;
+}
+
+void PacmanCore::eatDot(int cell) {
+    if(s.dots.test(cell)) {
+        s.dots.reset(cell);
+        s.score += 10;
+    } else if(s.powers.test(cell)) {
+        s.powers.reset(cell);
+        s.score += 50;
+        s.frightenedTimer = s.frightenedTicks;
+        for(auto &ghost : s.ghosts) {
+            // Al asustarse dan media vuelta
+            if(!ghost.scared) ghost.dir = (ghost.dir + 2) % 4;
+            ghost.scared = true;
+        }
+    }
+}
+
+void PacmanCore::moveGhosts() {
+    // Cambio de dispersión a persecución (o al revés): media vuelta
+    int mode = ghostModeAt(s.levelTick);
+    bool reverse = mode != s.ghostMode;
+    s.ghostMode = mode;
+
+    int pacmanCell = cellOf(s.pacmanPos);
+    int blinkyCell = cellOf(s.ghosts[BLINKY].pos);
+
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        GhostState &ghost = s.ghosts[i];
+        int cell = cellOf(ghost.pos);
+        ghostFrom[i] = ghost.pos;
+
+        // Esperando su turno para salir de la casa
+        if(inGhostHouse(cell) && s.levelTick < GHOST_SPAWNS[i].releaseTick) continue;
+
+        // El fantasma humano no obedece a los cambios de modo y puede dar
+        // media vuelta en cualquier momento, como Pac-Man
+        bool human = i == s.humanGhost && !inGhostHouse(cell);
+        if(reverse && !human) ghost.dir = (ghost.dir + 2) % 4;
+        if(human && s.ghostNextDir == (ghost.dir + 2) % 4) ghost.dir = s.ghostNextDir;
+
+        // Solo se decide en el centro de la celda, y en un pasillo no hay
+        // nada que decidir (el asustado gasta igual su número aleatorio)
+        if(snapToCentre(ghost.pos)) {
+            int forced = graph.forcedDir(cell, ghost.dir);
+            int chosen = DIR_NONE;
+            if(ghostPolicy && !human && forced < 0) {
+                chosen = ghostPolicy->decide(s, i, cell, ghost.rng);
+                if(chosen < DIR_RIGHT || chosen > DIR_UP || maze.neighbour(cell, chosen) < 0) {
+                    chosen = DIR_NONE;
+                }
+            }
+            if(human) {
+                // Gira si puede; si no, sigue recto y en un muro se para
+                if(s.ghostNextDir != DIR_NONE && maze.neighbour(cell, s.ghostNextDir) >= 0) {
+                    ghost.dir = s.ghostNextDir;
+                }
+            } else if(chosen != DIR_NONE) {
+                ghost.dir = chosen;
+            } else if(ghost.scared) {
+                ghost.rng = xorshift32(ghost.rng);
+                ghost.dir = forced >= 0 ? forced
+                                        : randomGhostDirection(maze, cell, ghost.dir, ghost.rng);
+            } else if(forced >= 0) {
+                ghost.dir = forced;
+            } else if(wanders(ghost.rng)) {
+                ghost.dir = randomGhostDirection(maze, cell, ghost.dir, ghost.rng);
+            } else {
+                int target = ghostTargetCell(i, s.ghostMode, cell, pacmanCell,
+                                             s.pacmanDir, blinkyCell, maze);
+                ghost.dir = chooseGhostDirection(maze, cell, ghost.dir, target);
+            }
+        }
+
+        ghostFrom[i] = ghost.pos;
+        if(canMove(ghost.pos, ghost.dir)) {
+            ghost.pos = getNextPos(ghost.pos, ghost.dir);
+        }
+    }
+}
+
+bool PacmanCore::wanders(uint32_t &rng) const {
+    // Sin ghostWander no se gasta ningún número: la partida arcade no cambia
+    if(s.ghostWander <= 0) return false;
+    rng = xorshift32(rng);
+    return static_cast<int>(rng >> 24) < s.ghostWander;
+}
+
+bool PacmanCore::atCentre(Vec2 pos) const {
+    // A menos de medio paso del centro en los dos ejes (exacto: todo entero)
+    int fx = (pos.x & (SUBCELL - 1)) - HALF_CELL;
+    int fy = (pos.y & (SUBCELL - 1)) - HALF_CELL;
+    return 2 * std::abs(fx) < s.pacmanSpeed && 2 * std::abs(fy) < s.pacmanSpeed;
+}
+
+bool PacmanCore::snapToCentre(Vec2 &pos) const {
+    if(!atCentre(pos)) return false;
+    pos = {(pos.x & ~(SUBCELL - 1)) + HALF_CELL, (pos.y & ~(SUBCELL - 1)) + HALF_CELL};
+    return true;
+}
+
+void PacmanCore::checkCollisions() {
+    // A lo largo de todo el tick, no solo al final: si no, dos actores que
+    // van uno hacia el otro pueden cruzarse entre dos ticks sin tocarse
+    // (más fácil cuanto más avanzan por tick). Con un giro a mitad de tick
+    // el recorrido de Pac-Man son dos tramos.
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        GhostState &ghost = s.ghosts[i];
+        bool hit;
+        if(turnPhase > 0) {
+            Vec2 middle = partWay(ghostFrom[i], ghost.pos, turnPhase);
+            hit = sweptContact(pacmanFrom, pacmanTurn, ghostFrom[i], middle) ||
+                  sweptContact(pacmanTurn, s.pacmanPos, middle, ghost.pos);
+        } else {
+            hit = sweptContact(pacmanFrom, s.pacmanPos, ghostFrom[i], ghost.pos);
+        }
+        if(hit) {
+            if(ghost.scared) {
+                // Fantasma comido: vuelve a la casa
+                s.score += 200;
+                ghost.pos = cellCentre(GHOST_HOUSE_X, GHOST_HOUSE_Y);
+                ghost.dir = DIR_UP;
+                ghost.scared = false;
+            } else {
+                s.lives--;
+                if(s.lives <= 0) {
+                    s.gameOver = true;
+                } else {
+                    // Para los fantasmas que faltan, quieto en la salida
+                    s.pacmanPos = cellCentre(9, 15);
+                    pacmanFrom = s.pacmanPos;
+                    turnPhase = 0;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,240 @@
+#ifndef PACMANCORE_H
+#define PACMANCORE_H
+
+// Núcleo de simulación de Pac-Man sin dependencias de Qt.
+// Todo el estado vive en structs planos y se avanza con step(input),
+// así se puede simular sin ventana ni QTimer.
+
+#include "pacmandefs.h"
+#include "bitboard.h"
+#include "mazedistances.h"
+#include "mazegraph.h"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// En unidades de SUBCELL
+struct Vec2 {
+    int32_t x;
+    int32_t y;
+};
+
+inline Vec2 cellCentre(int x, int y) {
+    return {x * SUBCELL + HALF_CELL, y * SUBCELL + HALF_CELL};
+}
+
+// Parámetros de dificultad. reset() los copia al estado, así que una
+// partida (y sus instantáneas) siempre lleva los suyos.
+struct Difficulty {
+    int pacmanSpeed;     // unidades de SUBCELL por tick, también de los fantasmas
+    int frightenedTicks; // lo que dura el susto de un power pellet
+    int ghostWander;     // de 256: chance de que un fantasma no asustado
+                         // elija al azar en un cruce en lugar de su objetivo
+};
+const Difficulty ARCADE_DIFFICULTY = {PACMAN_SPEED, 100, 0};
+
+struct GhostState {
+    Vec2 pos;
+    int dir;
+    bool scared;
+    uint32_t rng; // flujo aleatorio propio del fantasma
+};
+
+struct GameState {
+    // Mapa en bitboards: muros, puntos y power pellets
+    Bitboard walls;
+    Bitboard dots;
+    Bitboard powers;
+
+    // Pac-Man
+    Vec2 pacmanPos;
+    int pacmanDir;
+    int nextDir;
+    int pacmanSpeed; // unidades de SUBCELL por tick
+    int mouthAngle;
+
+    // Fantasmas
+    GhostState ghosts[NUM_GHOSTS];
+    int humanGhost;   // fantasma que mueve un jugador, o -1 si ninguno
+    int ghostNextDir; // dirección pedida por ese jugador
+
+    // Estado del juego
+    int score;
+    int lives;
+    bool gameOver;
+    int frightenedTimer;
+    int frightenedTicks; // valor inicial de frightenedTimer
+    int ghostWander;     // como en Difficulty
+    int ghostMode;
+    int level;
+    long long levelTick; // ticks desde que empezó el nivel
+    long long tick;
+    uint64_t seed;
+
+    // Contenido de la celda (x, y) como Cell
+    int cellAt(int x, int y) const {
+        int c = y * GRID_WIDTH + x;
+        if(walls.test(c)) return CELL_WALL;
+        if(dots.test(c)) return CELL_DOT;
+        if(powers.test(c)) return CELL_POWER;
+        return CELL_EMPTY;
+    }
+
+    int dotsRemaining() const { return dots.count() + powers.count(); }
+};
+
+// Decide por los fantasmas en los cruces en lugar de las reglas arcade
+// (objetivo por modo, al azar si están asustados). Las reglas de siempre
+// siguen igual: media vuelta al cambiar de modo, salida de la casa, el
+// fantasma humano y los pasillos sin otra salida.
+class GhostPolicy {
+public:
+    virtual ~GhostPolicy() {}
+
+    // Dirección del fantasma ghost, en el centro de la celda cell de un
+    // cruce. rng es el flujo propio del fantasma, para que la partida
+    // siga dependiendo solo de la semilla. Una dirección sin salida se
+    // ignora y decide la regla arcade.
+    virtual int decide(const GameState &state, int ghost, int cell, uint32_t &rng) = 0;
+};
+
+class PacmanCore {
+public:
+    PacmanCore();
+
+    // Reinicia partida y mapa. La semilla fija todos los números
+    // aleatorios de la partida.
+    void reset(uint64_t seed = 1);
+
+    // Avanza un tick. input es la dirección pedida o DIR_NONE para
+    // conservar la última (igual que nextDir en el juego con ventana).
+    // ghostInput hace lo mismo para el fantasma humano, si lo hay.
+    // inputPhase (0..255, en 1/256 de tick) es qué parte del tick ya había
+    // pasado cuando llegó input: Pac-Man recorre esa parte en la dirección
+    // anterior y gira justo ahí, en lugar de al principio o al final del tick.
+    // Valores fuera de rango cuentan como DIR_NONE (y fase 0).
+    void step(int input = DIR_NONE, int ghostInput = DIR_NONE, int inputPhase = 0);
+
+    // Avanza hasta maxTicks ticks sin entradas nuevas, con el mismo
+    // resultado que llamar a step() esas veces. Entre eventos (choque,
+    // power pellet, cambio de modo, fin de nivel) los fantasmas saltan de
+    // centro en centro por el grafo de pasillos y solo deciden en los
+    // cruces; Pac-Man sigue yendo tick a tick. Devuelve los ticks que
+    // avanzó (menos si termina la partida).
+    long long advance(long long maxTicks);
+
+    const GameState &state() const { return s; }
+    GameState &state() { return s; }
+
+    bool canMove(Vec2 pos, int dir) const;
+    Vec2 getNextPos(Vec2 pos, int dir) const;
+
+    const MazeDistances &distances() const { return maze; }
+    const MazeGraph &mazeGraph() const { return graph; }
+
+    static int cellOf(Vec2 pos);
+
+    // Se aplica desde el siguiente reset() (ARCADE_DIFFICULTY por defecto).
+    // Recording la guarda (formato v4) y replayRecording y VideoExporter la
+    // aplican antes de reset(); PacmanBatch solo juega la arcade.
+    void setDifficulty(const Difficulty &d) { difficulty = d; }
+
+    // nullptr vuelve a las reglas arcade. La política no es parte del
+    // estado: no la copian instantáneas ni grabaciones. Con una política
+    // advance() va tick a tick.
+    void setGhostPolicy(GhostPolicy *policy) { ghostPolicy = policy; }
+
+    // Contacto en algún momento del tick entre Pac-Man, que va de a0 a a1,
+    // y un fantasma que va de b0 a b1, los dos en línea recta y al mismo
+    // ritmo. Un salto de más de una celda (túnel, muerte, fantasma comido)
+    // no es un recorrido: de ese actor solo cuenta dónde termina.
+    // Está en el encabezado para que PacmanBatch lo pueda expandir en su
+    // bucle de choques.
+    static bool sweptContact(Vec2 a0, Vec2 a1, Vec2 b0, Vec2 b1);
+
+    // Mapa inicial de un nivel
+    static void loadLevelMap(GameState &state);
+
+private:
+    // bench/pacmanbench.cpp mide cada fase del tick por separado
+    friend class PacmanBench;
+
+    GameState s;
+    GhostPolicy *ghostPolicy;
+    Difficulty difficulty;
+
+    // Tablas de distancias y grafo de pasillos (el laberinto es fijo: se
+    // calculan una vez)
+    MazeDistances maze;
+    MazeGraph graph;
+
+    // Auxiliares de cruise(): Pac-Man al final de cada tick del tramo y
+    // los centros por los que pasó Blinky (Inky apunta según los dos)
+    struct PacmanAt {
+        Vec2 pos;
+        int dir;
+        int mouthAngle;
+        int eaten; // celda del punto que se comió en ese tick, o -1
+    };
+    struct CentreEvent {
+        long long tick;
+        int cell;
+        int dir;
+    };
+    std::vector<PacmanAt> pacmanTrail;
+    Vec2 trailStart; // Pac-Man antes del primer tick del tramo
+    std::vector<CentreEvent> blinkyCentres;
+
+    // Recorrido de cada actor en el tick en curso, para checkCollisions():
+    // Pac-Man de pacmanFrom a su posición pasando por pacmanTurn (donde
+    // giró, a turnPhase/256 del tick; 0 si no hubo giro a mitad de tick)
+    // y cada fantasma desde donde decidió, ya ajustado al centro
+    Vec2 pacmanFrom;
+    Vec2 pacmanTurn;
+    int turnPhase;
+    Vec2 ghostFrom[NUM_GHOSTS];
+
+    void initMap();
+    void resetActors();
+    void nextLevel();
+    void movePacman(int inputPhase);
+    void advancePacman(int distance);
+    void moveGhosts();
+    bool wanders(uint32_t &rng) const;
+    bool atCentre(Vec2 pos) const;
+    bool snapToCentre(Vec2 &pos) const;
+    void checkCollisions();
+    void updateFrightened();
+    int centrePeriod() const;
+    int ticksToCentre(const GhostState &ghost) const;
+    long long quietTicks(int firstCentre[NUM_GHOSTS]) const;
+    long long cruise(long long ticks, const int firstCentre[NUM_GHOSTS]);
+    long long cruiseGhost(int i, GhostState &ghost, long long end, int firstCentre);
+    int blinkyCellAt(long long t) const;
+    void eatDot(int cell);
+};
+
+inline bool PacmanCore::sweptContact(Vec2 a0, Vec2 a1, Vec2 b0, Vec2 b1) {
+    // Ninguno recorre más de una celda: lejos al final, lejos todo el tick
+    const int32_t far = HALF_CELL + 2 * SUBCELL;
+    if(std::abs(a1.x - b1.x) >= far || std::abs(a1.y - b1.y) >= far) return false;
+
+    if(std::abs(a1.x - a0.x) > SUBCELL || std::abs(a1.y - a0.y) > SUBCELL) a0 = a1;
+    if(std::abs(b1.x - b0.x) > SUBCELL || std::abs(b1.y - b0.y) > SUBCELL) b0 = b1;
+
+    // Distancia relativa d(t) = d + t * v con t en [0, 1]; se tocan si su
+    // mínimo está a menos de media celda
+    int64_t dx = a0.x - b0.x, dy = a0.y - b0.y;
+    int64_t vx = (a1.x - a0.x) - (b1.x - b0.x), vy = (a1.y - a0.y) - (b1.y - b0.y);
+
+    // Todo entero y sin dividir: con el mínimo en t = -(d·v)/(v·v), la
+    // condición |d|² - (d·v)²/(v·v) < r² se multiplica por v·v
+    const int64_t r2 = int64_t(HALF_CELL) * HALF_CELL;
+    int64_t dv = dx * vx + dy * vy;
+    int64_t vv = vx * vx + vy * vy;
+    if(dv >= 0) return dx*dx + dy*dy < r2;                        // se alejan
+    if(-dv >= vv) return (dx + vx)*(dx + vx) + (dy + vy)*(dy + vy) < r2; // al final
+    return (dx*dx + dy*dy) * vv - dv * dv < r2 * vv;
+}
+
+#endif // PACMANCORE_H
@@ -0,0 +1,27 @@
+#ifndef PACMANDEFS_H
+#define PACMANDEFS_H
+
+// Constantes compartidas por el núcleo, las tablas del laberinto y la vista
+
+// Configuración del juego
+const int GRID_WIDTH = 19;
+const int GRID_HEIGHT = 21;
+const int NUM_GHOSTS = 4;
+const int CELL_COUNT = GRID_WIDTH * GRID_HEIGHT;
+
+// Posiciones de los actores en punto fijo: SUBCELL unidades por celda, con
+// el centro de la celda x en x * SUBCELL + HALF_CELL. El movimiento es solo
+// aritmética entera, así que una partida da el mismo resultado con
+// cualquier compilador y nivel de optimización.
+const int SUBCELL_SHIFT = 12;
+const int SUBCELL = 1 << SUBCELL_SHIFT;
+const int HALF_CELL = SUBCELL / 2;
+const int PACMAN_SPEED = 614; // unidades por tick (0.15 celdas)
+
+// Contenido de una celda del mapa
+enum Cell { CELL_EMPTY = 0, CELL_WALL = 1, CELL_DOT = 2, CELL_POWER = 3 };
+
+// Direcciones (0=derecha, 1=abajo, 2=izquierda, 3=arriba)
+enum Direction { DIR_NONE = -1, DIR_RIGHT = 0, DIR_DOWN = 1, DIR_LEFT = 2, DIR_UP = 3 };
+
+#endif // PACMANDEFS_H
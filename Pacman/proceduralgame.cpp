@@ -0,0 +1,288 @@
+#include "proceduralgame.h"
+#include "rng.h"
+#include <cstdlib>
+
+namespace {
+
+const int DIR_DX[4] = {1, 0, -1, 0};
+const int DIR_DY[4] = {0, 1, 0, -1};
+
+}
+
+ProceduralGame::ProceduralGame(int side, uint64_t seed, ThreadPool &pool)
+    : layout(side, side, seed, pool), home(layout, {layout.doorCell()}), s(), dotsLeft(0),
+    doorsX(0), doorRng(0), toggles(0) {
+    worldWidth = layout.width() * SUBCELL;
+    s.seed = seed;
+    placeDoors(seed);
+    reset();
+}
+
+void ProceduralGame::placeDoors(uint64_t seed) {
+    // Un hueco entre dos celdas de pasillo (x + y impar) por bloque, dentro
+    // del borde y lejos de la casa y de la salida de Pac-Man
+    const int w = layout.width(), h = layout.height();
+    const int centreX = layout.houseX() + layout.houseWidth() / 2;
+    const int centreY = layout.houseY() + layout.houseHeight() / 2;
+    doorsX = (w + DOOR_SPACING - 1) / DOOR_SPACING;
+    const int doorsY = (h + DOOR_SPACING - 1) / DOOR_SPACING;
+    doors.assign(static_cast<size_t>(doorsX) * doorsY, -1);
+
+    uint32_t rng = streamSeed(seed, NUM_GHOSTS + 1);
+    for(int by = 0; by < doorsY; by++) {
+        for(int bx = 0; bx < doorsX; bx++) {
+            rng = xorshift32(rng);
+            int x = bx * DOOR_SPACING + static_cast<int>(rng % DOOR_SPACING);
+            int y = by * DOOR_SPACING + static_cast<int>((rng >> 8) % DOOR_SPACING);
+            if((x + y) % 2 == 0) x += x + 1 < w - 1 ? 1 : -1;
+            if(x < 1 || x > w - 2 || y < 1 || y > h - 2) continue;
+            if(std::abs(x - centreX) < layout.houseWidth() + 3 &&
+               std::abs(y - centreY) < layout.houseHeight() + 3) {
+                continue;
+            }
+            doors[by * doorsX + bx] = y * w + x;
+        }
+    }
+}
+
+void ProceduralGame::reset() {
+    s.score = 0;
+    s.lives = 3;
+    s.gameOver = false;
+    s.level = 1;
+    s.tick = 0;
+    s.pacmanSpeed = PACMAN_SPEED;
+    s.frightenedTicks = ARCADE_DIFFICULTY.frightenedTicks;
+    s.ghostWander = GHOST_WANDER;
+    s.nextDir = DIR_LEFT;
+    s.humanGhost = -1;
+    s.ghostNextDir = DIR_NONE;
+    for(int i = 0; i < NUM_GHOSTS; i++) s.ghosts[i].rng = streamSeed(s.seed, i);
+    doorRng = streamSeed(s.seed, NUM_GHOSTS);
+
+    fillMap();
+    resetActors();
+}
+
+void ProceduralGame::fillMap() {
+    map = ChunkedMaze(layout);
+    dotsLeft = 0;
+    for(int y = 0; y < map.height(); y++) {
+        for(int x = 0; x < map.width(); x++) {
+            uint8_t cell = map.at(x, y);
+            dotsLeft += cell == CELL_DOT || cell == CELL_POWER;
+        }
+    }
+    changed.clear();
+}
+
+Vec2 ProceduralGame::ghostStart(int ghost) const {
+    // Repartidos por el pasillo de encima de la casa, que es todo abierto
+    return cellCentre(layout.houseX() - 1 + 2 * ghost, layout.houseY() - 2);
+}
+
+void ProceduralGame::resetActors() {
+    s.frightenedTimer = 0;
+    s.levelTick = 0;
+    s.pacmanPos = cellCentre(layout.pacmanStart() % layout.width(),
+                             layout.pacmanStart() / layout.width());
+    s.pacmanDir = DIR_LEFT;
+    pacmanFrom = s.pacmanPos;
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        GhostState &ghost = s.ghosts[i];
+        ghost.pos = ghostStart(i);
+        ghost.dir = i % 2 ? DIR_RIGHT : DIR_LEFT;
+        ghost.scared = false;
+        returning[i] = false;
+        ghostFrom[i] = ghost.pos;
+    }
+}
+
+int ProceduralGame::cellOf(Vec2 pos) const {
+    return (pos.y >> SUBCELL_SHIFT) * layout.width() + (pos.x >> SUBCELL_SHIFT);
+}
+
+bool ProceduralGame::atCentre(Vec2 pos) const {
+    // Igual que en PacmanCore: a menos de medio paso del centro
+    int fx = (pos.x & (SUBCELL - 1)) - HALF_CELL;
+    int fy = (pos.y & (SUBCELL - 1)) - HALF_CELL;
+    return 2 * std::abs(fx) < s.pacmanSpeed && 2 * std::abs(fy) < s.pacmanSpeed;
+}
+
+bool ProceduralGame::advance(Vec2 &pos, int dir, int distance) const {
+    // Dentro de la celda siempre se avanza; para pasar a la vecina tiene
+    // que haber paso. Por el túnel se aparece en el centro de la celda del
+    // otro lado.
+    Vec2 next = {pos.x + DIR_DX[dir] * distance, pos.y + DIR_DY[dir] * distance};
+    if(next.x < 0) next.x = worldWidth - HALF_CELL;
+    else if(next.x >= worldWidth) next.x = HALF_CELL;
+
+    int from = cellOf(pos);
+    if(cellOf(next) != from && layout.neighbour(from, dir) < 0) return false;
+    pos = next;
+    return true;
+}
+
+void ProceduralGame::step(int input) {
+    changed.clear();
+    if(s.gameOver) return;
+    if(input >= DIR_RIGHT && input <= DIR_UP) s.nextDir = input;
+
+    movePacman();
+    moveGhosts();
+    checkCollisions();
+
+    if(s.frightenedTimer > 0 && --s.frightenedTimer == 0) {
+        for(int i = 0; i < NUM_GHOSTS; i++) s.ghosts[i].scared = returning[i];
+    }
+    s.tick++;
+    s.levelTick++;
+    if(s.tick % DOOR_PERIOD == 0) toggleDoor();
+
+    if(!s.gameOver && dotsLeft == 0) {
+        // Nivel completado: el mismo laberinto lleno otra vez
+        s.level++;
+        fillMap();
+        resetActors();
+    }
+}
+
+void ProceduralGame::toggleDoor() {
+    // Una de las puertas de los 3x3 bloques alrededor de Pac-Man, para que
+    // se vea; no se toca la celda de un actor
+    const int w = layout.width();
+    const int doorsY = static_cast<int>(doors.size()) / doorsX;
+    doorRng = xorshift32(doorRng);
+    int bx = (s.pacmanPos.x >> SUBCELL_SHIFT) / DOOR_SPACING - 1;
+    int by = (s.pacmanPos.y >> SUBCELL_SHIFT) / DOOR_SPACING - 1;
+    bx += static_cast<int>(doorRng % 3);
+    by += static_cast<int>((doorRng >> 8) % 3);
+    if(bx < 0 || bx >= doorsX || by < 0 || by >= doorsY) return;
+    int door = doors[by * doorsX + bx];
+    if(door < 0 || door == cellOf(s.pacmanPos)) return;
+    for(const auto &ghost : s.ghosts) {
+        if(door == cellOf(ghost.pos)) return;
+    }
+
+    bool wall = !layout.isWall(door);
+    int x = door % w, y = door / w;
+    uint8_t content = map.at(x, y);
+    if(content == CELL_DOT || content == CELL_POWER) dotsLeft--;
+    layout.setWall(door, wall);
+    home.wallChanged(door);
+    map.set(x, y, wall ? CELL_WALL : CELL_EMPTY);
+    changed.push_back(door);
+    toggles++;
+}
+
+void ProceduralGame::movePacman() {
+    pacmanFrom = s.pacmanPos;
+    Vec2 probe = s.pacmanPos;
+    if(s.nextDir != s.pacmanDir && advance(probe, s.nextDir, s.pacmanSpeed)) {
+        s.pacmanDir = s.nextDir;
+    }
+    if(advance(s.pacmanPos, s.pacmanDir, s.pacmanSpeed)) {
+        s.mouthAngle = (s.mouthAngle + 5) % 60;
+    }
+    eatDot(cellOf(s.pacmanPos));
+}
+
+void ProceduralGame::eatDot(int cell) {
+    int x = cell % layout.width(), y = cell / layout.width();
+    uint8_t content = map.at(x, y);
+    if(content != CELL_DOT && content != CELL_POWER) return;
+
+    map.set(x, y, CELL_EMPTY);
+    changed.push_back(cell);
+    dotsLeft--;
+    if(content == CELL_DOT) {
+        s.score += 10;
+        return;
+    }
+    s.score += 50;
+    s.frightenedTimer = s.frightenedTicks;
+    for(auto &ghost : s.ghosts) {
+        if(!ghost.scared) ghost.dir = (ghost.dir + 2) % 4;
+        ghost.scared = true;
+    }
+}
+
+void ProceduralGame::moveGhosts() {
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        GhostState &ghost = s.ghosts[i];
+        if(atCentre(ghost.pos)) {
+            int cell = cellOf(ghost.pos);
+            ghost.pos = cellCentre(cell % layout.width(), cell / layout.width());
+            int homeward = returning[i] ? home.downhill(cell) : DIR_NONE;
+            if(returning[i] && cell == layout.doorCell()) {
+                // En la puerta vuelve a la normalidad y sale hacia arriba
+                returning[i] = false;
+                ghost.scared = false;
+                ghost.dir = DIR_UP;
+            } else if(homeward != DIR_NONE) {
+                ghost.dir = homeward;
+            } else {
+                ghost.dir = chooseDirection(ghost, cell);
+            }
+        }
+        ghostFrom[i] = ghost.pos;
+        // Sin paso más adelante (callejón): media vuelta
+        if(!advance(ghost.pos, ghost.dir, s.pacmanSpeed)) ghost.dir = (ghost.dir + 2) % 4;
+    }
+}
+
+int ProceduralGame::chooseDirection(GhostState &ghost, int cell) const {
+    // Sin volver atrás salvo en un callejón; asustado o de vez en cuando
+    // al azar, si no la salida que más acerca a Pac-Man en línea recta
+    int moves = layout.legalMoves(cell);
+    int reverse = (ghost.dir + 2) % 4;
+    int options = moves & ~(1 << reverse);
+    if(!options) return moves ? reverse : ghost.dir;
+
+    ghost.rng = xorshift32(ghost.rng);
+    if(ghost.scared || static_cast<int>(ghost.rng >> 24) < s.ghostWander) {
+        int candidates[4], count = 0;
+        for(int d = 0; d < 4; d++) {
+            if(options & (1 << d)) candidates[count++] = d;
+        }
+        return candidates[(ghost.rng & 0xffff) % count];
+    }
+
+    const int w = layout.width();
+    const int target = cellOf(s.pacmanPos);
+    int best = DIR_NONE;
+    long long bestDistance = 0;
+    for(int d = 0; d < 4; d++) {
+        if(!(options & (1 << d))) continue;
+        long long dx = cell % w + DIR_DX[d] - target % w;
+        long long dy = cell / w + DIR_DY[d] - target / w;
+        long long distance = dx * dx + dy * dy;
+        if(best == DIR_NONE || distance < bestDistance) {
+            best = d;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+void ProceduralGame::checkCollisions() {
+    for(int i = 0; i < NUM_GHOSTS; i++) {
+        GhostState &ghost = s.ghosts[i];
+        if(returning[i]) continue;
+        if(!PacmanCore::sweptContact(pacmanFrom, s.pacmanPos, ghostFrom[i], ghost.pos)) continue;
+        if(ghost.scared) {
+            // Fantasma comido: vuelve solo a la casa por el campo de distancias
+            s.score += 200;
+            returning[i] = true;
+            continue;
+        }
+        s.lives--;
+        if(s.lives <= 0) {
+            s.gameOver = true;
+            return;
+        }
+        // Todos de vuelta a su sitio; el mapa queda como estaba
+        resetActors();
+        return;
+    }
+}
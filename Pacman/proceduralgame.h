@@ -0,0 +1,107 @@
+#ifndef PROCEDURALGAME_H
+#define PROCEDURALGAME_H
+
+// Partida en un laberinto procedural de cualquier tamaño (de 21x21 a
+// 4095x4095), sin Qt. El mapa vive en un ChunkedMaze, así que la vista lo
+// dibuja por bloques con la cámara.
+//
+// Las reglas no son las de PacmanCore: ghostai.h trabaja sobre las tablas
+// de MazeDistances del tablero de 19x21, que en un mapa de millones de
+// celdas no caben. Iguales que en el núcleo: velocidad, centro de celda
+// para girar, túnel, puntos (10), power pellets (50, susto de
+// ARCADE_DIFFICULTY.frightenedTicks y media vuelta), fantasma comido
+// (200) y choques por sweptContact. Simplificado a propósito:
+//  - Los fantasmas persiguen la celda de Pac-Man por distancia en línea
+//    recta desde el cruce, todos igual y con GHOST_WANDER de azar; no hay
+//    objetivos por fantasma ni caminos más cortos por el laberinto.
+//  - No hay dispersión ni cambios de modo: siempre persiguen.
+//  - No hay casa con salidas escalonadas: empiezan todos fuera, en el
+//    pasillo de encima de la casa.
+//  - El comido no reaparece de golpe en la casa como en el núcleo:
+//    vuelve andando hasta la puerta y sale de ella.
+//
+// El laberinto cambia mientras se juega: hay una puerta en cada bloque de
+// DOOR_SPACING x DOOR_SPACING celdas y cada DOOR_PERIOD ticks se abre o se
+// cierra una de las que rodean a Pac-Man. Un fantasma comido vuelve a la
+// puerta de la casa cuesta abajo por un DistanceField, que se repara con
+// cada puerta en lugar de recalcularse.
+//
+// GameState solo lleva los actores y el marcador (los bitboards son del
+// tablero de 19x21 y quedan vacíos): es lo que GameRenderer dibuja.
+
+#include "pacmancore.h"
+#include "mazegen.h"
+#include "chunkedmaze.h"
+#include "distancefield.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+class ProceduralGame {
+public:
+    ProceduralGame(int side, uint64_t seed, ThreadPool &pool);
+
+    // Mapa lleno otra vez, actores en su sitio y marcador a cero
+    void reset();
+
+    // Avanza un tick con la dirección pedida (DIR_NONE conserva la última)
+    void step(int input = DIR_NONE);
+
+    const GameState &state() const { return s; }
+    const ProceduralMaze &maze() const { return layout; }
+    const ChunkedMaze &tiles() const { return map; }
+
+    // Celdas del mapa que cambiaron en el último step() (puntos comidos y
+    // puertas). Al pasar de nivel el mapa se rellena entero y no se listan.
+    const std::vector<int> &changedCells() const { return changed; }
+
+    int dotsRemaining() const { return dotsLeft; }
+
+    // Pasos hasta la puerta de la casa, al día con las puertas
+    const DistanceField &homeField() const { return home; }
+    long long doorToggles() const { return toggles; }
+
+private:
+    static constexpr int GHOST_WANDER = 64; // de 256, como ghostWander
+    static constexpr int DOOR_SPACING = 16;
+    static constexpr int DOOR_PERIOD = 40;
+
+    ProceduralMaze layout;
+    DistanceField home;
+    ChunkedMaze map;
+    GameState s;
+    int32_t worldWidth; // en unidades de SUBCELL
+    int dotsLeft;
+    std::vector<int> changed;
+
+    // Puerta de cada bloque de DOOR_SPACING x DOOR_SPACING (-1 si no tiene),
+    // fila a fila; se conservan al reiniciar y al pasar de nivel
+    std::vector<int> doors;
+    int doorsX;
+    uint32_t doorRng;
+    long long toggles;
+
+    // Fantasmas comidos camino de la casa: siguen asustados y no chocan
+    bool returning[NUM_GHOSTS];
+
+    // Recorrido de cada actor en el tick, para los choques
+    Vec2 pacmanFrom;
+    Vec2 ghostFrom[NUM_GHOSTS];
+
+    void placeDoors(uint64_t seed);
+    void toggleDoor();
+    void fillMap();
+    void resetActors();
+    Vec2 ghostStart(int ghost) const;
+    int cellOf(Vec2 pos) const;
+    bool atCentre(Vec2 pos) const;
+    bool advance(Vec2 &pos, int dir, int distance) const;
+    void movePacman();
+    void eatDot(int cell);
+    void moveGhosts();
+    int chooseDirection(GhostState &ghost, int cell) const;
+    void checkCollisions();
+};
+
+#endif // PROCEDURALGAME_H
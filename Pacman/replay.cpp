@@ -0,0 +1,226 @@
+#include "replay.h"
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const char MAGIC[4] = {'P', 'M', 'R', 'P'};
+const uint8_t VERSION = 4;
+
+struct Fnv {
+    uint64_t h = 1469598103934665603ull;
+
+    template <typename T>
+    void add(T value) {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(&value);
+        for(size_t i = 0; i < sizeof(T); i++) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    }
+};
+
+void putU32(std::string &out, uint32_t v) {
+    for(int i = 0; i < 4; i++) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+void putU64(std::string &out, uint64_t v) {
+    for(int i = 0; i < 8; i++) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+void putVarint(std::string &out, uint64_t v) {
+    while(v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+struct Reader {
+    const std::string &data;
+    size_t pos;
+    bool ok;
+
+    explicit Reader(const std::string &d) : data(d), pos(0), ok(true) {}
+
+    uint8_t byte() {
+        if(pos >= data.size()) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<uint8_t>(data[pos++]);
+    }
+
+    uint32_t u32() {
+        uint32_t v = 0;
+        for(int i = 0; i < 4; i++) v |= uint32_t(byte()) << (8 * i);
+        return v;
+    }
+
+    uint64_t u64() {
+        uint64_t v = 0;
+        for(int i = 0; i < 8; i++) v |= uint64_t(byte()) << (8 * i);
+        return v;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for(int shift = 0; shift < 64 && ok; shift += 7) {
+            uint8_t b = byte();
+            v |= uint64_t(b & 0x7F) << shift;
+            if(!(b & 0x80)) break;
+        }
+        return v;
+    }
+};
+
+}
+
+uint64_t stateHash(const GameState &s) {
+    // Campo por campo para no depender del relleno de los structs
+    Fnv f;
+    for(int w = 0; w < Bitboard::WORDS; w++) {
+        f.add(s.dots.words[w]);
+        f.add(s.powers.words[w]);
+    }
+    f.add(s.pacmanPos.x);
+    f.add(s.pacmanPos.y);
+    f.add(s.pacmanDir);
+    f.add(s.nextDir);
+    f.add(s.mouthAngle);
+    for(const GhostState &g : s.ghosts) {
+        f.add(g.pos.x);
+        f.add(g.pos.y);
+        f.add(g.dir);
+        f.add(g.scared);
+        f.add(g.rng);
+    }
+    f.add(s.humanGhost);
+    f.add(s.ghostNextDir);
+    f.add(s.score);
+    f.add(s.lives);
+    f.add(s.gameOver);
+    f.add(s.frightenedTimer);
+    f.add(s.ghostMode);
+    f.add(s.level);
+    f.add(s.levelTick);
+    f.add(s.tick);
+    f.add(s.pacmanSpeed);
+    f.add(s.frightenedTicks);
+    f.add(s.ghostWander);
+    return f.h;
+}
+
+ReplayResult summarize(const GameState &s) {
+    return {s.tick, s.score, s.lives, s.level, stateHash(s)};
+}
+
+Recording::Recording()
+    : seed(0), difficulty(ARCADE_DIFFICULTY), final{0, 0, 0, 0, 0}, lastDir(DIR_NONE) {}
+
+void Recording::begin(uint64_t gameSeed, int initialDir, const Difficulty &gameDifficulty) {
+    seed = gameSeed;
+    difficulty = gameDifficulty;
+    events.clear();
+    final = {0, 0, 0, 0, 0};
+    lastDir = initialDir;
+}
+
+void Recording::record(int64_t tick, int dir, uint8_t phase) {
+    if(dir == DIR_NONE || dir == lastDir) return;
+    events.push_back({tick, static_cast<int8_t>(dir), phase});
+    lastDir = dir;
+}
+
+void Recording::finish(const GameState &s) {
+    final = summarize(s);
+}
+
+bool Recording::save(const std::string &path) const {
+    std::string out(MAGIC, sizeof(MAGIC));
+    out.push_back(static_cast<char>(VERSION));
+    putU64(out, seed);
+    putU32(out, static_cast<uint32_t>(difficulty.pacmanSpeed));
+    putU32(out, static_cast<uint32_t>(difficulty.frightenedTicks));
+    putU32(out, static_cast<uint32_t>(difficulty.ghostWander));
+
+    putVarint(out, events.size());
+    int64_t prev = 0;
+    for(const InputEvent &e : events) {
+        putVarint(out, (uint64_t(e.tick - prev) << 2) | uint64_t(e.dir & 3));
+        out.push_back(static_cast<char>(e.phase));
+        prev = e.tick;
+    }
+
+    putU64(out, static_cast<uint64_t>(final.tick));
+    putU32(out, static_cast<uint32_t>(final.score));
+    putU32(out, static_cast<uint32_t>(final.lives));
+    putU32(out, static_cast<uint32_t>(final.level));
+    putU64(out, final.hash);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(out.data(), out.size());
+    return static_cast<bool>(file);
+}
+
+bool Recording::load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file) return false;
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Reader in(data);
+    for(char m : MAGIC) {
+        if(in.byte() != static_cast<uint8_t>(m)) return false;
+    }
+    uint8_t version = in.byte();
+    if(version != VERSION) return false;
+    seed = in.u64();
+
+    // Una velocidad de 0 o de más de una celda por tick rompería la
+    // simulación: el archivo está dañado
+    difficulty.pacmanSpeed = static_cast<int>(in.u32());
+    difficulty.frightenedTicks = static_cast<int>(in.u32());
+    difficulty.ghostWander = static_cast<int>(in.u32());
+    if(difficulty.pacmanSpeed <= 0 || difficulty.pacmanSpeed > SUBCELL) return false;
+    if(difficulty.frightenedTicks < 0 || difficulty.ghostWander < 0 || difficulty.ghostWander > 256) {
+        return false;
+    }
+
+    uint64_t count = in.varint();
+    events.clear();
+    int64_t tick = 0;
+    for(uint64_t i = 0; i < count && in.ok; i++) {
+        uint64_t v = in.varint();
+        tick += static_cast<int64_t>(v >> 2);
+        uint8_t phase = in.byte();
+        events.push_back({tick, static_cast<int8_t>(v & 3), phase});
+    }
+
+    final.tick = static_cast<int64_t>(in.u64());
+    final.score = static_cast<int32_t>(in.u32());
+    final.lives = static_cast<int32_t>(in.u32());
+    final.level = static_cast<int32_t>(in.u32());
+    final.hash = in.u64();
+    lastDir = events.empty() ? static_cast<int>(DIR_NONE) : events.back().dir;
+    return in.ok;
+}
+
+ReplayResult replayRecording(const Recording &rec, GameState *finalState) {
+    PacmanCore core;
+    core.setDifficulty(rec.difficulty);
+    core.reset(rec.seed);
+
+    size_t next = 0;
+    while(!core.state().gameOver && core.state().tick < rec.final.tick) {
+        int input = DIR_NONE;
+        int phase = 0;
+        while(next < rec.events.size() && rec.events[next].tick <= core.state().tick) {
+            input = rec.events[next].dir;
+            phase = rec.events[next++].phase;
+        }
+        core.step(input, DIR_NONE, phase);
+    }
+
+    if(finalState) *finalState = core.state();
+    return summarize(core.state());
+}
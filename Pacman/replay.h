@@ -0,0 +1,68 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "pacmancore.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Grabación de una partida: la semilla y los cambios de dirección con el
+// tick en que entraron al núcleo. Con eso la partida se vuelve a simular
+// tick a tick igual que la original.
+
+struct InputEvent {
+    int64_t tick;
+    int8_t dir;
+    uint8_t phase; // parte del tick ya pasada al llegar, en 1/256
+};
+
+// Resumen del estado final para comprobar que la repetición coincide
+struct ReplayResult {
+    int64_t tick;
+    int32_t score;
+    int32_t lives;
+    int32_t level;
+    uint64_t hash;
+
+    bool operator==(const ReplayResult &o) const {
+        return tick == o.tick && score == o.score && lives == o.lives &&
+               level == o.level && hash == o.hash;
+    }
+    bool operator!=(const ReplayResult &o) const { return !(*this == o); }
+};
+
+// Hash FNV-1a de todo el estado de la partida
+uint64_t stateHash(const GameState &s);
+ReplayResult summarize(const GameState &s);
+
+class Recording {
+public:
+    Recording();
+
+    void begin(uint64_t seed, int initialDir, const Difficulty &difficulty = ARCADE_DIFFICULTY);
+    // Guarda dir si cambió respecto a la última dirección registrada
+    void record(int64_t tick, int dir, uint8_t phase = 0);
+    void finish(const GameState &s);
+
+    // Formato: "PMRP", versión, semilla, dificultad (velocidad, susto y
+    // azar, 32 bits cada uno), eventos como varint ((delta de tick << 2) |
+    // dirección) seguido de un byte de fase, y el resumen final. Las
+    // versiones 1 y 2 son de antes de las posiciones en punto fijo y la 3
+    // no guardaba la dificultad (ni la contaba en el hash): con las reglas
+    // de ahora no se reproducen y no se leen.
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+
+    uint64_t seed;
+    Difficulty difficulty; // la repetición la aplica antes de reset()
+    std::vector<InputEvent> events;
+    ReplayResult final;
+
+private:
+    int lastDir;
+};
+
+// Vuelve a simular la grabación sin dibujar, lo más rápido posible
+ReplayResult replayRecording(const Recording &rec, GameState *finalState = nullptr);
+
+#endif // REPLAY_H
@@ -0,0 +1,39 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// Generadores deterministas: cada partida tiene una semilla y de ella sale
+// un flujo xorshift32 independiente por fantasma, así una partida se
+// reproduce igual con la misma semilla y las mismas entradas.
+
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Semilla del flujo número stream (nunca 0, que xorshift no admite)
+inline uint32_t streamSeed(uint64_t seed, int stream) {
+    uint32_t s = static_cast<uint32_t>(splitmix64(seed * 31 + stream) >> 32);
+    return s ? s : 1u;
+}
+
+inline uint32_t xorshift32(uint32_t x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Jugador de prueba de los benchmarks y de la política "random": sigue en
+// dir y, uno de cada period ticks de media, elige otra dirección al azar
+// entre DIR_RIGHT y DIR_UP (0 a 3)
+inline int randomTurn(uint32_t &rng, int dir, uint32_t period = 16) {
+    rng = xorshift32(rng);
+    if(rng % period == 0) dir = static_cast<int>((rng >> 8) % 4);
+    return dir;
+}
+
+#endif // RNG_H
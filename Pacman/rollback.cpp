@@ -0,0 +1,208 @@
+#include "rollback.h"
+#include "replay.h"
+#include <type_traits>
+
+// Las instantáneas se copian con una asignación: el estado no puede tener
+// punteros ni contenedores
+static_assert(std::is_trivially_copyable<GameState>::value,
+              "GameState debe poder copiarse como bytes");
+
+namespace {
+
+// Paquete: "PN", tick de la primera entrada, confirmación de las entradas
+// del otro, tick y hash de comprobación, número de entradas y entradas
+const uint8_t MAGIC[2] = {'P', 'N'};
+const int HEADER_SIZE = 2 + 4 + 4 + 4 + 8 + 1;
+
+void putU32(uint8_t *p, uint32_t v) {
+    for(int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void putU64(uint8_t *p, uint64_t v) {
+    for(int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+uint32_t getU32(const uint8_t *p) {
+    uint32_t v = 0;
+    for(int i = 0; i < 4; i++) v |= uint32_t(p[i]) << (8 * i);
+    return v;
+}
+
+uint64_t getU64(const uint8_t *p) {
+    uint64_t v = 0;
+    for(int i = 0; i < 8; i++) v |= uint64_t(p[i]) << (8 * i);
+    return v;
+}
+
+}
+
+RollbackSession::RollbackSession(int localPlayer, int ghost, uint64_t seed, int inputDelay, NetLink *netLink)
+    : link(netLink), local(localPlayer), now(0), rollbackFrom(-1), syncTick(-1), syncHash(0), lateSamples(0) {
+    delay = inputDelay < 0 ? 0 : (inputDelay > MAX_ROLLBACK ? MAX_ROLLBACK : inputDelay);
+
+    core.reset(seed);
+    core.state().humanGhost = ghost;
+
+    st = RollbackStats();
+    st.inputDelay = delay;
+
+    // Los primeros ticks no tienen entrada de nadie: los dos lados lo saben
+    for(int i = 0; i < HISTORY; i++) {
+        localInputs[i] = DIR_NONE;
+        remoteInputs[i] = DIR_NONE;
+        remoteTick[i] = i < delay ? i : -1;
+        used[i] = DIR_NONE;
+    }
+    remoteConfirmed = delay - 1;
+    peerAcked = delay - 1;
+}
+
+bool RollbackSession::advanceFrame(int localInput) {
+    st.frames++;
+    readPackets();
+
+    if(rollbackFrom >= 0) {
+        // Volver al primer tick mal predicho y resimular hasta el presente
+        int64_t end = now;
+        int depth = static_cast<int>(end - rollbackFrom);
+        core.state() = snapshots[rollbackFrom % HISTORY];
+        now = rollbackFrom;
+        while(now < end) simulateTick();
+
+        st.rollbacks++;
+        st.resimulated += depth;
+        if(depth > st.maxRollback) st.maxRollback = depth;
+        rollbackFrom = -1;
+    }
+
+    // Sin las entradas remotas de los últimos MAX_ROLLBACK ticks no se
+    // avanza: una corrección más profunda no cabría en un frame
+    bool advanced = now - remoteConfirmed <= MAX_ROLLBACK;
+    if(advanced) {
+        localInputs[(now + delay) % HISTORY] = static_cast<int8_t>(localInput);
+        simulateTick();
+    } else {
+        st.stalls++;
+    }
+
+    checkSync();
+    sendInputs();
+    return advanced;
+}
+
+void RollbackSession::simulateTick() {
+    int slot = static_cast<int>(now % HISTORY);
+    snapshots[slot] = core.state();
+
+    // Entrada remota: la recibida o, si aún no ha llegado, la última
+    // confirmada
+    int8_t remote;
+    if(remoteTick[slot] == now) remote = remoteInputs[slot];
+    else remote = remoteConfirmed >= 0 ? remoteInputs[remoteConfirmed % HISTORY] : int8_t(DIR_NONE);
+    used[slot] = remote;
+
+    if(local == PLAYER_PACMAN) core.step(localInputs[slot], remote);
+    else core.step(remote, localInputs[slot]);
+    now++;
+}
+
+void RollbackSession::readPackets() {
+    uint8_t packet[HEADER_SIZE + MAX_SEND];
+    int size;
+    while((size = link->receive(packet, sizeof(packet))) >= 0) {
+        handlePacket(packet, size);
+    }
+}
+
+void RollbackSession::handlePacket(const uint8_t *data, int size) {
+    if(size < HEADER_SIZE || data[0] != MAGIC[0] || data[1] != MAGIC[1]) return;
+    int64_t first = getU32(data + 2);
+    int64_t ack = static_cast<int32_t>(getU32(data + 6));
+    int64_t peerSyncTick = static_cast<int32_t>(getU32(data + 10));
+    int count = data[22];
+    if(size < HEADER_SIZE + count) return;
+
+    // Las direcciones vienen de la red: un paquete con alguna fuera de
+    // rango se descarta entero
+    for(int i = 0; i < count; i++) {
+        int8_t dir = static_cast<int8_t>(data[HEADER_SIZE + i]);
+        if(dir < DIR_NONE || dir > DIR_UP) return;
+    }
+
+    if(ack > peerAcked) peerAcked = ack;
+    for(int i = 0; i < count; i++) {
+        receiveInput(first + i, static_cast<int8_t>(data[HEADER_SIZE + i]));
+    }
+
+    // El otro manda el hash de un estado que ya no puede cambiar; se
+    // compara en cuanto aquí también sea definitivo
+    if(peerSyncTick > syncTick) {
+        syncTick = peerSyncTick;
+        syncHash = getU64(data + 14);
+    }
+}
+
+void RollbackSession::checkSync() {
+    uint64_t hash;
+    if(syncTick < 0 || !finalHash(syncTick, hash)) return;
+    st.syncChecks++;
+    if(hash != syncHash) st.desyncs++;
+    syncTick = -1;
+}
+
+void RollbackSession::receiveInput(int64_t t, int8_t dir) {
+    // Repetidas, o tan adelantadas que pisarían el historial
+    if(t <= remoteConfirmed || t >= now + HISTORY - MAX_ROLLBACK) return;
+    int slot = static_cast<int>(t % HISTORY);
+    if(remoteTick[slot] == t) return;
+
+    remoteInputs[slot] = dir;
+    remoteTick[slot] = t;
+
+    int late = t < now ? static_cast<int>(now - t) : 0;
+    lateSamples++;
+    st.lateTicks += (late - st.lateTicks) / lateSamples;
+    if(late > st.maxLateTicks) st.maxLateTicks = late;
+
+    // Ya simulado con otra entrada: hay que corregir
+    if(t < now && used[slot] != dir && (rollbackFrom < 0 || t < rollbackFrom)) {
+        rollbackFrom = t;
+    }
+
+    while(remoteTick[(remoteConfirmed + 1) % HISTORY] == remoteConfirmed + 1) {
+        remoteConfirmed++;
+    }
+}
+
+bool RollbackSession::finalHash(int64_t t, uint64_t &hash) const {
+    // El estado al empezar el tick t solo depende de entradas anteriores
+    if(t > remoteConfirmed + 1 || t > now || t < now - HISTORY + 1) return false;
+    hash = stateHash(t == now ? core.state() : snapshots[t % HISTORY]);
+    return true;
+}
+
+void RollbackSession::sendInputs() {
+    // Se reenvían las entradas que el otro aún no ha confirmado, empezando
+    // por las más antiguas, que son las que le dejan avanzar
+    int64_t last = now + delay - 1;
+    int64_t first = peerAcked + 1;
+    if(last - first + 1 > MAX_SEND) last = first + MAX_SEND - 1;
+    int count = last >= first ? static_cast<int>(last - first + 1) : 0;
+
+    int64_t finalTick = remoteConfirmed + 1 < now ? remoteConfirmed + 1 : now;
+    uint64_t hash = 0;
+    if(!finalHash(finalTick, hash)) finalTick = -1;
+
+    uint8_t packet[HEADER_SIZE + MAX_SEND];
+    packet[0] = MAGIC[0];
+    packet[1] = MAGIC[1];
+    putU32(packet + 2, static_cast<uint32_t>(first));
+    putU32(packet + 6, static_cast<uint32_t>(remoteConfirmed));
+    putU32(packet + 10, static_cast<uint32_t>(finalTick));
+    putU64(packet + 14, hash);
+    packet[22] = static_cast<uint8_t>(count);
+    for(int i = 0; i < count; i++) {
+        packet[HEADER_SIZE + i] = static_cast<uint8_t>(localInputs[(first + i) % HISTORY]);
+    }
+    link->send(packet, HEADER_SIZE + count);
+}
@@ -0,0 +1,84 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "pacmancore.h"
+#include "netlink.h"
+#include <cstdint>
+
+// Partida a dos jugadores con rollback: uno lleva a Pac-Man y el otro a
+// un fantasma. Cada lado simula la partida entera; la entrada propia se
+// aplica con unos ticks de retraso y la del otro se predice repitiendo la
+// última conocida. Cuando llega una entrada que no coincide con la
+// predicha se vuelve a la instantánea de ese tick y se resimula hasta el
+// presente. Las instantáneas son copias del GameState, que es un struct
+// plano sin punteros: guardar y restaurar es copiar unos cientos de bytes.
+
+struct RollbackStats {
+    long long frames;          // llamadas a advanceFrame
+    long long stalls;          // frames sin avanzar por ir demasiado adelantados
+    long long rollbacks;       // correcciones por predicciones fallidas
+    long long resimulated;     // ticks vueltos a simular en total
+    int maxRollback;           // corrección más profunda, en ticks
+    int inputDelay;            // retraso de la entrada local, en ticks
+    double lateTicks;          // media de ticks de retraso de la entrada remota
+    int maxLateTicks;
+    long long syncChecks;      // hashes del otro lado comparados
+    long long desyncs;         // hashes que no coincidían
+};
+
+class RollbackSession {
+public:
+    static const int MAX_ROLLBACK = 8;
+    enum Player { PLAYER_PACMAN = 0, PLAYER_GHOST = 1 };
+
+    // Los dos lados deben usar la misma semilla, el mismo fantasma y el
+    // mismo retraso de entrada. El enlace no pasa a ser de la sesión.
+    RollbackSession(int localPlayer, int ghost, uint64_t seed, int inputDelay, NetLink *link);
+
+    // Un frame: lee la red, corrige si hace falta y avanza un tick salvo
+    // que se haya adelantado más de MAX_ROLLBACK ticks al otro jugador.
+    // Devuelve si ha avanzado.
+    bool advanceFrame(int localInput);
+
+    const GameState &state() const { return core.state(); }
+    const PacmanCore &simulation() const { return core; }
+    const RollbackStats &stats() const { return st; }
+    int localPlayer() const { return local; }
+
+private:
+    // Historial circular por tick; basta con que cubra la ventana de
+    // rollback más el retraso de entrada y las entradas reenviadas
+    static const int HISTORY = 64;
+    static const int MAX_SEND = 32;
+
+    PacmanCore core;
+    NetLink *link;
+    int local;
+    int delay;
+
+    int64_t now;                  // siguiente tick a simular
+    GameState snapshots[HISTORY]; // estado al empezar cada tick
+    int8_t localInputs[HISTORY];
+    int8_t remoteInputs[HISTORY]; // entradas remotas recibidas
+    int64_t remoteTick[HISTORY];  // tick al que pertenece cada una
+    int8_t used[HISTORY];         // entrada remota usada (quizá predicha)
+
+    int64_t remoteConfirmed;      // todas las remotas hasta aquí han llegado
+    int64_t peerAcked;            // el otro tiene nuestras entradas hasta aquí
+    int64_t rollbackFrom;         // primer tick mal predicho pendiente, o -1
+    int64_t syncTick;             // último hash recibido sin comprobar, o -1
+    uint64_t syncHash;
+
+    RollbackStats st;
+    long long lateSamples;
+
+    bool finalHash(int64_t t, uint64_t &hash) const;
+    void checkSync();
+    void simulateTick();
+    void readPackets();
+    void handlePacket(const uint8_t *data, int size);
+    void receiveInput(int64_t t, int8_t dir);
+    void sendInputs();
+};
+
+#endif // ROLLBACK_H
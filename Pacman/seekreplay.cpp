@@ -0,0 +1,306 @@
+#include "seekreplay.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[4] = {'P', 'M', 'S', 'K'};
+const uint8_t VERSION = 4;
+const size_t HEADER_SIZE = 4 + 1 + 4 + 4;
+const size_t TAIL_SIZE = 8 + 8 + 4;
+
+// Recorre los campos del estado en un orden fijo
+template <typename S, typename F>
+void visitState(S &s, F &&f) {
+    f(s.walls);
+    f(s.dots);
+    f(s.powers);
+    f(s.pacmanPos.x);
+    f(s.pacmanPos.y);
+    f(s.pacmanDir);
+    f(s.nextDir);
+    f(s.pacmanSpeed);
+    f(s.mouthAngle);
+    for(auto &g : s.ghosts) {
+        f(g.pos.x);
+        f(g.pos.y);
+        f(g.dir);
+        f(g.scared);
+        f(g.rng);
+    }
+    f(s.humanGhost);
+    f(s.ghostNextDir);
+    f(s.score);
+    f(s.lives);
+    f(s.gameOver);
+    f(s.frightenedTimer);
+    f(s.frightenedTicks);
+    f(s.ghostWander);
+    f(s.ghostMode);
+    f(s.level);
+    f(s.levelTick);
+    f(s.tick);
+    f(s.seed);
+}
+
+void putVarint(std::vector<uint8_t> &out, uint64_t v) {
+    while(v >= 0x80) {
+        out.push_back(static_cast<uint8_t>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+uint64_t getVarint(const uint8_t *&p, const uint8_t *end) {
+    uint64_t v = 0;
+    for(int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= uint64_t(b & 0x7F) << shift;
+        if(!(b & 0x80)) break;
+    }
+    return v;
+}
+
+void putLe(std::vector<uint8_t> &out, uint64_t v, int bytes) {
+    for(int i = 0; i < bytes; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+uint64_t getLe(const uint8_t *p, int bytes) {
+    uint64_t v = 0;
+    for(int i = 0; i < bytes; i++) v |= uint64_t(p[i]) << (8 * i);
+    return v;
+}
+
+}
+
+int packState(const GameState &s, uint8_t *out) {
+    int pos = 0;
+    visitState(s, [&](const auto &field) {
+        std::memcpy(out + pos, &field, sizeof(field));
+        pos += sizeof(field);
+    });
+    return pos;
+}
+
+void unpackState(const uint8_t *in, GameState &s) {
+    int pos = 0;
+    visitState(s, [&](auto &field) {
+        std::memcpy(&field, in + pos, sizeof(field));
+        pos += sizeof(field);
+    });
+}
+
+SeekableReplayWriter::SeekableReplayWriter()
+    : file(nullptr), interval(256), stateSize(0), frames(0), offset(0), failed(false) {}
+
+SeekableReplayWriter::~SeekableReplayWriter() {
+    close();
+}
+
+void SeekableReplayWriter::write(const uint8_t *data, size_t size) {
+    if(std::fwrite(data, 1, size, file) != size) failed = true;
+    offset += size;
+}
+
+bool SeekableReplayWriter::open(const std::string &path, int keyframeInterval) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if(!file) return false;
+
+    interval = keyframeInterval;
+    frames = 0;
+    offset = 0;
+    failed = false;
+    index.clear();
+
+    GameState probe = {};
+    previous.assign(PACKED_STATE_SIZE, 0);
+    current.assign(PACKED_STATE_SIZE, 0);
+    stateSize = packState(probe, current.data());
+
+    buffer.assign(MAGIC, MAGIC + 4);
+    buffer.push_back(VERSION);
+    putLe(buffer, stateSize, 4);
+    putLe(buffer, interval, 4);
+    write(buffer.data(), buffer.size());
+    if(failed) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SeekableReplayWriter::append(const GameState &s) {
+    if(!file) return;
+    packState(s, current.data());
+
+    if(frames % interval == 0) {
+        index.push_back(frames);
+        index.push_back(offset);
+        write(current.data(), stateSize);
+    } else {
+        // Tramos de bytes que difieren del frame anterior
+        buffer.clear();
+        std::vector<uint8_t> runs;
+        int count = 0;
+        int last = 0;
+        int i = 0;
+        while(i < stateSize) {
+            if(current[i] == previous[i]) {
+                i++;
+                continue;
+            }
+            int start = i;
+            while(i < stateSize && current[i] != previous[i]) i++;
+            putVarint(runs, start - last);
+            putVarint(runs, i - start);
+            runs.insert(runs.end(), current.begin() + start, current.begin() + i);
+            last = i;
+            count++;
+        }
+        putVarint(buffer, count);
+        buffer.insert(buffer.end(), runs.begin(), runs.end());
+        write(buffer.data(), buffer.size());
+    }
+
+    std::swap(previous, current);
+    frames++;
+}
+
+bool SeekableReplayWriter::close() {
+    if(!file) return false;
+
+    buffer.clear();
+    for(uint64_t v : index) putLe(buffer, v, 8);
+    putLe(buffer, index.size() / 2, 8);
+    putLe(buffer, frames, 8);
+    buffer.insert(buffer.end(), MAGIC, MAGIC + 4);
+    write(buffer.data(), buffer.size());
+
+    bool ok = std::fclose(file) == 0 && !failed;
+    file = nullptr;
+    return ok;
+}
+
+SeekableReplay::SeekableReplay()
+    : data(nullptr), size(0), stateSize(0), interval(0), frames(0),
+    keyframes(0), indexBase(nullptr) {}
+
+SeekableReplay::~SeekableReplay() {
+    close();
+}
+
+bool SeekableReplay::open(const std::string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE + TAIL_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    size = st.st_size;
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = static_cast<const uint8_t *>(mapped);
+
+    const uint8_t *tail = data + size - TAIL_SIZE;
+    if(std::memcmp(data, MAGIC, 4) != 0 || data[4] != VERSION ||
+       std::memcmp(tail + 16, MAGIC, 4) != 0) {
+        close();
+        return false;
+    }
+
+    GameState probe = {};
+    uint8_t scratch[PACKED_STATE_SIZE];
+    stateSize = static_cast<int>(getLe(data + 5, 4));
+    interval = static_cast<int>(getLe(data + 9, 4));
+    keyframes = getLe(tail, 8);
+    frames = getLe(tail + 8, 8);
+
+    // Los números del archivo se comprueban antes de usarlos como
+    // punteros: el índice tiene que caber entre la cabecera y la cola, y
+    // cada keyframe (frames crecientes desde 0) dentro del cuerpo
+    const uint64_t room = (size - HEADER_SIZE - TAIL_SIZE) / 16;
+    bool ok = stateSize == packState(probe, scratch) && interval > 0 && keyframes <= room &&
+              (frames == 0 ? keyframes == 0 : keyframes >= 1);
+    if(ok) {
+        indexBase = tail - keyframes * 16;
+        const uint64_t body = static_cast<uint64_t>(indexBase - data);
+        for(uint64_t i = 0; i < keyframes && ok; i++) {
+            uint64_t frame = indexFrame(i), offset = indexOffset(i);
+            ok = frame < frames && (i == 0 ? frame == 0 : frame > indexFrame(i - 1)) &&
+                 offset >= HEADER_SIZE && offset <= body &&
+                 static_cast<uint64_t>(stateSize) <= body - offset;
+        }
+    }
+    if(!ok) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SeekableReplay::close() {
+    if(data) munmap(const_cast<uint8_t *>(data), size);
+    data = nullptr;
+    size = 0;
+    frames = 0;
+    keyframes = 0;
+}
+
+uint64_t SeekableReplay::indexFrame(uint64_t i) const {
+    return getLe(indexBase + i * 16, 8);
+}
+
+uint64_t SeekableReplay::indexOffset(uint64_t i) const {
+    return getLe(indexBase + i * 16 + 8, 8);
+}
+
+bool SeekableReplay::stateAt(uint64_t frame, GameState &out) const {
+    if(!data || frame >= frames) return false;
+
+    // Último keyframe con frame <= pedido (búsqueda binaria en el índice)
+    uint64_t lo = 0, hi = keyframes;
+    while(hi - lo > 1) {
+        uint64_t mid = (lo + hi) / 2;
+        if(indexFrame(mid) <= frame) lo = mid;
+        else hi = mid;
+    }
+
+    uint8_t state[PACKED_STATE_SIZE];
+    const uint8_t *p = data + indexOffset(lo);
+    const uint8_t *end = indexBase;
+    std::memcpy(state, p, stateSize);
+    p += stateSize;
+
+    for(uint64_t f = indexFrame(lo) + 1; f <= frame; f++) {
+        uint64_t runs = getVarint(p, end);
+        int pos = 0;
+        for(uint64_t r = 0; r < runs; r++) {
+            uint64_t skip = getVarint(p, end);
+            uint64_t len = getVarint(p, end);
+            if(skip > static_cast<uint64_t>(stateSize - pos) ||
+               len > static_cast<uint64_t>(stateSize - pos) - skip ||
+               len > static_cast<uint64_t>(end - p)) {
+                return false;
+            }
+            pos += static_cast<int>(skip);
+            std::memcpy(state + pos, p, len);
+            p += len;
+            pos += static_cast<int>(len);
+        }
+    }
+
+    unpackState(state, out);
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef SEEKREPLAY_H
+#define SEEKREPLAY_H
+
+#include "pacmancore.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Repetición con acceso aleatorio: en lugar de volver a simular desde el
+// tick 0 se guarda un keyframe con el estado completo cada cierto número
+// de frames y, entre keyframes, solo los bytes que cambian de un frame al
+// siguiente. Un índice al final del archivo permite buscar el keyframe de
+// cualquier frame con una búsqueda binaria.
+//
+// Formato:
+//   cabecera  "PMSK", versión (u8), tamaño del estado (u32), intervalo (u32)
+//   cuerpo    por bloque: estado completo y después un delta por frame
+//             (varint nº de tramos; por tramo varint salto, varint largo, bytes)
+//   índice    por keyframe: frame (u64), offset (u64)
+//   cola      nº de keyframes (u64), nº de frames (u64), "PMSK"
+
+// Estado serializado campo a campo (sin relleno de structs)
+const int PACKED_STATE_SIZE = 512;
+int packState(const GameState &s, uint8_t *out);
+void unpackState(const uint8_t *in, GameState &s);
+
+class SeekableReplayWriter {
+public:
+    SeekableReplayWriter();
+    ~SeekableReplayWriter();
+
+    bool open(const std::string &path, int keyframeInterval = 256);
+    void append(const GameState &s);
+    // Escribe el índice y cierra el archivo; false si falló alguna escritura
+    bool close();
+
+    bool isOpen() const { return file != nullptr; }
+
+private:
+    std::FILE *file;
+    int interval;
+    int stateSize;
+    uint64_t frames;
+    uint64_t offset;
+    bool failed;
+    std::vector<uint8_t> previous;
+    std::vector<uint8_t> current;
+    std::vector<uint8_t> buffer;
+    std::vector<uint64_t> index; // pares frame, offset
+
+    void write(const uint8_t *data, size_t size);
+};
+
+class SeekableReplay {
+public:
+    SeekableReplay();
+    ~SeekableReplay();
+
+    // Mapea el archivo en memoria con mmap. Rechaza el archivo si el
+    // índice no cabe o apunta fuera del cuerpo.
+    bool open(const std::string &path);
+    void close();
+
+    uint64_t frameCount() const { return frames; }
+
+    // Estado del frame pedido: keyframe anterior más sus deltas
+    bool stateAt(uint64_t frame, GameState &out) const;
+
+private:
+    const uint8_t *data;
+    size_t size;
+    int stateSize;
+    int interval;
+    uint64_t frames;
+    uint64_t keyframes;
+    const uint8_t *indexBase;
+
+    uint64_t indexFrame(uint64_t i) const;
+    uint64_t indexOffset(uint64_t i) const;
+};
+
+#endif // SEEKREPLAY_H
@@ -0,0 +1,61 @@
+#include "spriteatlas.h"
+
+SpriteAtlas::SpriteAtlas() : cell(0), ghosts(0) {}
+
+void SpriteAtlas::build(int cellSize, qreal devicePixelRatio,
+                        const QColor *ghostColors, int ghostCount) {
+    cell = cellSize;
+    ghosts = ghostCount;
+
+    // Filas 0-3: Pac-Man por dirección; fila 4: fantasmas y el asustado
+    int columns = qMax(MOUTH_FRAMES, ghostCount + 1);
+    atlas = QPixmap(QSize(columns * cell, 5 * cell) * devicePixelRatio);
+    atlas.setDevicePixelRatio(devicePixelRatio);
+    atlas.fill(Qt::transparent);
+
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    for(int dir = 0; dir < 4; dir++) {
+        for(int f = 0; f < MOUTH_FRAMES; f++) {
+            int mouthAngle = f * MOUTH_STEP;
+            int x = f * cell + cell/2;
+            int y = dir * cell + cell/2;
+            painter.setBrush(Qt::yellow);
+            int startAngle = (dir * 90 + mouthAngle/2) * 16;
+            painter.drawPie(x - cell/2 + 2, y - cell/2 + 2, cell - 4, cell - 4,
+                            startAngle, (360 - mouthAngle) * 16);
+        }
+    }
+
+    for(int g = 0; g <= ghostCount; g++) {
+        int x = g * cell + cell/2;
+        int y = 4 * cell + cell/2;
+        painter.setBrush(g < ghostCount ? ghostColors[g] : QColor(Qt::blue));
+        painter.drawEllipse(x - cell/2 + 2, y - cell/2 + 2, cell - 4, cell - 4);
+
+        // Ojos
+        painter.setBrush(Qt::white);
+        painter.drawEllipse(x - 5, y - 5, 6, 6);
+        painter.drawEllipse(x + 2, y - 5, 6, 6);
+    }
+}
+
+QRectF SpriteAtlas::frame(int column, int row) const {
+    qreal dpr = atlas.devicePixelRatio();
+    return QRectF(column * cell * dpr, row * cell * dpr, cell * dpr, cell * dpr);
+}
+
+void SpriteAtlas::blit(QPainter &painter, QPoint center, int column, int row) const {
+    painter.drawPixmap(QRectF(center.x() - cell/2, center.y() - cell/2, cell, cell),
+                       atlas, frame(column, row));
+}
+
+void SpriteAtlas::drawPacman(QPainter &painter, QPoint center, int dir, int mouthAngle) const {
+    int f = (mouthAngle / MOUTH_STEP) % MOUTH_FRAMES;
+    blit(painter, center, f, dir);
+}
+
+void SpriteAtlas::drawGhost(QPainter &painter, QPoint center, int ghost, bool scared) const {
+    blit(painter, center, scared ? ghosts : ghost, 4);
+}
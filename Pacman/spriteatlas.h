@@ -0,0 +1,36 @@
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QPixmap>
+#include <QPainter>
+#include <QColor>
+#include <QPoint>
+
+// Atlas con todos los cuadros de animación prerenderizados: Pac-Man en
+// cada dirección y cada paso del ciclo de mouthAngle, y cada fantasma en
+// su color y en su variante asustada. Dibujar un actor es copiar un
+// rectángulo del atlas.
+class SpriteAtlas {
+public:
+    static const int MOUTH_FRAMES = 12; // mouthAngle va de 0 a 55 de 5 en 5
+    static const int MOUTH_STEP = 5;
+
+    SpriteAtlas();
+
+    // ghostColors tiene ghostCount colores; se añade una variante asustada
+    void build(int cellSize, qreal devicePixelRatio,
+               const QColor *ghostColors, int ghostCount);
+
+    void drawPacman(QPainter &painter, QPoint center, int dir, int mouthAngle) const;
+    void drawGhost(QPainter &painter, QPoint center, int ghost, bool scared) const;
+
+private:
+    QPixmap atlas;
+    int cell;
+    int ghosts;
+
+    QRectF frame(int column, int row) const;
+    void blit(QPainter &painter, QPoint center, int column, int row) const;
+};
+
+#endif // SPRITEATLAS_H
@@ -0,0 +1,41 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Cola circular sin bloqueos de un productor y un consumidor. N tiene que
+// ser potencia de dos. push() falla si está llena en lugar de esperar.
+template <typename T, size_t N>
+class SpscRing {
+    static_assert((N & (N - 1)) == 0, "N debe ser potencia de dos");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    // Solo el productor
+    bool push(const T &value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h - tail.load(std::memory_order_acquire) == N) return false;
+        buffer[h & (N - 1)] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Solo el consumidor
+    bool pop(T &value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(t == head.load(std::memory_order_acquire)) return false;
+        value = buffer[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T buffer[N];
+    // En líneas de caché distintas para que los dos hilos no se pisen
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,305 @@
+#include "swarm.h"
+#include "pacmancore.h"
+#include "rng.h"
+#include <algorithm>
+
+namespace {
+
+const int32_t SPEED = PACMAN_SPEED;
+const int32_t DIR_DX[4] = {1, 0, -1, 0};
+const int32_t DIR_DY[4] = {0, 1, 0, -1};
+const int DIR_STEP_X[4] = {1, 0, -1, 0};
+const int DIR_STEP_Y[4] = {0, 1, 0, -1};
+
+// Columnas del mapa normal que se abren en los muros de arriba y abajo
+// para unir una copia con la de encima
+const int PASS_COLUMNS[] = {8, 10};
+
+// Dirección al azar entre las legales sin dar media vuelta, como
+// randomGhostDirection pero con la máscara de este laberinto. Con
+// DIR_NONE vale cualquiera.
+inline int randomDirection(int mask, int dir, uint32_t r) {
+    int reverse = (dir + 2) % 4;
+    int options = dir == DIR_NONE ? mask : mask & ~(1 << reverse);
+    int count = __builtin_popcount(options);
+    if(count == 0) return reverse;
+    int pick = static_cast<int>(r % count);
+    for(int d = 0; d < 4; d++) {
+        if(!((options >> d) & 1)) continue;
+        if(pick-- == 0) return d;
+    }
+    return reverse;
+}
+
+}
+
+Swarm::Swarm(int tilesX, int tilesY, int ghostCount, uint64_t seed)
+    : score(0), tick(0), pacmanContacts(0), ghostContacts(0),
+      lastPacmanContacts(0), lastGhostContacts(0) {
+    buildMaze(tilesX, tilesY);
+
+    // Pac-Man en su sitio de siempre, en la copia del centro
+    Vec2 start = cellCentre((tilesX / 2) * GRID_WIDTH + 9, (tilesY / 2) * GRID_HEIGHT + 15);
+    pacmanX = start.x;
+    pacmanY = start.y;
+    pacmanDir = DIR_RIGHT;
+    nextDir = DIR_RIGHT;
+
+    // Fantasmas repartidos al azar por las celdas libres
+    std::vector<int32_t> open;
+    for(int c = 0; c < w * h; c++) {
+        if(!walls[c]) open.push_back(c);
+    }
+    ghostX.resize(ghostCount);
+    ghostY.resize(ghostCount);
+    ghostDir.resize(ghostCount);
+    ghostRng.resize(ghostCount);
+    // Un flujo más allá del último fantasma para elegir las celdas
+    uint32_t placer = streamSeed(seed, ghostCount);
+    for(int i = 0; i < ghostCount; i++) {
+        placer = xorshift32(placer);
+        int c = open[placer % open.size()];
+        ghostX[i] = cellCentre(c % w, c / w).x;
+        ghostY[i] = cellCentre(c % w, c / w).y;
+        ghostRng[i] = streamSeed(seed, i);
+        ghostDir[i] = static_cast<uint8_t>(randomDirection(moves[c], DIR_NONE, placer >> 16));
+    }
+
+    cellStart.assign(w * h + 1, 0);
+    order.resize(ghostCount);
+    ghostCell.resize(ghostCount);
+    bounce.assign(ghostCount, 0);
+    buildHash();
+}
+
+void Swarm::buildMaze(int tilesX, int tilesY) {
+    w = tilesX * GRID_WIDTH;
+    h = tilesY * GRID_HEIGHT;
+    walls.assign(w * h, 0);
+    dots.assign(w * h, CELL_EMPTY);
+
+    GameState level;
+    PacmanCore::loadLevelMap(level);
+    for(int ty = 0; ty < tilesY; ty++) {
+        for(int tx = 0; tx < tilesX; tx++) {
+            for(int y = 0; y < GRID_HEIGHT; y++) {
+                for(int x = 0; x < GRID_WIDTH; x++) {
+                    int c = (ty * GRID_HEIGHT + y) * w + tx * GRID_WIDTH + x;
+                    int cell = level.cellAt(x, y);
+                    walls[c] = cell == CELL_WALL;
+                    dots[c] = static_cast<uint8_t>(cell == CELL_WALL ? CELL_EMPTY : cell);
+                }
+            }
+
+            // Pasos hacia la copia de abajo
+            if(ty + 1 < tilesY) {
+                for(int px : PASS_COLUMNS) {
+                    int x = tx * GRID_WIDTH + px;
+                    walls[(ty * GRID_HEIGHT + GRID_HEIGHT - 1) * w + x] = 0;
+                    walls[((ty + 1) * GRID_HEIGHT) * w + x] = 0;
+                }
+            }
+        }
+    }
+
+    // Los túneles de las copias de los bordes no llevan a ninguna parte
+    for(int y = 0; y < h; y++) {
+        walls[y * w] = 1;
+        walls[y * w + w - 1] = 1;
+    }
+
+    moves.assign(w * h, 0);
+    for(int y = 0; y < h; y++) {
+        for(int x = 0; x < w; x++) {
+            if(walls[y * w + x]) continue;
+            uint8_t mask = 0;
+            for(int d = 0; d < 4; d++) {
+                int nx = x + DIR_STEP_X[d];
+                int ny = y + DIR_STEP_Y[d];
+                if(nx < 0 || nx >= w || ny < 0 || ny >= h) continue;
+                if(!walls[ny * w + nx]) mask |= 1 << d;
+            }
+            moves[y * w + x] = mask;
+        }
+    }
+}
+
+int Swarm::cellIndex(int32_t x, int32_t y) const {
+    int cx = x >> SUBCELL_SHIFT;
+    int cy = y >> SUBCELL_SHIFT;
+    cx = cx < 0 ? 0 : (cx >= w ? w - 1 : cx);
+    cy = cy < 0 ? 0 : (cy >= h ? h - 1 : cy);
+    return cy * w + cx;
+}
+
+void Swarm::step(int input) {
+    // Solo direcciones válidas: movePacman indexa DIR_DX con nextDir
+    if(input >= DIR_RIGHT && input <= DIR_UP) nextDir = input;
+
+    movePacman();
+    moveGhosts();
+    buildHash();
+    lastPacmanContacts = checkPacman();
+    lastGhostContacts = checkGhosts();
+    pacmanContacts += lastPacmanContacts;
+    ghostContacts += lastGhostContacts;
+    tick++;
+}
+
+void Swarm::movePacman() {
+    // Igual que PacmanBatch::movePacmen, sin túnel
+    int d = pacmanDir;
+    if(nextDir != d &&
+       !walls[cellIndex(pacmanX + DIR_DX[nextDir] * SPEED, pacmanY + DIR_DY[nextDir] * SPEED)]) {
+        d = nextDir;
+    }
+    pacmanDir = d;
+
+    int32_t nx = pacmanX + DIR_DX[d] * SPEED;
+    int32_t ny = pacmanY + DIR_DY[d] * SPEED;
+    if(!walls[cellIndex(nx, ny)]) {
+        pacmanX = nx;
+        pacmanY = ny;
+    }
+
+    int c = cellIndex(pacmanX, pacmanY);
+    if(dots[c] == CELL_DOT) score += 10;
+    else if(dots[c] == CELL_POWER) score += 50;
+    dots[c] = CELL_EMPTY;
+}
+
+void Swarm::moveGhosts() {
+    const int n = size();
+    for(int i = 0; i < n; i++) {
+        int32_t x = ghostX[i];
+        int32_t y = ghostY[i];
+        int d = ghostDir[i];
+
+        // Solo se decide en el centro de la celda (a menos de medio paso)
+        int32_t cx = (x & ~(SUBCELL - 1)) + HALF_CELL;
+        int32_t cy = (y & ~(SUBCELL - 1)) + HALF_CELL;
+        int32_t fx = x - cx, fy = y - cy;
+        if(2 * (fx < 0 ? -fx : fx) < SPEED && 2 * (fy < 0 ? -fy : fy) < SPEED) {
+            x = cx;
+            y = cy;
+            uint32_t r = xorshift32(ghostRng[i]);
+            ghostRng[i] = r;
+            d = randomDirection(moves[cellIndex(x, y)], d, r);
+        }
+
+        int32_t nx = x + DIR_DX[d] * SPEED;
+        int32_t ny = y + DIR_DY[d] * SPEED;
+        bool move = !walls[cellIndex(nx, ny)];
+        ghostX[i] = move ? nx : x;
+        ghostY[i] = move ? ny : y;
+        ghostDir[i] = static_cast<uint8_t>(d);
+    }
+}
+
+void Swarm::buildHash() {
+    // Counting sort por celda: se cuenta, se acumula y se reparte de atrás
+    // hacia delante, así cellStart[c] queda en el primero de la celda c y
+    // cada celda conserva el orden anterior
+    const int n = size();
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for(int i = 0; i < n; i++) {
+        int c = cellIndex(ghostX[i], ghostY[i]);
+        ghostCell[i] = c;
+        cellStart[c]++;
+    }
+    int sum = 0;
+    for(int c = 0; c < w * h; c++) {
+        sum += cellStart[c];
+        cellStart[c] = sum;
+    }
+    cellStart[w * h] = n;
+    for(int i = n - 1; i >= 0; i--) {
+        order[--cellStart[ghostCell[i]]] = i;
+    }
+
+    // Los fantasmas se guardan en ese orden: los de una celda quedan
+    // juntos en memoria y los vecinos del laberinto, cerca
+    scratchX.resize(n);
+    scratchY.resize(n);
+    scratchDir.resize(n);
+    scratchRng.resize(n);
+    scratchCell.resize(n);
+    for(int k = 0; k < n; k++) {
+        int i = order[k];
+        scratchX[k] = ghostX[i];
+        scratchY[k] = ghostY[i];
+        scratchDir[k] = ghostDir[i];
+        scratchRng[k] = ghostRng[i];
+        scratchCell[k] = ghostCell[i];
+    }
+    ghostX.swap(scratchX);
+    ghostY.swap(scratchY);
+    ghostDir.swap(scratchDir);
+    ghostRng.swap(scratchRng);
+    ghostCell.swap(scratchCell);
+}
+
+int Swarm::checkPacman() {
+    // Un contacto a menos de CONTACT_RADIUS solo puede estar en las 3x3
+    // celdas alrededor de Pac-Man
+    const int64_t r2 = int64_t(CONTACT_RADIUS) * CONTACT_RADIUS;
+    int px = pacmanX >> SUBCELL_SHIFT;
+    int py = pacmanY >> SUBCELL_SHIFT;
+    int contacts = 0;
+    for(int y = std::max(py - 1, 0); y <= std::min(py + 1, h - 1); y++) {
+        for(int x = std::max(px - 1, 0); x <= std::min(px + 1, w - 1); x++) {
+            int c = y * w + x;
+            for(int i = cellStart[c]; i < cellStart[c + 1]; i++) {
+                int64_t dx = pacmanX - ghostX[i];
+                int64_t dy = pacmanY - ghostY[i];
+                contacts += dx*dx + dy*dy < r2;
+            }
+        }
+    }
+    return contacts;
+}
+
+int Swarm::checkGhosts() {
+    // Dos fantasmas que se tocan de frente dan media vuelta los dos en vez
+    // de atravesarse. Cada par se mira una vez: de la misma celda solo los
+    // que van después y de las vecinas solo las cuatro "posteriores"
+    static const int FORWARD_X[4] = {1, -1, 0, 1};
+    static const int FORWARD_Y[4] = {0, 1, 1, 1};
+    const int64_t r2 = int64_t(CONTACT_RADIUS) * CONTACT_RADIUS;
+    const int n = size();
+    int contacts = 0;
+
+    auto touch = [&](int i, int j) {
+        int64_t dx = ghostX[j] - ghostX[i];
+        int64_t dy = ghostY[j] - ghostY[i];
+        if(dx*dx + dy*dy >= r2) return;
+        int di = ghostDir[i];
+        if(ghostDir[j] != (di + 2) % 4) return;
+        // j tiene que estar delante de i; si no, ya se están alejando
+        if(dx * DIR_DX[di] + dy * DIR_DY[di] <= 0) return;
+        bounce[i] = 1;
+        bounce[j] = 1;
+        contacts++;
+    };
+
+    for(int i = 0; i < n; i++) {
+        int c = ghostCell[i];
+        for(int j = i + 1; j < cellStart[c + 1]; j++) touch(i, j);
+
+        int x = c % w;
+        int y = c / w;
+        for(int f = 0; f < 4; f++) {
+            int nx = x + FORWARD_X[f];
+            int ny = y + FORWARD_Y[f];
+            if(nx < 0 || nx >= w || ny >= h) continue;
+            int nc = ny * w + nx;
+            for(int j = cellStart[nc]; j < cellStart[nc + 1]; j++) touch(i, j);
+        }
+    }
+
+    for(int i = 0; i < n; i++) {
+        if(bounce[i]) ghostDir[i] = static_cast<uint8_t>((ghostDir[i] + 2) % 4);
+        bounce[i] = 0;
+    }
+    return contacts;
+}
@@ -0,0 +1,88 @@
+#ifndef SWARM_H
+#define SWARM_H
+
+// Modo enjambre para pruebas de carga: miles de fantasmas en un laberinto
+// grande hecho con copias del mapa normal unidas por los túneles y por
+// pasos abiertos en los muros de arriba y abajo.
+// Los fantasmas van en arreglos contiguos (struct-of-arrays) y los
+// contactos se buscan con un hash uniforme por celda del laberinto: cada
+// tick los fantasmas se reordenan por celda (counting sort) y una consulta
+// solo mira las 3x3 celdas alrededor, así la comprobación de Pac-Man no
+// depende de cuántos fantasmas haya sino de cuántos tiene cerca.
+// El índice de un fantasma cambia de un tick a otro por ese reorden.
+// Pac-Man no muere: en este modo se cuentan los contactos.
+
+#include "pacmandefs.h"
+#include <cstdint>
+#include <vector>
+
+class Swarm {
+public:
+    // Radio de contacto, el mismo que PacmanCore::checkCollisions
+    static constexpr int32_t CONTACT_RADIUS = HALF_CELL;
+
+    Swarm(int tilesX, int tilesY, int ghostCount, uint64_t seed = 1);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int size() const { return static_cast<int>(ghostX.size()); }
+    bool isWall(int x, int y) const { return walls[y * w + x] != 0; }
+
+    // Avanza un tick; input como en PacmanCore::step (fuera de
+    // DIR_RIGHT..DIR_UP se conserva la última dirección)
+    void step(int input = DIR_NONE);
+
+    // Fases de step() por separado, para medirlas
+    void movePacman();
+    void moveGhosts();
+    void buildHash();
+    int checkPacman();
+    int checkGhosts();
+
+    // Fantasmas de la celda cell tras el último buildHash(): los índices
+    // de cellBegin(cell) a cellEnd(cell), sin incluir el último
+    int cellBegin(int cell) const { return cellStart[cell]; }
+    int cellEnd(int cell) const { return cellStart[cell + 1]; }
+
+    // Pac-Man (posiciones en unidades de SUBCELL, como en PacmanCore)
+    int32_t pacmanX, pacmanY;
+    int pacmanDir;
+    int nextDir;
+    int score;
+
+    // Fantasmas (struct-of-arrays, indexados por fantasma)
+    std::vector<int32_t> ghostX, ghostY;
+    std::vector<uint8_t> ghostDir;
+    std::vector<uint32_t> ghostRng;
+
+    // Contadores
+    long long tick;
+    long long pacmanContacts; // total de contactos de Pac-Man
+    long long ghostContacts;  // total de choques entre fantasmas
+    int lastPacmanContacts;   // los del último tick
+    int lastGhostContacts;
+
+private:
+    int w, h;
+    std::vector<uint8_t> walls;  // 1 = muro, por celda
+    std::vector<uint8_t> moves;  // direcciones legales de cada celda (bit d)
+    std::vector<uint8_t> dots;
+
+    // Hash por celda: los fantasmas de la celda c son los índices
+    // [cellStart[c], cellStart[c + 1])
+    std::vector<int32_t> cellStart;
+    std::vector<int32_t> ghostCell;
+    std::vector<uint8_t> bounce;
+
+    // Auxiliares de buildHash()
+    std::vector<int32_t> order;
+    std::vector<int32_t> scratchX, scratchY;
+    std::vector<uint8_t> scratchDir;
+    std::vector<uint32_t> scratchRng;
+    std::vector<int32_t> scratchCell;
+
+    void buildMaze(int tilesX, int tilesY);
+    int cellIndex(int32_t x, int32_t y) const;
+};
+
+#endif // SWARM_H
@@ -0,0 +1,95 @@
+#include "threadpool.h"
+
+namespace {
+
+// Índice del hilo del pool que está ejecutando (-1 fuera del pool)
+thread_local int currentWorker = -1;
+thread_local const void *currentPool = nullptr;
+
+}
+
+ThreadPool::ThreadPool(int threads)
+    : queued(0), pending(0), nextQueue(0), stopping(false) {
+    if(threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    if(threads <= 0) threads = 1;
+
+    for(int i = 0; i < threads; i++) queues.emplace_back(new Queue);
+    for(int i = 0; i < threads; i++) workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(std::thread &t : workers) t.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    int target = currentPool == this ? currentWorker
+                                     : static_cast<int>(nextQueue++ % queues.size());
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::take(int self, std::function<void()> &task) {
+    // Primero la cola propia (LIFO), después robar (FIFO) de las demás
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    int n = static_cast<int>(queues.size());
+    for(int k = 1; k < n; k++) {
+        Queue &victim = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(int self) {
+    currentWorker = self;
+    currentPool = this;
+
+    std::function<void()> task;
+    for(;;) {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if(stopping && queued == 0) return;
+        }
+
+        if(!take(self, task)) continue;
+        queued--;
+        task();
+        task = nullptr;
+
+        if(--pending == 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            idle.notify_all();
+        }
+    }
+}
+
+void ThreadPool::waitAll() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    idle.wait(lock, [this] { return pending == 0; });
+}
@@ -0,0 +1,51 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos con robo de trabajo: cada hilo tiene su propia cola, saca
+// tareas del final de la suya y, si se queda sin trabajo, roba del
+// principio de la de otro. Las tareas enviadas desde un hilo del pool van
+// a su propia cola.
+class ThreadPool {
+public:
+    // threads = 0 usa todos los núcleos
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    void submit(std::function<void()> task);
+
+    // Espera a que terminen todas las tareas enviadas hasta ahora
+    void waitAll();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> queued;
+    std::atomic<int> pending;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+
+    bool take(int self, std::function<void()> &task);
+    void run(int self);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,348 @@
+#include "tournament.h"
+#include "ghostai.h"
+#include "rng.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// Partidas por tarea del pool (una tarea arma un núcleo y lo reutiliza) y
+// por tanda enviada a un proceso hijo
+const int TASK_GAMES = 8;
+const int CHUNK_GAMES = 64;
+
+// Tanda para un proceso hijo; count == 0 le pide que termine
+struct Job {
+    uint32_t pacman;
+    uint32_t ghost;
+    uint64_t seed;
+    int64_t maxTicks;
+    int32_t count;
+    uint32_t pad;
+};
+
+// El jugador de prueba de los benchmarks (randomTurn)
+class RandomPacman : public PacmanPolicy {
+public:
+    void begin(uint64_t seed) override {
+        rng = streamSeed(seed, NUM_GHOSTS);
+        dir = DIR_RIGHT;
+    }
+
+    int decide(const PacmanCore &) override {
+        dir = randomTurn(rng, dir);
+        return dir;
+    }
+
+private:
+    uint32_t rng = 1;
+    int dir = DIR_RIGHT;
+};
+
+// Va hacia el punto más cercano. La prudente además no entra en celdas a
+// dos pasos o menos de un fantasma peligroso y persigue a los asustados
+// cercanos. Decide al entrar en cada celda, medio paso antes del centro
+// donde se gira.
+class GreedyPacman : public PacmanPolicy {
+public:
+    GreedyPacman(const MazeDistances &maze, bool cautious) : maze(maze), cautious(cautious) {}
+
+    void begin(uint64_t) override { lastCell = -1; }
+
+    int decide(const PacmanCore &core) override {
+        const GameState &s = core.state();
+        int cell = PacmanCore::cellOf(s.pacmanPos);
+        if(cell == lastCell) return DIR_NONE;
+        lastCell = cell;
+
+        int best = DIR_NONE, bestCost = 0;
+        for(int k = 0; k < 4; k++) {
+            // Primero la dirección actual, para no zigzaguear en empates
+            int d = (s.pacmanDir + k) % 4;
+            int next = maze.neighbour(cell, d);
+            if(next < 0) continue;
+            int cost = nearestDot(s, next);
+            if(cautious) {
+                for(const GhostState &ghost : s.ghosts) {
+                    int at = PacmanCore::cellOf(ghost.pos);
+                    if(!maze.walkable(at) || inGhostHouse(at)) continue;
+                    int gap = maze.distance(next, at);
+                    if(!ghost.scared && gap <= 2) cost += 1000;
+                    if(ghost.scared && gap <= 6) cost = std::min(cost, gap);
+                }
+            }
+            if(best == DIR_NONE || cost < bestCost) {
+                best = d;
+                bestCost = cost;
+            }
+        }
+        return best;
+    }
+
+private:
+    const MazeDistances &maze;
+    bool cautious;
+    int lastCell = -1;
+
+    int nearestDot(const GameState &s, int from) const {
+        int best = MazeDistances::UNREACHABLE;
+        for(int w = 0; w < Bitboard::WORDS; w++) {
+            uint64_t left = s.dots.words[w] | s.powers.words[w];
+            while(left) {
+                int cell = w * 64 + __builtin_ctzll(left);
+                left &= left - 1;
+                best = std::min(best, maze.distance(from, cell));
+            }
+        }
+        return best;
+    }
+};
+
+// Al azar en todos los cruces, asustados o no
+class RandomGhosts : public GhostPolicy {
+public:
+    explicit RandomGhosts(const MazeDistances &maze) : maze(maze) {}
+
+    int decide(const GameState &s, int ghost, int cell, uint32_t &rng) override {
+        rng = xorshift32(rng);
+        return randomGhostDirection(maze, cell, s.ghosts[ghost].dir, rng);
+    }
+
+private:
+    const MazeDistances &maze;
+};
+
+// Todos van directo a la celda de Pac-Man, sin dispersión (al azar si
+// están asustados)
+class PursuitGhosts : public GhostPolicy {
+public:
+    explicit PursuitGhosts(const MazeDistances &maze) : maze(maze) {}
+
+    int decide(const GameState &s, int ghost, int cell, uint32_t &rng) override {
+        const GhostState &g = s.ghosts[ghost];
+        if(g.scared) {
+            rng = xorshift32(rng);
+            return randomGhostDirection(maze, cell, g.dir, rng);
+        }
+        int target = maze.nearestWalkable(PacmanCore::cellOf(s.pacmanPos));
+        return chooseGhostDirection(maze, cell, g.dir, target);
+    }
+
+private:
+    const MazeDistances &maze;
+};
+
+int policyIndex(const std::vector<std::string> &names, const std::string &name) {
+    auto it = std::find(names.begin(), names.end(), name);
+    return it == names.end() ? -1 : static_cast<int>(it - names.begin());
+}
+
+}
+
+const std::vector<std::string> &pacmanPolicyNames() {
+    static const std::vector<std::string> names = {"random", "greedy", "cautious"};
+    return names;
+}
+
+const std::vector<std::string> &ghostPolicyNames() {
+    static const std::vector<std::string> names = {"arcade", "random", "pursuit"};
+    return names;
+}
+
+std::unique_ptr<PacmanPolicy> makePacmanPolicy(const std::string &name, const MazeDistances &maze) {
+    if(name == "random") return std::unique_ptr<PacmanPolicy>(new RandomPacman());
+    if(name == "greedy") return std::unique_ptr<PacmanPolicy>(new GreedyPacman(maze, false));
+    if(name == "cautious") return std::unique_ptr<PacmanPolicy>(new GreedyPacman(maze, true));
+    return nullptr;
+}
+
+std::unique_ptr<GhostPolicy> makeGhostPolicy(const std::string &name, const MazeDistances &maze) {
+    if(name == "random") return std::unique_ptr<GhostPolicy>(new RandomGhosts(maze));
+    if(name == "pursuit") return std::unique_ptr<GhostPolicy>(new PursuitGhosts(maze));
+    return nullptr;
+}
+
+GameResult playGame(PacmanCore &core, PacmanPolicy &pacman, uint64_t seed, long long maxTicks) {
+    core.reset(seed);
+    pacman.begin(seed);
+    const int levelDots = core.state().dotsRemaining();
+    while(!core.state().gameOver && core.state().tick < maxTicks) {
+        core.step(pacman.decide(core));
+    }
+    const GameState &s = core.state();
+    GameResult result;
+    result.score = s.score;
+    result.ticks = static_cast<int32_t>(s.tick);
+    result.dotsEaten = (s.level - 1) * levelDots + levelDots - s.dotsRemaining();
+    result.level = s.level;
+    result.survived = !s.gameOver;
+    return result;
+}
+
+void submitGames(ThreadPool &pool, const std::string &pacman, const std::string &ghost,
+                 const Difficulty &difficulty, uint64_t seed, int count, long long maxTicks,
+                 GameResult *out) {
+    for(int first = 0; first < count; first += TASK_GAMES) {
+        int last = std::min(count, first + TASK_GAMES);
+        pool.submit([=]() {
+            PacmanCore core;
+            core.setDifficulty(difficulty);
+            std::unique_ptr<PacmanPolicy> p = makePacmanPolicy(pacman, core.distances());
+            std::unique_ptr<GhostPolicy> g = makeGhostPolicy(ghost, core.distances());
+            core.setGhostPolicy(g.get());
+            for(int k = first; k < last; k++) out[k] = playGame(core, *p, seed + k, maxTicks);
+        });
+    }
+}
+
+Distribution describe(std::vector<double> values) {
+    Distribution d = {};
+    const size_t n = values.size();
+    if(n == 0) return d;
+    std::sort(values.begin(), values.end());
+
+    double sum = 0;
+    for(double v : values) sum += v;
+    d.mean = sum / n;
+    double squares = 0;
+    for(double v : values) squares += (v - d.mean) * (v - d.mean);
+    double half = n > 1 ? 1.96 * std::sqrt(squares / (n - 1) / n) : 0;
+    d.meanLow = d.mean - half;
+    d.meanHigh = d.mean + half;
+
+    auto at = [&](double q) { return values[std::min(n - 1, static_cast<size_t>(q * (n - 1) + 0.5))]; };
+    d.p10 = at(0.1);
+    d.median = at(0.5);
+    d.p90 = at(0.9);
+
+    // La cantidad de valores por debajo de la mediana es Binomial(n, 1/2):
+    // los rangos n/2 -+ 1.96 sqrt(n)/2 la encierran con un 95%
+    double spread = 1.96 * std::sqrt(static_cast<double>(n)) / 2;
+    double low = std::floor(n / 2.0 - spread), high = std::ceil(n / 2.0 + spread);
+    d.medianLow = values[static_cast<size_t>(std::max(0.0, low))];
+    d.medianHigh = values[std::min(n - 1, static_cast<size_t>(high))];
+    return d;
+}
+
+Tournament::Tournament(int threads, int workerCount) {
+    for(int w = 0; w < workerCount; w++) {
+        int fds[2];
+        if(::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) break;
+        pid_t pid = ::fork();
+        if(pid == 0) {
+            ::close(fds[0]);
+            for(const Worker &other : workers) ::close(other.fd);
+            workerLoop(fds[1], threads);
+            ::_exit(0);
+        }
+        ::close(fds[1]);
+        if(pid < 0) {
+            ::close(fds[0]);
+            break;
+        }
+        workers.push_back({pid, fds[0]});
+    }
+    if(workers.empty()) pool.reset(new ThreadPool(threads));
+}
+
+Tournament::~Tournament() {
+    Job quit = {};
+    for(const Worker &w : workers) {
+        ::send(w.fd, &quit, sizeof(quit), MSG_NOSIGNAL);
+        ::close(w.fd);
+    }
+    for(const Worker &w : workers) ::waitpid(w.pid, nullptr, 0);
+}
+
+void Tournament::playRange(ThreadPool &pool, int pacman, int ghost, uint64_t seed, int count,
+                           long long maxTicks, GameResult *out) {
+    submitGames(pool, pacmanPolicyNames()[pacman], ghostPolicyNames()[ghost], ARCADE_DIFFICULTY,
+                seed, count, maxTicks, out);
+    pool.waitAll();
+}
+
+void Tournament::workerLoop(int fd, int threads) {
+    ThreadPool pool(threads);
+    std::vector<GameResult> results;
+    for(;;) {
+        Job job;
+        if(::recv(fd, &job, sizeof(job), 0) != sizeof(job) || job.count <= 0) break;
+        results.resize(job.count);
+        playRange(pool, static_cast<int>(job.pacman), static_cast<int>(job.ghost), job.seed, job.count,
+                  job.maxTicks, results.data());
+        ssize_t bytes = static_cast<ssize_t>(job.count * sizeof(GameResult));
+        if(::send(fd, results.data(), bytes, MSG_NOSIGNAL) != bytes) break;
+    }
+    ::close(fd);
+}
+
+std::vector<GameResult> Tournament::play(const std::string &pacman, const std::string &ghost,
+                                         int games, uint64_t seed, long long maxTicks) {
+    int p = policyIndex(pacmanPolicyNames(), pacman);
+    int g = policyIndex(ghostPolicyNames(), ghost);
+    if(p < 0 || g < 0 || games <= 0) return {};
+    std::vector<GameResult> results(games);
+    if(pool) {
+        playRange(*pool, p, g, seed, games, maxTicks, results.data());
+        return results;
+    }
+
+    // Tandas a quien esté libre; la de un hijo que muere vuelve a la cola
+    std::deque<int> pending;
+    for(int first = 0; first < games; first += CHUNK_GAMES) pending.push_back(first);
+    std::vector<int> busy(workers.size(), -1);
+    std::vector<bool> alive(workers.size(), true);
+    auto chunkSize = [&](int first) { return std::min(CHUNK_GAMES, games - first); };
+    auto dispatch = [&](size_t w) {
+        if(pending.empty()) return;
+        int first = pending.front();
+        Job job = {static_cast<uint32_t>(p), static_cast<uint32_t>(g), seed + first, maxTicks,
+                   chunkSize(first), 0};
+        if(::send(workers[w].fd, &job, sizeof(job), MSG_NOSIGNAL) != sizeof(job)) {
+            alive[w] = false;
+            return;
+        }
+        pending.pop_front();
+        busy[w] = first;
+    };
+    for(size_t w = 0; w < workers.size(); w++) dispatch(w);
+
+    std::vector<pollfd> watched;
+    std::vector<size_t> owner;
+    for(;;) {
+        watched.clear();
+        owner.clear();
+        for(size_t w = 0; w < workers.size(); w++) {
+            if(alive[w] && busy[w] >= 0) {
+                watched.push_back({workers[w].fd, POLLIN, 0});
+                owner.push_back(w);
+            }
+        }
+        if(watched.empty()) break;
+        if(::poll(watched.data(), watched.size(), -1) < 0) continue;
+        for(size_t k = 0; k < watched.size(); k++) {
+            if(!watched[k].revents) continue;
+            size_t w = owner[k];
+            int first = busy[w];
+            ssize_t bytes = static_cast<ssize_t>(chunkSize(first) * sizeof(GameResult));
+            busy[w] = -1;
+            if(::recv(workers[w].fd, &results[first], bytes, 0) != bytes) {
+                alive[w] = false;
+                pending.push_front(first);
+                continue;
+            }
+            dispatch(w);
+        }
+        // Si un hijo murió su tanda la toma otro que esté libre
+        for(size_t w = 0; w < workers.size(); w++) {
+            if(alive[w] && busy[w] < 0) dispatch(w);
+        }
+    }
+    if(!pending.empty()) return {};
+    return results;
+}
@@ -0,0 +1,95 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+// Torneo de políticas: miles de partidas con semilla por cada par
+// (política de Pac-Man, política de fantasmas), repartidas entre los hilos
+// de un pool o entre procesos hijos que reciben tandas de partidas por un
+// socket Unix. La partida número k usa la semilla seed + k, así que los
+// resultados son los mismos con cualquier reparto.
+
+#include "pacmancore.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Elige la entrada de step() en cada tick (DIR_NONE conserva nextDir)
+class PacmanPolicy {
+public:
+    virtual ~PacmanPolicy() {}
+
+    // Antes de cada partida
+    virtual void begin(uint64_t seed) { (void)seed; }
+    virtual int decide(const PacmanCore &core) = 0;
+};
+
+// Políticas incluidas. "arcade" como política de fantasmas son las reglas
+// del núcleo (makeGhostPolicy devuelve nullptr).
+const std::vector<std::string> &pacmanPolicyNames();
+const std::vector<std::string> &ghostPolicyNames();
+std::unique_ptr<PacmanPolicy> makePacmanPolicy(const std::string &name, const MazeDistances &maze);
+std::unique_ptr<GhostPolicy> makeGhostPolicy(const std::string &name, const MazeDistances &maze);
+
+struct GameResult {
+    int32_t score;
+    int32_t ticks;     // hasta perder la última vida o hasta el tope
+    int32_t dotsEaten; // sumando todos los niveles
+    int32_t level;
+    int32_t survived;  // 1 si llegó al tope de ticks sin perder
+};
+
+// Media con su intervalo de confianza del 95% (aproximación normal) y
+// percentiles; la mediana con su intervalo por estadísticos de orden, que
+// no supone ninguna distribución
+struct Distribution {
+    double mean, meanLow, meanHigh;
+    double p10, median, p90;
+    double medianLow, medianHigh;
+};
+Distribution describe(std::vector<double> values);
+
+// Una partida de pacman contra los fantasmas de core (su política y su
+// dificultad), hasta perder o hasta maxTicks
+GameResult playGame(PacmanCore &core, PacmanPolicy &pacman, uint64_t seed, long long maxTicks);
+
+// Encola en el pool las partidas seed .. seed + count - 1 con esas
+// políticas y esa dificultad; out[k] recibe la partida seed + k. No
+// espera: quien llama hace pool.waitAll(), así que se pueden encolar
+// varias tandas seguidas.
+void submitGames(ThreadPool &pool, const std::string &pacman, const std::string &ghost,
+                 const Difficulty &difficulty, uint64_t seed, int count, long long maxTicks,
+                 GameResult *out);
+
+class Tournament {
+public:
+    // threads = 0 usa todos los núcleos. Con workers > 0 las partidas se
+    // juegan en ese número de procesos hijos (cada uno con su pool de
+    // threads hilos) y este proceso solo reparte: se crean aquí, antes de
+    // que haya hilos, porque fork() solo copia el hilo que lo llama.
+    explicit Tournament(int threads = 0, int workers = 0);
+    ~Tournament();
+
+    // Juega games partidas y devuelve los resultados en orden de partida.
+    // Los nombres tienen que estar en pacmanPolicyNames() y ghostPolicyNames().
+    std::vector<GameResult> play(const std::string &pacman, const std::string &ghost, int games,
+                                 uint64_t seed, long long maxTicks);
+
+    int workerCount() const { return static_cast<int>(workers.size()); }
+
+private:
+    struct Worker {
+        pid_t pid;
+        int fd;
+    };
+
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<Worker> workers;
+
+    static void playRange(ThreadPool &pool, int pacman, int ghost, uint64_t seed, int count,
+                          long long maxTicks, GameResult *out);
+    static void workerLoop(int fd, int threads);
+};
+
+#endif // TOURNAMENT_H
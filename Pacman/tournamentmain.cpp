@@ -0,0 +1,134 @@
+// Torneo de políticas sin ventana: todas las combinaciones pedidas de
+// Pac-Man y fantasmas, games partidas con semilla cada una.
+//   pacman_tournament [--games N] [--seed S] [--max-ticks T] [--threads H]
+//                     [--workers P] [--pacman a,b] [--ghosts x,y]
+// Con --workers las partidas se juegan en P procesos hijos de H hilos.
+// La huella final resume todos los resultados: tiene que ser la misma con
+// cualquier cantidad de hilos o procesos.
+#include "tournament.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> splitList(const char *text) {
+    std::vector<std::string> items;
+    std::string item;
+    for(const char *c = text; ; c++) {
+        if(*c == ',' || *c == '\0') {
+            if(!item.empty()) items.push_back(item);
+            item.clear();
+            if(*c == '\0') break;
+        } else {
+            item += *c;
+        }
+    }
+    return items;
+}
+
+bool known(const std::vector<std::string> &names, const std::string &name) {
+    for(const std::string &n : names) {
+        if(n == name) return true;
+    }
+    return false;
+}
+
+void printRow(const char *label, const Distribution &d) {
+    std::printf("  %-15s media %9.1f [%9.1f, %9.1f]  mediana %8.0f [%8.0f, %8.0f]  p10 %8.0f  p90 %8.0f\n",
+                label, d.mean, d.meanLow, d.meanHigh, d.median, d.medianLow, d.medianHigh, d.p10, d.p90);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int games = 1000;
+    uint64_t seed = 1;
+    long long maxTicks = 20000;
+    int threads = 0, workers = 0;
+    std::vector<std::string> pacmen = pacmanPolicyNames();
+    std::vector<std::string> ghosts = ghostPolicyNames();
+
+    for(int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(!value) {
+            std::fprintf(stderr, "falta el valor de %s\n", argv[i]);
+            return 1;
+        }
+        if(!std::strcmp(argv[i], "--games")) games = std::atoi(value);
+        else if(!std::strcmp(argv[i], "--seed")) seed = std::strtoull(value, nullptr, 10);
+        else if(!std::strcmp(argv[i], "--max-ticks")) maxTicks = std::atoll(value);
+        else if(!std::strcmp(argv[i], "--threads")) threads = std::atoi(value);
+        else if(!std::strcmp(argv[i], "--workers")) workers = std::atoi(value);
+        else if(!std::strcmp(argv[i], "--pacman")) pacmen = splitList(value);
+        else if(!std::strcmp(argv[i], "--ghosts")) ghosts = splitList(value);
+        else {
+            std::fprintf(stderr, "opción desconocida: %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    for(const std::string &name : pacmen) {
+        if(!known(pacmanPolicyNames(), name)) {
+            std::fprintf(stderr, "política de Pac-Man desconocida: %s\n", name.c_str());
+            return 1;
+        }
+    }
+    for(const std::string &name : ghosts) {
+        if(!known(ghostPolicyNames(), name)) {
+            std::fprintf(stderr, "política de fantasmas desconocida: %s\n", name.c_str());
+            return 1;
+        }
+    }
+    if(games < 1 || maxTicks < 1) {
+        std::fprintf(stderr, "--games y --max-ticks tienen que ser positivos\n");
+        return 1;
+    }
+
+    std::fflush(stdout);
+    Tournament tournament(threads, workers);
+    uint64_t fingerprint = 1469598103934665603ull;
+    long long played = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for(const std::string &pacman : pacmen) {
+        for(const std::string &ghost : ghosts) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<GameResult> results = tournament.play(pacman, ghost, games, seed, maxTicks);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if(results.empty()) {
+                std::fprintf(stderr, "no se pudieron jugar las partidas de %s contra %s\n",
+                             pacman.c_str(), ghost.c_str());
+                return 1;
+            }
+
+            std::vector<double> score, ticks, dots;
+            int survived = 0;
+            for(const GameResult &r : results) {
+                score.push_back(r.score);
+                ticks.push_back(r.ticks);
+                dots.push_back(r.dotsEaten);
+                survived += r.survived;
+                for(int32_t v : {r.score, r.ticks, r.dotsEaten, r.level, r.survived}) {
+                    fingerprint = (fingerprint ^ static_cast<uint32_t>(v)) * 1099511628211ull;
+                }
+            }
+            played += games;
+            std::printf("%s contra %s: %d partidas en %.2f s (%.0f partidas/s), llegaron al tope %.1f%%\n",
+                        pacman.c_str(), ghost.c_str(), games, seconds, games / seconds,
+                        100.0 * survived / games);
+            printRow("puntos", describe(score));
+            printRow("ticks vivo", describe(ticks));
+            printRow("puntos comidos", describe(dots));
+        }
+    }
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::printf("%lld partidas en %.2f s (%.0f partidas/s) con %s, huella %016llx\n", played, total,
+                played / total,
+                tournament.workerCount() ? (std::to_string(tournament.workerCount()) + " procesos").c_str()
+                                         : "hilos",
+                static_cast<unsigned long long>(fingerprint));
+    return 0;
+}
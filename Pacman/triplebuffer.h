@@ -0,0 +1,42 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Triple buffer sin bloqueos entre un escritor y un lector. El escritor
+// rellena back() y lo publica; el lector se queda con el último publicado
+// con acquire() y lo lee en front() todo el tiempo que quiera, porque el
+// escritor nunca toca ese buffer. Si se publican varios antes de leer,
+// los intermedios se descartan.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), backIndex(0), frontIndex(2) {}
+
+    // Solo el escritor
+    T &back() { return buffers[backIndex]; }
+    void publish() {
+        int previous = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // Solo el lector: true si había uno nuevo
+    bool acquire() {
+        if(!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & INDEX_MASK;
+        return true;
+    }
+    const T &front() const { return buffers[frontIndex]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;
+
+    T buffers[3];
+    std::atomic<int> middle; // índice del buffer intermedio y si es nuevo
+    int backIndex;
+    int frontIndex;
+};
+
+#endif // TRIPLEBUFFER_H
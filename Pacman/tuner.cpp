@@ -0,0 +1,181 @@
+#include "tuner.h"
+#include "rng.h"
+#include "tournament.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+const Difficulty TUNER_MIN = {410, 0, 0};      // 0.1 celdas por tick
+const Difficulty TUNER_MAX = {1024, 300, 256}; // 0.25 celdas, 15 s, siempre al azar
+
+namespace {
+
+// Cada candidato es un gen por parámetro, en [0, 1] dentro de su rango
+const int GENE_COUNT = 3;
+typedef std::array<double, GENE_COUNT> Genes;
+int Difficulty::*const GENE_FIELDS[GENE_COUNT] = {
+    &Difficulty::pacmanSpeed, &Difficulty::frightenedTicks, &Difficulty::ghostWander
+};
+
+Genes encode(const Difficulty &d) {
+    Genes genes;
+    for(int k = 0; k < GENE_COUNT; k++) {
+        int low = TUNER_MIN.*GENE_FIELDS[k], high = TUNER_MAX.*GENE_FIELDS[k];
+        genes[k] = static_cast<double>(d.*GENE_FIELDS[k] - low) / (high - low);
+    }
+    return genes;
+}
+
+Difficulty decode(const Genes &genes) {
+    Difficulty d;
+    for(int k = 0; k < GENE_COUNT; k++) {
+        int low = TUNER_MIN.*GENE_FIELDS[k], high = TUNER_MAX.*GENE_FIELDS[k];
+        d.*GENE_FIELDS[k] = low + static_cast<int>(std::lround(genes[k] * (high - low)));
+    }
+    return d;
+}
+
+// En [0, 1)
+double uniform(uint32_t &rng) {
+    rng = xorshift32(rng);
+    return (rng >> 8) * (1.0 / 16777216.0);
+}
+
+// Normal estándar (Box-Muller)
+double gaussian(uint32_t &rng) {
+    double u = uniform(rng) + 0.5 / 16777216.0;
+    double v = uniform(rng);
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * M_PI * v);
+}
+
+}
+
+DifficultyTuner::DifficultyTuner(int threads) : pool(threads), played(0), seconds(0.0) {}
+
+std::vector<TunedDifficulty> DifficultyTuner::evaluateAll(const std::vector<Difficulty> &candidates,
+                                                          const std::string &pacman,
+                                                          const std::vector<CurvePoint> &curve,
+                                                          int games, uint64_t seed) {
+    auto start = std::chrono::steady_clock::now();
+    const long long maxTicks = curve.empty() ? 0 : curve.back().tick;
+    std::vector<GameResult> results(candidates.size() * games);
+    for(size_t c = 0; c < candidates.size(); c++) {
+        submitGames(pool, pacman, "arcade", candidates[c], seed, games, maxTicks,
+                    &results[c * games]);
+    }
+    pool.waitAll();
+    played += static_cast<long long>(results.size());
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Vivo tras tick ticks: llegó al tope o perdió después
+    std::vector<TunedDifficulty> scored(candidates.size());
+    for(size_t c = 0; c < candidates.size(); c++) {
+        TunedDifficulty &t = scored[c];
+        t.params = candidates[c];
+        t.alive.assign(curve.size(), 0.0);
+        double squares = 0.0;
+        for(size_t p = 0; p < curve.size(); p++) {
+            int alive = 0;
+            for(int k = 0; k < games; k++) {
+                const GameResult &r = results[c * games + k];
+                alive += r.survived || r.ticks > curve[p].tick;
+            }
+            t.alive[p] = static_cast<double>(alive) / games;
+            squares += (t.alive[p] - curve[p].alive) * (t.alive[p] - curve[p].alive);
+        }
+        t.error = curve.empty() ? 0.0 : std::sqrt(squares / curve.size());
+    }
+    return scored;
+}
+
+TunedDifficulty DifficultyTuner::evaluate(const Difficulty &params, const std::string &pacman,
+                                          const std::vector<CurvePoint> &curve, int games,
+                                          uint64_t seed) {
+    return evaluateAll({params}, pacman, curve, games, seed).front();
+}
+
+TunedDifficulty DifficultyTuner::run(const TunerConfig &config, const Progress &progress) {
+    const int size = std::max(2, config.population);
+    const int generations = std::max(1, config.generations);
+    const int games = std::max(1, config.games);
+    uint32_t rng = streamSeed(config.seed, NUM_GHOSTS + 1);
+
+    // La dificultad de siempre y el resto al azar
+    std::vector<Genes> population;
+    population.push_back(encode(ARCADE_DIFFICULTY));
+    while(static_cast<int>(population.size()) < size) {
+        Genes genes;
+        for(double &g : genes) g = uniform(rng);
+        population.push_back(genes);
+    }
+
+    // El mejor de cada generación (sin repetidos: la élite puede ganar
+    // varias seguidas)
+    std::vector<Difficulty> finalists;
+    for(int generation = 0; generation < generations; generation++) {
+        std::vector<Difficulty> candidates;
+        for(const Genes &genes : population) candidates.push_back(decode(genes));
+        std::vector<TunedDifficulty> scored =
+            evaluateAll(candidates, config.pacman, config.curve, games,
+                        config.seed + static_cast<uint64_t>(generation) * games);
+
+        // rank[i] es el puesto del candidato i; los empates, por orden
+        std::vector<int> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](int a, int b) { return scored[a].error < scored[b].error; });
+        std::vector<int> rank(size);
+        for(int i = 0; i < size; i++) rank[order[i]] = i;
+
+        const TunedDifficulty &best = scored[order[0]];
+        if(progress) progress(generation, best);
+        bool seen = false;
+        for(const Difficulty &d : finalists) {
+            seen = seen || (d.pacmanSpeed == best.params.pacmanSpeed &&
+                            d.frightenedTicks == best.params.frightenedTicks &&
+                            d.ghostWander == best.params.ghostWander);
+        }
+        if(!seen) finalists.push_back(best.params);
+        if(generation + 1 == generations) break;
+
+        std::vector<Genes> next;
+        for(int e = 0; e < std::min(config.elite, size); e++) next.push_back(population[order[e]]);
+
+        // Selección por torneo de tres, cruce BLX-0.25 y mutación normal
+        auto pick = [&]() {
+            int winner = static_cast<int>(uniform(rng) * size);
+            for(int round = 0; round < 2; round++) {
+                int challenger = static_cast<int>(uniform(rng) * size);
+                if(rank[challenger] < rank[winner]) winner = challenger;
+            }
+            return winner;
+        };
+        while(static_cast<int>(next.size()) < size) {
+            const Genes &a = population[pick()];
+            const Genes &b = population[pick()];
+            Genes child;
+            for(int k = 0; k < GENE_COUNT; k++) {
+                double mix = -0.25 + 1.5 * uniform(rng);
+                double gene = a[k] + mix * (b[k] - a[k]) + config.mutation * gaussian(rng);
+                child[k] = std::min(1.0, std::max(0.0, gene));
+            }
+            next.push_back(child);
+        }
+        population.swap(next);
+    }
+
+    // Cada generación jugó con sus propias semillas, así que sus errores no
+    // se comparan entre sí (el de una generación con suerte parece mejor).
+    // Los finalistas se vuelven a jugar juntos con semillas que ninguna usó;
+    // en un empate gana el más antiguo.
+    std::vector<TunedDifficulty> rescored =
+        evaluateAll(finalists, config.pacman, config.curve, games,
+                    config.seed + static_cast<uint64_t>(generations) * games);
+    size_t winner = 0;
+    for(size_t f = 1; f < rescored.size(); f++) {
+        if(rescored[f].error < rescored[winner].error) winner = f;
+    }
+    return rescored[winner];
+}
@@ -0,0 +1,80 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+// Ajuste de la dificultad con un algoritmo genético: busca los parámetros
+// de Difficulty con los que un bot de referencia sobrevive como pide una
+// curva (qué fracción de las partidas sigue viva en cada tick dado).
+// Cada generación juega todas las partidas de todos los candidatos en un
+// pool de hilos, con las mismas semillas para todos los candidatos de la
+// generación (así la diferencia entre dos no es suerte de las semillas) y
+// semillas nuevas en la siguiente, también para los que pasan tal cual.
+// El resultado solo depende de la semilla, no de la cantidad de hilos.
+
+#include "pacmancore.h"
+#include "threadpool.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Fracción de partidas en que el bot sigue vivo tras tick ticks
+struct CurvePoint {
+    long long tick;
+    double alive;
+};
+
+struct TunerConfig {
+    std::string pacman = "cautious"; // bot de referencia (pacmanPolicyNames())
+    std::vector<CurvePoint> curve;   // en orden de tick
+    int population = 20;
+    int generations = 15;
+    int games = 48;         // por candidato y generación
+    int elite = 2;          // los mejores pasan sin cambios
+    double mutation = 0.15; // desvío de la mutación, en fracción del rango
+    uint64_t seed = 1;
+};
+
+struct TunedDifficulty {
+    Difficulty params;
+    std::vector<double> alive; // la curva obtenida, punto por punto
+    double error;              // raíz del error cuadrático medio contra la pedida
+};
+
+class DifficultyTuner {
+public:
+    // threads = 0 usa todos los núcleos
+    explicit DifficultyTuner(int threads = 0);
+
+    // Curva del bot contra params en games partidas con semillas seed,
+    // seed + 1...
+    TunedDifficulty evaluate(const Difficulty &params, const std::string &pacman,
+                             const std::vector<CurvePoint> &curve, int games, uint64_t seed);
+
+    // Corre todas las generaciones (al menos una) y devuelve, de los
+    // mejores de cada una, el que mejor sigue la curva al volver a jugarlos
+    // juntos con las mismas semillas. Usa las semillas de seed a
+    // seed + (generations + 1) * games - 1.
+    // progress recibe cada generación terminada con su mejor candidato.
+    typedef std::function<void(int generation, const TunedDifficulty &best)> Progress;
+    TunedDifficulty run(const TunerConfig &config, const Progress &progress = Progress());
+
+    long long gamesPlayed() const { return played; }
+    double secondsPlaying() const { return seconds; }
+
+private:
+    ThreadPool pool;
+    long long played;
+    double seconds;
+
+    // Todas las partidas de todos los candidatos de una vez
+    std::vector<TunedDifficulty> evaluateAll(const std::vector<Difficulty> &candidates,
+                                             const std::string &pacman,
+                                             const std::vector<CurvePoint> &curve, int games,
+                                             uint64_t seed);
+};
+
+// Rango que recorre el ajuste para cada parámetro
+extern const Difficulty TUNER_MIN;
+extern const Difficulty TUNER_MAX;
+
+#endif // TUNER_H
@@ -0,0 +1,123 @@
+// Ajuste de la dificultad sin ventana: busca velocidad, duración del susto
+// y azar de los fantasmas para que el bot de referencia sobreviva como
+// pide la curva (tick:fracción de partidas aún vivas, en orden).
+//   pacman_tuner [--curve 2000:0.9,5000:0.6,10000:0.3] [--pacman cautious]
+//                [--population N] [--generations G] [--games P] [--seed S]
+//                [--threads H]
+// Al final el mejor se vuelve a jugar con el cuádruple de partidas y
+// semillas que no vio, para ver cuánto de su error era suerte.
+#include "tuner.h"
+#include "tournament.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool parseCurve(const char *text, std::vector<CurvePoint> &curve) {
+    curve.clear();
+    const char *c = text;
+    while(*c) {
+        char *end;
+        long long tick = std::strtoll(c, &end, 10);
+        if(end == c || *end != ':') return false;
+        c = end + 1;
+        double alive = std::strtod(c, &end);
+        if(end == c || alive < 0.0 || alive > 1.0) return false;
+        if(tick <= 0 || (!curve.empty() && tick <= curve.back().tick)) return false;
+        curve.push_back({tick, alive});
+        c = end;
+        if(*c == ',') c++;
+        else if(*c) return false;
+    }
+    return !curve.empty();
+}
+
+void printCandidate(const TunedDifficulty &t) {
+    std::printf("velocidad %4d  susto %3d  azar %3d/256  error %.3f  vivos",
+                t.params.pacmanSpeed, t.params.frightenedTicks, t.params.ghostWander, t.error);
+    for(double a : t.alive) std::printf(" %.2f", a);
+    std::printf("\n");
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    TunerConfig config;
+    parseCurve("2000:0.9,5000:0.6,10000:0.3", config.curve);
+    int threads = 0;
+
+    for(int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(!value) {
+            std::fprintf(stderr, "falta el valor de %s\n", argv[i]);
+            return 1;
+        }
+        if(!std::strcmp(argv[i], "--curve")) {
+            if(!parseCurve(value, config.curve)) {
+                std::fprintf(stderr, "curva no válida: %s (tick:fracción,... con ticks crecientes)\n", value);
+                return 1;
+            }
+        }
+        else if(!std::strcmp(argv[i], "--pacman")) config.pacman = value;
+        else if(!std::strcmp(argv[i], "--population")) config.population = std::atoi(value);
+        else if(!std::strcmp(argv[i], "--generations")) config.generations = std::atoi(value);
+        else if(!std::strcmp(argv[i], "--games")) config.games = std::atoi(value);
+        else if(!std::strcmp(argv[i], "--seed")) config.seed = std::strtoull(value, nullptr, 10);
+        else if(!std::strcmp(argv[i], "--threads")) threads = std::atoi(value);
+        else {
+            std::fprintf(stderr, "opción desconocida: %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    bool known = false;
+    for(const std::string &name : pacmanPolicyNames()) known = known || name == config.pacman;
+    if(!known) {
+        std::fprintf(stderr, "política de Pac-Man desconocida: %s\n", config.pacman.c_str());
+        return 1;
+    }
+    if(config.population < 2 || config.generations < 1 || config.games < 1) {
+        std::fprintf(stderr, "--population tiene que ser al menos 2 y --generations y --games positivos\n");
+        return 1;
+    }
+
+    std::printf("curva pedida:");
+    for(const CurvePoint &p : config.curve) std::printf(" %lld:%.2f", p.tick, p.alive);
+    std::printf("  (%s, %d candidatos x %d partidas)\n", config.pacman.c_str(), config.population,
+                config.games);
+
+    DifficultyTuner tuner(threads);
+    TunedDifficulty arcade = tuner.evaluate(ARCADE_DIFFICULTY, config.pacman, config.curve,
+                                            config.games, config.seed);
+    std::printf("arcade     ");
+    printCandidate(arcade);
+
+    long long lastGames = tuner.gamesPlayed();
+    double lastSeconds = tuner.secondsPlaying();
+    TunedDifficulty best = tuner.run(config, [&](int generation, const TunedDifficulty &t) {
+        double games = static_cast<double>(tuner.gamesPlayed() - lastGames);
+        double seconds = tuner.secondsPlaying() - lastSeconds;
+        lastGames = tuner.gamesPlayed();
+        lastSeconds = tuner.secondsPlaying();
+        std::printf("gen %3d    ", generation);
+        printCandidate(t);
+        std::printf("           %.0f partidas en %.2f s (%.0f partidas/s)\n", games, seconds,
+                    games / seconds);
+        std::fflush(stdout);
+    });
+
+    // Semillas que run() no usó
+    uint64_t fresh = config.seed + static_cast<uint64_t>(config.generations + 1) * config.games;
+    TunedDifficulty check = tuner.evaluate(best.params, config.pacman, config.curve,
+                                           4 * config.games, fresh);
+    std::printf("comprobación con %d partidas nuevas:\n           ", 4 * config.games);
+    printCandidate(check);
+    std::printf("%lld partidas en %.2f s (%.0f partidas/s)\n", tuner.gamesPlayed(),
+                tuner.secondsPlaying(), tuner.gamesPlayed() / tuner.secondsPlaying());
+    std::printf("Difficulty tuned = {%d, %d, %d};\n", best.params.pacmanSpeed,
+                best.params.frightenedTicks, best.params.ghostWander);
+    return 0;
+}
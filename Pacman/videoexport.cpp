@@ -0,0 +1,183 @@
+#include "videoexport.h"
+#include <QDir>
+#include <QPainter>
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Frames por tanda: lo que un hilo pinta seguido antes de pedir más
+const int BATCH_FRAMES = 8;
+
+}
+
+VideoExporter::VideoExporter() {}
+
+bool VideoExporter::load(const Recording &rec, int framesPerTick, const QColor &color) {
+    if(framesPerTick < 1) return false;
+    background = color;
+    ticks.clear();
+    shots.clear();
+
+    // La misma simulación que replayRecording(), guardando cada tick con
+    // las posiciones del anterior para interpolar
+    PacmanCore core;
+    core.setDifficulty(rec.difficulty);
+    core.reset(rec.seed);
+    GameRenderer::Frame f = GameRenderer::Frame();
+    f.state = core.state();
+    f.prevPacmanPos = f.state.pacmanPos;
+    for(int i = 0; i < NUM_GHOSTS; i++) f.prevGhostPos[i] = f.state.ghosts[i].pos;
+    ticks.push_back(f);
+
+    size_t next = 0;
+    while(!core.state().gameOver && core.state().tick < rec.final.tick) {
+        int input = DIR_NONE;
+        int phase = 0;
+        while(next < rec.events.size() && rec.events[next].tick <= core.state().tick) {
+            input = rec.events[next].dir;
+            phase = rec.events[next++].phase;
+        }
+        f.prevPacmanPos = core.state().pacmanPos;
+        for(int i = 0; i < NUM_GHOSTS; i++) f.prevGhostPos[i] = core.state().ghosts[i].pos;
+        core.step(input, DIR_NONE, phase);
+        f.state = core.state();
+        ticks.push_back(f);
+    }
+
+    // La cámara sigue a Pac-Man frame a frame como en la ventana; este
+    // renderer nunca pinta, solo mueve la cámara
+    GameRenderer director;
+    size = QSize(director.width(), director.height());
+    director.setFrame(&ticks[0], 1.0);
+    director.buildMapLayers();
+    shots.push_back({0, 1.0, director.viewCamera().left(), director.viewCamera().top()});
+    for(size_t t = 1; t < ticks.size(); t++) {
+        for(int k = 1; k <= framesPerTick; k++) {
+            double alpha = static_cast<double>(k) / framesPerTick;
+            director.setFrame(&ticks[t], alpha);
+            director.followPacman();
+            shots.push_back({static_cast<int>(t), alpha, director.viewCamera().left(),
+                             director.viewCamera().top()});
+        }
+    }
+    return summarize(core.state()) == rec.final;
+}
+
+bool VideoExporter::render(int threads, QImage::Format format, bool ordered,
+                           const std::function<bool(int, const std::vector<QImage> &)> &deliver) {
+    if(threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const int batches = (frameCount() + BATCH_FRAMES - 1) / BATCH_FRAMES;
+    const int window = 2 * threads;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    int nextBatch = 0;
+    int delivered = 0;
+    bool failed = false;
+    std::map<int, std::vector<QImage>> ready;
+
+    auto work = [&]() {
+        GameRenderer renderer;
+        renderer.setup(background, 1.0);
+        renderer.setFrame(&ticks[0], 1.0);
+        renderer.buildMapLayers();
+        for(;;) {
+            int batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() {
+                    return failed || nextBatch >= batches || !ordered || nextBatch < delivered + window;
+                });
+                if(failed || nextBatch >= batches) return;
+                batch = nextBatch++;
+            }
+
+            const int first = batch * BATCH_FRAMES;
+            const int last = std::min(frameCount(), first + BATCH_FRAMES);
+            std::vector<QImage> images;
+            for(int i = first; i < last; i++) {
+                const Shot &shot = shots[i];
+                renderer.setFrame(&ticks[shot.tick], shot.alpha);
+                renderer.syncDotLayer();
+                renderer.moveCamera(shot.left, shot.top);
+                renderer.dropHiddenChunks();
+
+                QImage image(size, format);
+                QPainter painter(&image);
+                renderer.drawMap(painter);
+                renderer.drawPacman(painter);
+                renderer.drawGhosts(painter);
+                renderer.drawUI(painter);
+                painter.end();
+                images.push_back(image);
+            }
+
+            if(ordered) {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[batch] = std::move(images);
+            } else if(!deliver(first, images)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                failed = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) workers.emplace_back(work);
+
+    bool ok = true;
+    if(ordered) {
+        for(int b = 0; b < batches && ok; b++) {
+            std::vector<QImage> images;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return ready.count(b) > 0; });
+                images = std::move(ready[b]);
+                ready.erase(b);
+            }
+            ok = deliver(b * BATCH_FRAMES, images);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                delivered = b + 1;
+                failed = failed || !ok;
+            }
+            changed.notify_all();
+        }
+    }
+    for(std::thread &worker : workers) worker.join();
+    return ok && !failed;
+}
+
+bool VideoExporter::writePng(const QString &dir, int threads) {
+    if(!QDir().mkpath(dir)) return false;
+    return render(threads, QImage::Format_RGB32, false,
+                  [&](int first, const std::vector<QImage> &images) {
+        for(size_t k = 0; k < images.size(); k++) {
+            QString name = QString("%1/frame_%2.png")
+                               .arg(dir).arg(first + static_cast<int>(k), 6, 10, QChar('0'));
+            if(!images[k].save(name, "PNG")) return false;
+        }
+        return true;
+    });
+}
+
+bool VideoExporter::writeRaw(std::FILE *out, int threads) {
+    // Las filas de un QImage RGB888 van alineadas a 4 bytes: se escriben
+    // de a una para no mandar el relleno
+    bool ok = render(threads, QImage::Format_RGB888, true,
+                     [&](int, const std::vector<QImage> &images) {
+        for(const QImage &image : images) {
+            const size_t row = static_cast<size_t>(image.width()) * 3;
+            for(int y = 0; y < image.height(); y++) {
+                if(std::fwrite(image.constScanLine(y), 1, row, out) != row) return false;
+            }
+        }
+        return true;
+    });
+    return std::fflush(out) == 0 && ok;
+}
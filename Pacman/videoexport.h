@@ -0,0 +1,66 @@
+#ifndef VIDEOEXPORT_H
+#define VIDEOEXPORT_H
+
+#include <QColor>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include "gamerenderer.h"
+#include "replay.h"
+
+// Exporta una grabación a video sin ventana y más rápido que en tiempo
+// real. Primero se vuelve a simular la partida y se decide la cámara de
+// cada frame, en orden (la cámara depende de la anterior); después los
+// frames se reparten en tandas entre varios hilos, cada uno con su propio
+// GameRenderer pintando sobre un QImage. Cada hilo sincroniza sus capas
+// de puntos con el frame que le toque, así que no importa el orden.
+// Los QPixmap de las capas se pintan fuera del hilo de la GUI: hace falta
+// una plataforma que lo admita, como offscreen (la que usa main.cpp al
+// exportar).
+class VideoExporter {
+public:
+    VideoExporter();
+
+    // framesPerTick frames por tick, interpolando entre ticks como la
+    // ventana (1 = uno por tick, 20 FPS). background es el color de fondo.
+    bool load(const Recording &rec, int framesPerTick, const QColor &background);
+
+    int frameCount() const { return static_cast<int>(shots.size()); }
+    QSize frameSize() const { return size; }
+
+    // threads = 0 usa todos los núcleos en las dos salidas.
+    // frame_000000.png, frame_000001.png... en dir; cada hilo comprime los suyos
+    bool writePng(const QString &dir, int threads);
+
+    // RGB24 sin cabecera, fila a fila y frame tras frame, en orden (para
+    // un codificador que lee de una tubería: ffmpeg -f rawvideo -pix_fmt
+    // rgb24 -s WxH -r FPS -i -)
+    bool writeRaw(std::FILE *out, int threads);
+
+private:
+    // Un frame del video: qué tick, en qué punto entre ese tick y el
+    // anterior, y dónde está la cámara
+    struct Shot {
+        int tick;
+        double alpha;
+        double left, top;
+    };
+
+    std::vector<GameRenderer::Frame> ticks;
+    std::vector<Shot> shots;
+    QSize size;
+    QColor background;
+
+    // Pinta las tandas de frames en threads hilos, en imágenes de formato
+    // format, y le pasa cada tanda terminada a deliver: sin ordered desde
+    // el hilo que la pintó; con ordered desde este, en orden, sin que los
+    // hilos se adelanten más de unas pocas tandas a la última entregada.
+    // Si deliver devuelve false se deja de pintar.
+    bool render(int threads, QImage::Format format, bool ordered,
+                const std::function<bool(int first, const std::vector<QImage> &images)> &deliver);
+};
+
+#endif // VIDEOEXPORT_H